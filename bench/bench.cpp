@@ -0,0 +1,248 @@
+/*
+ * mas_bench：汇编器性能基准
+ *
+ * 用法：
+ *   mas_bench [--out result_file] [--outdir coe_dir] [input.asm ...]
+ *
+ * 两类测试：
+ *   - micro/*：GetOperand、Register、toNumber、DispatchData、批量编码、COE 输出等热点函数
+ *   - asm/*  ：对命令行给出的每个源文件完整执行一次 doAssemble
+ *
+ * 每个测试输出一行 JSON（同时写到 --out 指定的文件），便于在多次运行之间比较：
+ *   {"name":"asm/compiler","lines":1000000,"seconds":...,"lines_per_sec":...,
+ *    "allocs":...,"alloc_bytes":...}
+ */
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#include "Headers.h"
+
+// 丢弃所有写入的输出流缓冲区
+class NullBuffer : public std::streambuf {
+   protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+struct BenchResult {
+    std::string name;
+    double seconds = 0;
+    unsigned long long ops = 0;    // 微基准：调用次数；整体汇编：源文件行数
+    std::size_t allocs = 0;
+    std::size_t alloc_bytes = 0;
+};
+
+static std::ofstream g_result_file;
+
+static void Report(const BenchResult& r, const char* unit) {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(6);
+    line << "{\"name\":\"" << r.name << "\",\"" << unit << "\":" << r.ops
+         << ",\"seconds\":" << r.seconds << ",\"" << unit
+         << "_per_sec\":" << std::setprecision(1) << (r.seconds > 0 ? r.ops / r.seconds : 0)
+         << ",\"allocs\":" << r.allocs << ",\"alloc_bytes\":" << r.alloc_bytes
+         << ",\"alloc_bytes_per_" << (std::string(unit) == "lines" ? "line" : "op")
+         << "\":" << std::setprecision(2)
+         << (r.ops ? static_cast<double>(r.alloc_bytes) / r.ops : 0) << "}";
+
+    std::cout << line.str() << std::endl;
+    if (g_result_file) g_result_file << line.str() << "\n";
+}
+
+/*
+ * 重复执行 body（每次完成 batch 个操作），直到累计运行时间超过 0.2 秒
+ */
+template <typename F>
+static BenchResult RunMicro(const std::string& name, unsigned long long batch, F body) {
+    using Clock = std::chrono::steady_clock;
+    BenchResult r;
+    r.name = "micro/" + name;
+
+    body();  // 预热（初始化静态正则等）
+
+    std::size_t c0 = StatsAllocationCount(), b0 = StatsAllocationBytes();
+    auto start = Clock::now();
+    do {
+        body();
+        r.ops += batch;
+        r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (r.seconds < 0.2);
+    r.allocs = StatsAllocationCount() - c0;
+    r.alloc_bytes = StatsAllocationBytes() - b0;
+    return r;
+}
+
+static void MicroBenchmarks() {
+    // 避免编译器把结果优化掉
+    volatile std::uint64_t sink = 0;
+
+    Report(RunMicro("GetOperand", 3, [&] {
+               std::string op1, op2, op3;
+               GetOperand("ADD $T2, $T0, $T1", op1, op2, op3);
+               GetOperand("LW $T0, -8($SP)", op1, op2, op3);
+               GetOperand("JR $RA", op1, op2, op3);
+               sink = sink + op1.size();
+           }),
+           "ops");
+
+    Report(RunMicro("Register", 4, [&] {
+               sink = sink + Register("$t0") + Register("$SP") + Register("$31") +
+                      Register("$zero");
+           }),
+           "ops");
+
+    Report(RunMicro("toNumber", 4, [&] {
+               sink = sink + toNumber("1024") + toNumber("-8") + toNumber("0x55005500") +
+                      toNumber("65535");
+           }),
+           "ops");
+
+    {
+        const unsigned kLines = 1000;
+        Report(RunMicro("DispatchData", kLines, [&] {
+                   DataList data_list(kLines);
+                   for (auto& d : data_list) {
+                       d.assembly = ".word 0x000000FF, 0x55005500, 10, -1, 7:4";
+                       d.line = 0;
+                       d.address = 0;
+                   }
+                   SymbolMap symbol_map;
+                   AssemblerCore core;
+                   core.ProcessDataSegment(data_list, symbol_map);
+                   sink = sink + data_list.back().raw_data.size();
+               }),
+               "ops");
+    }
+
+    {
+        // 批量编码：各列用固定的伪随机内容填满，全部在范围内
+        const size_t kRows = 4096;
+        std::vector<std::uint8_t> op(kRows), rs(kRows), rt(kRows), rd(kRows), shamt(kRows),
+            func(kRows);
+        std::vector<std::int32_t> immediate(kRows);
+        std::vector<std::uint32_t> address(kRows);
+        std::uint32_t seed = 12345;
+        auto next = [&] { return seed = seed * 1103515245u + 12345u; };
+        for (size_t i = 0; i < kRows; i++) {
+            op[i] = next() % 64;
+            rs[i] = next() % 32;
+            rt[i] = next() % 32;
+            rd[i] = next() % 32;
+            shamt[i] = next() % 32;
+            func[i] = next() % 64;
+            immediate[i] = ImmediateExtend(op[i]) == Extend::Sign
+                               ? static_cast<std::int32_t>(next() % 65536) - 32768
+                               : static_cast<std::int32_t>(next() % 65536);
+            address[i] = next() % (1u << 26);
+        }
+        std::vector<MachineCode> words(kRows);
+
+        RColumns r{op.data(), rs.data(), rt.data(), rd.data(), shamt.data(), func.data(), kRows};
+        IColumns i{op.data(), rs.data(), rt.data(), immediate.data(), kRows};
+        JColumns j{op.data(), address.data(), kRows};
+        Report(RunMicro("EncodeRBatch", kRows,
+                        [&] { sink = sink + EncodeRBatch(r, words.data()) + words.back(); }),
+               "ops");
+        Report(RunMicro("EncodeIBatch", kRows,
+                        [&] { sink = sink + EncodeIBatch(i, words.data()) + words.back(); }),
+               "ops");
+        Report(RunMicro("EncodeJBatch", kRows,
+                        [&] { sink = sink + EncodeJBatch(j, words.data()) + words.back(); }),
+               "ops");
+    }
+
+    {
+        // 写满整个指令/数据镜像
+        InstructionList instruction_list(1);
+        instruction_list[0].address = 0;
+        for (int i = 0; i < TOTAL_WORDS; i++)
+            instruction_list[0].machine_code.push_back(0x20080000u + i);
+
+        DataList data_list(1);
+        data_list[0].address = 0;
+        for (int i = 0; i < TOTAL_WORDS * 4; i++)
+            data_list[0].raw_data.push_back(static_cast<std::uint8_t>(i));
+
+        NullBuffer null_buffer;
+        std::ostream null_stream(&null_buffer);
+
+        Report(RunMicro("OutputInstruction", TOTAL_WORDS,
+                        [&] { OutputInstruction(null_stream, instruction_list); }),
+               "ops");
+        Report(RunMicro("OutputDataSegment", TOTAL_WORDS,
+                        [&] { OutputDataSegment(null_stream, data_list); }),
+               "ops");
+    }
+}
+
+static unsigned long long CountLines(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    unsigned long long n = 0;
+    char buf[1 << 16];
+    while (in.read(buf, sizeof(buf)) || in.gcount()) {
+        n += std::count(buf, buf + in.gcount(), '\n');
+    }
+    return n;
+}
+
+static std::string Stem(const std::string& path) {
+    std::size_t slash = path.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    std::size_t dot = name.rfind('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+static void AssembleBenchmark(const std::string& path, const std::string& outdir,
+                              JobArena& arena) {
+    using Clock = std::chrono::steady_clock;
+    BenchResult r;
+    r.name = "asm/" + Stem(path);
+    r.ops = CountLines(path);
+
+    // doAssemble 会向 std::cout 打印结果提示，这里屏蔽掉，保证结果可被机器读取
+    NullBuffer null_buffer;
+    std::streambuf* saved = std::cout.rdbuf(&null_buffer);
+
+    std::size_t c0 = StatsAllocationCount(), b0 = StatsAllocationBytes();
+    auto start = Clock::now();
+    int ret = doAssemble(path, outdir, AssembleOptions(), nullptr, &arena);
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    r.allocs = StatsAllocationCount() - c0;
+    r.alloc_bytes = StatsAllocationBytes() - b0;
+
+    std::cout.rdbuf(saved);
+
+    if (ret != 0) {
+        std::cerr << "Benchmark input failed to assemble: " << path << "\n";
+        return;
+    }
+    Report(r, "lines");
+}
+
+int main(int argc, char* argv[]) {
+    std::string outdir = "./";
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            g_result_file.open(argv[++i]);
+        } else if (arg == "--outdir" && i + 1 < argc) {
+            outdir = argv[++i];
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    // 分配计数由 Stats 模块的 operator new 提供；只开启分配统计，
+    // 不打开 --stats 的其余计数（避免计入计时）和每次 doAssemble 结束时的统计报告
+    EnableAllocationCounting();
+
+    MicroBenchmarks();
+    JobArena arena;   // 各输入依次复用同一个作业内存区
+    for (const auto& path : inputs) {
+        AssembleBenchmark(path, outdir, arena);
+    }
+    return 0;
+}
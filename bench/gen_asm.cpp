@@ -0,0 +1,276 @@
+/*
+ * gen_asm：基准测试用的合成汇编程序生成器
+ *
+ * 用法：
+ *   gen_asm <kind> <lines> [seed]
+ *
+ * kind：
+ *   - compiler：模仿 u_sources/test.asm 的编译器输出（栈上读写、算术、分支）
+ *   - labels  ：标号密集型代码，几乎每一两行就有一个标号，大量前向/后向引用
+ *   - macro   ：宏指令密集型代码（mov/push/pop/nop，含 32 位大立即数）
+ *   - words   ：巨大的 .word/.half/.byte 数据表
+ *
+ * 生成结果写到标准输出，行数恰好为 lines。
+ * 相同的 kind/lines/seed 一定得到完全相同的文件（不依赖标准库的随机分布实现）。
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// splitmix64：可移植、可复现的伪随机数
+class Rng {
+   public:
+    explicit Rng(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t Next() {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, n) 之间的整数
+    unsigned Below(unsigned n) { return static_cast<unsigned>(Next() % n); }
+
+   private:
+    std::uint64_t state;
+};
+
+// 行计数输出器：保证恰好输出 limit 行
+class Emitter {
+   public:
+    explicit Emitter(unsigned long long limit) : limit(limit) {}
+
+    bool Full() const { return count >= limit; }
+    unsigned long long Left() const { return limit - count; }
+
+    void Line(const std::string& s) {
+        if (Full()) return;
+        std::fputs(s.c_str(), stdout);
+        std::fputc('\n', stdout);
+        count++;
+    }
+
+   private:
+    unsigned long long limit;
+    unsigned long long count = 0;
+};
+
+static const char* kTempRegs[] = {"$t0", "$t1", "$t2", "$t3", "$t4",
+                                  "$t5", "$t6", "$t7", "$s0", "$s1"};
+
+static std::string Reg(Rng& rng) { return kTempRegs[rng.Below(10)]; }
+
+static std::string Hex(std::uint32_t v) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "0x%08X", v);
+    return buf;
+}
+
+/*
+ * 编译器风格：每个函数是若干个基本块，基本块之间用 beq/j 连接。
+ * 分支目标都在函数内部，保证 16 位分支偏移不会溢出。
+ */
+static void GenCompiler(Emitter& out, Rng& rng) {
+    out.Line(".data");
+    out.Line("tbl: .word 0, 1, 2, 3, 4, 5, 6, 7");
+    out.Line(".text");
+
+    unsigned label = 0;
+    unsigned func = 0;
+    // 一个函数最多约 230 行，留出余量保证函数完整（分支目标都有定义）
+    while (out.Left() > 256) {
+        out.Line("F" + std::to_string(func++) + ":");
+        out.Line("\taddi $sp, $sp, -64");
+        out.Line("\tsw $ra, 60($sp)");
+
+        unsigned blocks = 2 + rng.Below(6);
+        unsigned first = label;
+        label += blocks;
+        for (unsigned b = 0; b < blocks; b++) {
+            out.Line("L" + std::to_string(first + b) + ":");
+            unsigned body = 4 + rng.Below(12);
+            for (unsigned k = 0; k < body; k++) {
+                int slot = -4 * static_cast<int>(1 + rng.Below(14));
+                switch (rng.Below(9)) {
+                    case 0:
+                        out.Line("\taddi " + Reg(rng) + ", $zero, " +
+                                 std::to_string(rng.Below(100)));
+                        break;
+                    case 1:
+                    case 2:
+                        out.Line("\tsw " + Reg(rng) + ", " + std::to_string(slot) +
+                                 "($sp)");
+                        break;
+                    case 3:
+                    case 4:
+                        out.Line("\tlw " + Reg(rng) + ", " + std::to_string(slot) +
+                                 "($sp)");
+                        break;
+                    case 5:
+                        out.Line("\tadd " + Reg(rng) + ", " + Reg(rng) + ", " + Reg(rng));
+                        break;
+                    case 6:
+                        out.Line("\tsub " + Reg(rng) + ", " + Reg(rng) + ", " + Reg(rng));
+                        break;
+                    case 7:
+                        out.Line("\tmult " + Reg(rng) + ", " + Reg(rng));
+                        out.Line("\tmflo " + Reg(rng));
+                        break;
+                    default:
+                        out.Line("\tlw " + Reg(rng) + ", tbl($zero)   # table load");
+                        break;
+                }
+            }
+            // 块尾：条件分支或无条件跳转到本函数内的某个块
+            unsigned target = first + rng.Below(blocks);
+            if (rng.Below(2)) {
+                out.Line("\tbeq " + Reg(rng) + ", " + Reg(rng) + ", L" +
+                         std::to_string(target));
+            } else {
+                out.Line("\tj L" + std::to_string(target));
+            }
+        }
+        out.Line("\tlw $ra, 60($sp)");
+        out.Line("\taddi $sp, $sp, 64");
+        out.Line("\tjr $ra");
+    }
+    while (!out.Full()) {
+        out.Line("\tnop");
+    }
+}
+
+/*
+ * 标号密集型：几乎每条指令前都有标号，大量 bne/j/jal 前向与后向引用。
+ */
+static void GenLabels(Emitter& out, Rng& rng) {
+    out.Line(".text");
+    unsigned long long n = 0;
+    // 留出至少 256 行给结尾的标号，保证所有前向引用都有定义
+    while (out.Left() > 257) {
+        std::string name = "lbl_" + std::to_string(n);
+        // 目标限制在附近 ±256 个标号之内，保证分支偏移合法
+        unsigned long long lo = n > 256 ? n - 256 : 0;
+        unsigned long long target = lo + rng.Below(512);
+        std::string ref = "lbl_" + std::to_string(target);
+
+        switch (rng.Below(4)) {
+            case 0:
+                out.Line(name + ": bne " + Reg(rng) + ", $zero, " + ref);
+                break;
+            case 1:
+                out.Line(name + ": j " + ref);
+                break;
+            case 2:
+                out.Line(name + ":");
+                out.Line("\tjal " + ref);
+                break;
+            default:
+                out.Line(name + ": addi " + Reg(rng) + ", " + Reg(rng) + ", " +
+                         std::to_string(rng.Below(2000)));
+                break;
+        }
+        n++;
+    }
+    while (!out.Full()) {
+        out.Line("lbl_" + std::to_string(n++) + ": nop");
+    }
+}
+
+/*
+ * 宏指令密集型：mov/push/pop/nop，其中 mov 大立即数会展开为 lui+ori。
+ */
+static void GenMacro(Emitter& out, Rng& rng) {
+    out.Line(".data");
+    out.Line("var: .word 0:16");
+    out.Line(".text");
+    out.Line("start:");
+    while (!out.Full()) {
+        switch (rng.Below(7)) {
+            case 0:
+                out.Line("\tmov " + Reg(rng) + ", " + Reg(rng));
+                break;
+            case 1:
+                out.Line("\tmov " + Reg(rng) + ", " +
+                         Hex(static_cast<std::uint32_t>(rng.Next())));
+                break;
+            case 2:
+                out.Line("\tmov " + Reg(rng) + ", " + std::to_string(rng.Below(60000)));
+                break;
+            case 3:
+                out.Line("\tpush " + Reg(rng));
+                break;
+            case 4:
+                out.Line("\tpop " + Reg(rng));
+                break;
+            case 5:
+                out.Line("\tmov " + Reg(rng) + ", " + std::to_string(4 * rng.Below(16)) +
+                         "($sp)");
+                break;
+            default:
+                out.Line("\tnop");
+                break;
+        }
+    }
+}
+
+/*
+ * 数据表：大量 .word（以及少量 .half/.byte 和重复语法 value:count）。
+ */
+static void GenWords(Emitter& out, Rng& rng) {
+    out.Line(".text");
+    out.Line("start: j start");
+    out.Line(".data");
+    unsigned long long n = 0;
+    while (!out.Full()) {
+        std::string line;
+        if (n % 64 == 0) line = "T" + std::to_string(n / 64) + ": ";
+        switch (rng.Below(10)) {
+            case 0:
+                line += ".half " + std::to_string(rng.Below(65536)) + ", " +
+                        std::to_string(rng.Below(65536));
+                break;
+            case 1:
+                line += ".byte " + std::to_string(rng.Below(256)) + ":4";
+                break;
+            default: {
+                line += ".word ";
+                unsigned count = 1 + rng.Below(8);
+                for (unsigned k = 0; k < count; k++) {
+                    if (k) line += ", ";
+                    line += Hex(static_cast<std::uint32_t>(rng.Next()));
+                }
+                break;
+            }
+        }
+        out.Line(line);
+        n++;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3 && argc != 4) {
+        std::cerr << "Usage:\n"
+                  << "  gen_asm <compiler|labels|macro|words> <lines> [seed]\n";
+        return 1;
+    }
+
+    std::string kind = argv[1];
+    unsigned long long lines = std::strtoull(argv[2], nullptr, 10);
+    std::uint64_t seed = argc == 4 ? std::strtoull(argv[3], nullptr, 10) : 2024;
+
+    Rng rng(seed);
+    Emitter out(lines);
+
+    if (kind == "compiler") GenCompiler(out, rng);
+    else if (kind == "labels") GenLabels(out, rng);
+    else if (kind == "macro") GenMacro(out, rng);
+    else if (kind == "words") GenWords(out, rng);
+    else {
+        std::cerr << "Unknown kind: " << kind << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+ * JobArena：一次汇编作业的内存区
+ *
+ * 作业中的 InstructionList、DataList（以及其中的字符串、机器码、数据字节）、
+ * 源文件缓冲区、符号表和未解决符号表都通过 std::pmr 容器从这里分配：
+ *   - 分配只是在当前块中移动指针，释放是空操作，作业结束后整体作废
+ *   - Reset() 不归还内存：用到多个块时合并为一个同样大小的块，
+ *     监视模式、bench 等反复汇编时，之后的作业不再为这些对象调用全局分配器
+ * 不是线程安全的：只在汇编线程中使用（并行读入的各块扫描不从这里分配）。
+ */
+class JobArena : public std::pmr::memory_resource {
+public:
+    explicit JobArena(size_t initial_bytes = 1 << 20) : next_chunk_bytes(initial_bytes) {}
+    ~JobArena() override;
+    JobArena(const JobArena&) = delete;
+    JobArena& operator=(const JobArena&) = delete;
+
+    // 开始新的作业：之前分配的对象必须都已析构
+    void Reset();
+
+    size_t BytesUsed() const { return used_before + offset; }   // 本次作业已分配的字节数
+    size_t BytesReserved() const;                                // 持有的块的总字节数
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+    std::vector<Chunk> chunks;
+    size_t current = 0;        // 正在使用的块
+    size_t offset = 0;         // 当前块中已用的字节数
+    size_t used_before = 0;    // 之前各块中已用的字节数
+    size_t next_chunk_bytes;   // 下一次新开块的大小
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+ * 异步输出模块
+ *
+ * 各输出文件先完整格式化到内存，再由 AsyncOutputWriter 同时写出。
+ * 每个文件的语义与 WriteFileIfChanged 相同：内容未变化时不改写，否则先写 path.tmp 再改名覆盖。
+ *   - Linux 上优先使用 io_uring（直接使用系统调用，不依赖 liburing）：
+ *     所有需要比较的已有文件一次提交读取，内容变化的文件再一次提交写入，全部完成后依次改名；
+ *     大小不同的已有文件不必读取
+ *   - 内核不支持 io_uring（版本过低或被容器禁用）以及其他平台上，每个文件一个线程调用 WriteFileIfChanged
+ * 随源文件增长、不宜整个放在内存中的文件（--stream 的 details.txt）用 AddStream 登记，
+ * 写出时在单独的线程上调用 WriteStreamIfChanged 逐段写出，与其余文件同时进行。
+ * 写出的耗时单独计入 --stats 的 output I/O 阶段（格式化仍计入 output）。
+ */
+class AsyncOutputWriter {
+   public:
+    // allow_io_uring 为 false 时总是使用线程
+    explicit AsyncOutputWriter(bool allow_io_uring = true) : allow_io_uring(allow_io_uring) {}
+
+    // 登记一个文件（binary 的含义同 WriteFileIfChanged）
+    void Add(std::string path, std::string content, bool binary = false);
+
+    // 登记一个逐段写出的文件：Flush 时在工作线程上调用 write 生成内容
+    void AddStream(std::string path, std::function<void(std::ostream&)> write, bool binary = false);
+
+    // 同时写出所有登记的文件并清空登记；返回各文件是否写出成功（顺序与 Add 相同）
+    std::vector<bool> Flush();
+
+   private:
+    struct File {
+        std::string path;
+        std::string content;
+        bool binary;
+        std::function<void(std::ostream&)> write;   // 非空时内容由它逐段写出（content 不用）
+    };
+    std::vector<File> files;
+    bool allow_io_uring;
+
+    // 以下两个函数只写内容在内存中的文件，结果写入 written 的对应位置
+    void FlushThreads(std::vector<char>& written);
+    bool FlushIoUring(std::vector<char>& written);
+};
+
+// 最近一次写出使用的方式（"io_uring"、"threads"，尚未写出时为 "none"），--stats 输出
+const char* OutputBackendName();
+
+/*
+ * 写出汇编的三个输出文件（依次登记 prgmip32.coe、dmem32.coe、details.txt）
+ * 两个 COE 文件写出失败时在 stderr 报错并返回 false；details.txt 写出失败不影响结果
+ */
+bool FlushOutputs(AsyncOutputWriter& writer);
@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * 增量汇编缓存模块（mas --cache）
+ *
+ * 以“源文本行内容”为键缓存编码结果，保存在磁盘上供下次运行使用：
+ *   - 键：FNV-1a 64 位哈希（段类型 + 去掉注释后的行文本），条目中保存原文用于校验碰撞
+ *   - 值：本行定义的 Label、机器码（或数据字节）、待回填的符号引用（机器码下标 + 符号名 + addend）、
+ *         编码时输出的警告文本
+ * 指令的编码结果与地址无关（地址相关的部分都在回填阶段计算），
+ * 因此命中时只需按缓存的长度推进地址，并把引用重新登记到 UnsolvedSymbolMap。
+ *
+ * 只缓存编码成功的行；出错的行每次都重新解析，错误信息照常输出。
+ * 缓存文件头中记录 kCacheVersion，与当前程序不一致时整个缓存作废；
+ * 文件末尾有整个文件的校验和，文件损坏时同样作废（从空缓存开始，不会按损坏的长度分配内存）。
+ * 修改任何编码逻辑时都需要更新 kCacheVersion。
+ */
+
+extern const char* const kCacheVersion;
+
+struct CacheEntry {
+    std::string text;                        // 原始行文本（校验哈希碰撞）
+    std::string label;                       // 本行定义的 Label（大写），没有则为空
+    std::vector<MachineCode> machine_code;   // 代码段：机器码
+    std::vector<std::uint8_t> raw_data;      // 数据段：数据字节
+    std::vector<RelocationTemplate> relocations;  // 待回填的符号引用
+    std::string diagnostics;                 // 编码时输出的警告，命中时原样输出
+    bool used = false;                       // 本次运行是否用到（保存时只保留用到的条目）
+};
+
+class AssemblyCache {
+   public:
+    enum class Kind : std::uint8_t { Text = 0, Data = 1 };
+
+    // 从磁盘读取缓存；文件不存在、损坏或版本不一致时得到空缓存（不报错）
+    void Load(const std::string& path);
+
+    // 写回磁盘，只保留本次运行用到的条目；失败返回 false
+    bool Save(const std::string& path) const;
+
+    // 查找一行的缓存条目，未命中返回 nullptr
+    CacheEntry* Find(Kind kind, std::string_view text);
+
+    // 登记一行的编码结果
+    void Store(Kind kind, CacheEntry entry);
+
+    // 删除本次运行没有用到的条目，并为下一次运行清除使用标记（监视模式每次汇编后调用）
+    void Prune();
+
+    std::size_t Size() const { return entries.size(); }
+
+   private:
+    static std::uint64_t Key(Kind kind, std::string_view text);
+
+    std::unordered_map<std::uint64_t, CacheEntry> entries;
+};
@@ -0,0 +1,384 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "Isa.h"
+
+/*
+ * 编译期汇编器（header-only，C++17）
+ *
+ * 把一小段 MiniSys-1A 汇编在编译期汇编为 std::array<std::uint32_t, N>，
+ * 供仿真器、硬件测试平台直接嵌入测试程序，不再手写十六进制或在测试时调用 mas：
+ *
+ *   constexpr auto prog = mas::assemble([] { return R"(
+ *           addi $t0, $zero, 10
+ *       loop:
+ *           addi $t0, $t0, -1
+ *           bne  $t0, $zero, loop
+ *   )"; });
+ *
+ * 传入返回源代码的 lambda 时 N 由源代码推出；也可以显式写 mas::assemble<3>(source)。
+ *
+ * 与 mas 使用同一张指令表（Isa.h）和字段布局（Encoding.h），编码结果一致：
+ *   - 支持指令表中的全部指令与 nop；每行最多一个 Label（不区分大小写，可前向引用）；# 注释
+ *   - .text [字节数]：与 mas 相同，填充相应个数的 0
+ *   - 数字为十进制或 0x 十六进制，可带负号；范围检查与 mas 相同（见 Encoding.h 的 Extend）
+ *   - 分支的 Label 编码为相对偏移，其余为 Label 的绝对地址（与第二遍回填相同）
+ *   - 不支持 .data 段与 mov/push/pop 等宏指令
+ *
+ * 出错时抛出 std::invalid_argument：在常量求值中即为编译错误，
+ * 编译器的报错会指向 detail::Fail 的调用处及其中的说明文字；运行时调用则照常抛出异常。
+ */
+namespace mas {
+namespace detail {
+
+[[noreturn]] inline void Fail(const char* message) { throw std::invalid_argument(message); }
+
+constexpr bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+constexpr bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+constexpr bool IsSymbolChar(char c) {
+    return IsDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+           c == '.' || c == '$';
+}
+
+constexpr char Upper(char c) { return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c; }
+
+constexpr bool SameSymbol(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (Upper(a[i]) != Upper(b[i])) return false;
+    }
+    return true;
+}
+
+constexpr std::string_view Trim(std::string_view s) {
+    size_t begin = 0, end = s.size();
+    while (begin < end && IsSpace(s[begin])) begin++;
+    while (end > begin && IsSpace(s[end - 1])) end--;
+    return s.substr(begin, end - begin);
+}
+
+/*
+ * 一行源代码：去掉注释与首尾空白后，拆成 Label（可为空）与语句（可为空）
+ */
+struct Line {
+    std::string_view label;
+    std::string_view statement;
+};
+
+constexpr Line ParseLine(std::string_view text) {
+    size_t hash = text.find('#');
+    if (hash != std::string_view::npos) text = text.substr(0, hash);
+    text = Trim(text);
+
+    Line line{};
+    size_t colon = text.find(':');
+    if (colon != std::string_view::npos) {
+        line.label = Trim(text.substr(0, colon));
+        if (line.label.empty() || IsDigit(line.label[0])) Fail("invalid label");
+        for (char c : line.label) {
+            if (!IsSymbolChar(c)) Fail("invalid label");
+        }
+        text = Trim(text.substr(colon + 1));
+    }
+    line.statement = text;
+    return line;
+}
+
+// 逐行遍历：返回 pos 开始的一行，并把 pos 移到下一行开头
+constexpr std::string_view NextLine(std::string_view source, size_t& pos) {
+    size_t end = source.find('\n', pos);
+    if (end == std::string_view::npos) end = source.size();
+    std::string_view text = source.substr(pos, end - pos);
+    pos = end + 1;
+    return text;
+}
+
+constexpr bool IsNumber(std::string_view s) {
+    if (!s.empty() && (s[0] == '-' || s[0] == '+')) s = s.substr(1);
+    if (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        for (char c : s.substr(2)) {
+            if (!IsDigit(c) && !((Upper(c) >= 'A' && Upper(c) <= 'F'))) return false;
+        }
+        return true;
+    }
+    if (s.empty()) return false;
+    for (char c : s) {
+        if (!IsDigit(c)) return false;
+    }
+    return true;
+}
+
+// 与 toNumber 相同：十进制或 0x 十六进制，超过 32 位视为错误
+constexpr long long ParseNumber(std::string_view s) {
+    bool negative = false;
+    if (s[0] == '-' || s[0] == '+') {
+        negative = s[0] == '-';
+        s = s.substr(1);
+    }
+    unsigned base = 10;
+    if (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        base = 16;
+        s = s.substr(2);
+    }
+    long long value = 0;
+    for (char c : s) {
+        value = value * base + (IsDigit(c) ? c - '0' : Upper(c) - 'A' + 10);
+        if (value > 0xFFFFFFFFLL) Fail("number out of range");
+    }
+    return negative ? -value : value;
+}
+
+constexpr unsigned ParseRegister(std::string_view s) {
+    if (s.size() < 2 || s[0] != '$') Fail("expected a register");
+    std::string_view name = s.substr(1);
+    if (IsDigit(name[0])) {
+        if (name.size() > 2 || !IsNumber(name) || ParseNumber(name) > 31) Fail("unknown register");
+        return static_cast<unsigned>(ParseNumber(name));
+    }
+    int id = FindRegisterName(name);
+    if (id < 0) Fail("unknown register");
+    return static_cast<unsigned>(id);
+}
+
+constexpr unsigned FitUnsigned(long long value, unsigned width) {
+    if (value < 0 || value > (1LL << width) - 1) Fail("value does not fit in the field");
+    return static_cast<unsigned>(value);
+}
+
+constexpr unsigned FitImmediate(long long value, Extend extend) {
+    if (value < (extend == Extend::Sign ? -32768 : 0) || value > 65535) Fail("immediate out of range");
+    return static_cast<unsigned>(value) & ImmediateField::kMax;
+}
+
+// 由 Label 算出的分支偏移须放得下有符号 16 位
+constexpr unsigned FitBranchOffset(long long value) {
+    if (value < -32768 || value > 32767) Fail("branch target out of range");
+    return static_cast<unsigned>(value) & ImmediateField::kMax;
+}
+
+// 语句占用的字数：指令为 1，.text n 为 n / 4
+constexpr size_t StatementWords(std::string_view statement) {
+    if (statement.empty()) return 0;
+    if (statement[0] != '.') return 1;
+
+    size_t end = 0;
+    while (end < statement.size() && !IsSpace(statement[end])) end++;
+    if (!SameSymbol(statement.substr(0, end), ".TEXT")) Fail("only .text is supported");
+    std::string_view argument = Trim(statement.substr(end));
+    if (argument.empty()) return 0;
+    if (!IsNumber(argument) || ParseNumber(argument) < 0) Fail("invalid .text size");
+    if (ParseNumber(argument) % 4 != 0) Fail(".text size must be multiple of 4");
+    return static_cast<size_t>(ParseNumber(argument) / 4);
+}
+
+/*
+ * Label 的地址：扫描整段源代码，未定义或重复定义时报错
+ */
+constexpr long long LabelAddress(std::string_view source, unsigned base, std::string_view name) {
+    long long address = -1;
+    size_t words = 0;
+    for (size_t pos = 0; pos <= source.size();) {
+        Line line = ParseLine(NextLine(source, pos));
+        if (SameSymbol(line.label, name)) {
+            if (address >= 0) Fail("redefined label");
+            address = base + 4 * words;
+        }
+        words += StatementWords(line.statement);
+    }
+    if (address < 0) Fail("unknown label");
+    return address;
+}
+
+struct Operands {
+    std::string_view op[3];
+    size_t count = 0;
+};
+
+constexpr Operands SplitOperands(std::string_view s) {
+    Operands operands{};
+    if (Trim(s).empty()) return operands;
+    while (true) {
+        if (operands.count == 3) Fail("too many operands");
+        size_t comma = s.find(',');
+        std::string_view op = Trim(s.substr(0, comma));
+        if (op.empty()) Fail("empty operand");
+        operands.op[operands.count++] = op;
+        if (comma == std::string_view::npos) return operands;
+        s = s.substr(comma + 1);
+    }
+}
+
+/*
+ * 汇编一条指令，address 为它的地址
+ */
+constexpr MachineCode EncodeStatement(std::string_view source, unsigned base,
+                                      std::string_view statement, unsigned address) {
+    size_t gap = 0;
+    while (gap < statement.size() && !IsSpace(statement[gap])) gap++;
+    std::string_view mnemonic = statement.substr(0, gap);
+    Operands operands = SplitOperands(statement.substr(gap));
+    const std::string_view* o = operands.op;
+
+    if (SameSymbol(mnemonic, "NOP")) {
+        if (operands.count != 0) Fail("nop takes no operands");
+        return 0;   // sll $0, $0, 0
+    }
+
+    const OpcodeInfo* info = FindOpcode(mnemonic);
+    if (info == nullptr) Fail("unknown instruction");
+    if (info->format == Format::Macro) Fail("macro instructions other than nop are not supported");
+
+    // 各语法的操作数个数（Cop0 的 sel 可省略）
+    size_t expected = 0;
+    switch (info->syntax) {
+        case Syntax::RdRsRt:
+        case Syntax::RdRtRs:
+        case Syntax::RdRtShamt:
+        case Syntax::RtRsImm:
+        case Syntax::RsRtOffset: expected = 3; break;
+        case Syntax::RsRt:
+        case Syntax::RdRs:
+        case Syntax::RtImm:
+        case Syntax::RsOffset:
+        case Syntax::RtMem: expected = 2; break;
+        case Syntax::Rs:
+        case Syntax::Rd:
+        case Syntax::Target: expected = 1; break;
+        case Syntax::NoOperand:
+        case Syntax::Macro: expected = 0; break;
+        case Syntax::Cop0: expected = operands.count == 2 ? 2 : 3; break;
+    }
+    if (operands.count != expected) Fail("wrong number of operands");
+
+    // 数字或 Label：Label 取绝对地址
+    auto value = [&](std::string_view s, bool& is_label) -> long long {
+        is_label = !IsNumber(s);
+        return is_label ? LabelAddress(source, base, s) : ParseNumber(s);
+    };
+    // 立即数：数字按扩展方式检查，Label 的绝对地址须放得下 16 位
+    auto immediate = [&](std::string_view s) -> unsigned {
+        bool is_label = false;
+        long long v = value(s, is_label);
+        return is_label ? FitUnsigned(v, ImmediateField::kWidth)
+                        : FitImmediate(v, ImmediateExtend(info->op));
+    };
+    // 分支目标：Label 编码为 (target - (PC + 4)) / 4，数字原样写入
+    auto branch = [&](std::string_view s) -> unsigned {
+        bool is_label = false;
+        long long v = value(s, is_label);
+        if (is_label) return FitBranchOffset((v - (address + 4LL)) >> 2);
+        return FitImmediate(v, Extend::Sign);
+    };
+
+    bool is_label = false;
+    switch (info->syntax) {
+        case Syntax::RdRsRt:
+            return EncodeR(info->op, ParseRegister(o[1]), ParseRegister(o[2]), ParseRegister(o[0]), 0,
+                           info->func);
+        case Syntax::RdRtRs:
+            return EncodeR(info->op, ParseRegister(o[2]), ParseRegister(o[1]), ParseRegister(o[0]), 0,
+                           info->func);
+        case Syntax::RdRtShamt:
+            return EncodeR(info->op, 0, ParseRegister(o[1]), ParseRegister(o[0]),
+                           FitUnsigned(value(o[2], is_label), ShamtField::kWidth), info->func);
+        case Syntax::RsRt:
+            return EncodeR(info->op, ParseRegister(o[0]), ParseRegister(o[1]), 0, 0, info->func);
+        case Syntax::RdRs:
+            return EncodeR(info->op, ParseRegister(o[1]), 0, ParseRegister(o[0]), 0, info->func);
+        case Syntax::Rs:
+            return EncodeR(info->op, ParseRegister(o[0]), 0, 0, 0, info->func);
+        case Syntax::Rd:
+            return EncodeR(info->op, 0, 0, ParseRegister(o[0]), 0, info->func);
+        case Syntax::NoOperand:
+            return EncodeR(info->op, info->rs, 0, 0, 0, info->func);
+        case Syntax::Cop0:
+            return EncodeR(info->op, info->rs, ParseRegister(o[0]), ParseRegister(o[1]), 0,
+                           operands.count == 3 && IsNumber(o[2]) ? FitUnsigned(ParseNumber(o[2]), 3)
+                           : operands.count == 3                 ? (Fail("invalid sel"), 0u)
+                                                                 : 0u);
+        case Syntax::RtRsImm:
+            return EncodeI(info->op, ParseRegister(o[1]), ParseRegister(o[0]), immediate(o[2]));
+        case Syntax::RsRtOffset:
+            return EncodeI(info->op, ParseRegister(o[0]), ParseRegister(o[1]), branch(o[2]));
+        case Syntax::RtImm:
+            return EncodeI(info->op, 0, ParseRegister(o[0]), immediate(o[1]));
+        case Syntax::RsOffset:
+            return EncodeI(info->op, ParseRegister(o[0]), info->rt, branch(o[1]));
+        case Syntax::RtMem: {
+            // offset(rs)
+            size_t open = o[1].rfind('(');
+            if (open == std::string_view::npos || open == 0 || o[1].back() != ')') {
+                Fail("expected offset(base)");
+            }
+            std::string_view rs = Trim(o[1].substr(open + 1, o[1].size() - open - 2));
+            return EncodeI(info->op, ParseRegister(rs), ParseRegister(o[0]),
+                           immediate(Trim(o[1].substr(0, open))));
+        }
+        case Syntax::Target: {
+            long long target = value(o[0], is_label);
+            if (target < 0) Fail("negative jump target");
+            return EncodeJ(info->op, FitUnsigned(target >> 2, AddressField::kWidth));
+        }
+        case Syntax::Macro: break;
+    }
+    Fail("unsupported instruction");
+}
+
+}  // namespace detail
+
+// 源代码汇编后的字数
+constexpr size_t word_count(std::string_view source) {
+    size_t words = 0;
+    for (size_t pos = 0; pos <= source.size();) {
+        words += detail::StatementWords(detail::ParseLine(detail::NextLine(source, pos)).statement);
+    }
+    return words;
+}
+
+// 汇编 source（第一条指令地址为 base），N 必须等于 word_count(source)
+template <size_t N>
+constexpr std::array<std::uint32_t, N> assemble(std::string_view source, unsigned base = 0) {
+    if (word_count(source) != N) detail::Fail("N does not match the number of words");
+
+    std::array<std::uint32_t, N> words{};
+    size_t n = 0;
+    for (size_t pos = 0; pos <= source.size();) {
+        detail::Line line = detail::ParseLine(detail::NextLine(source, pos));
+        if (!line.label.empty()) detail::LabelAddress(source, base, line.label);   // 查重
+        if (line.statement.empty()) continue;
+
+        if (line.statement[0] == '.') {
+            n += detail::StatementWords(line.statement);   // words 已初始化为 0
+        } else {
+            words[n] = detail::EncodeStatement(source, base, line.statement,
+                                               base + 4 * static_cast<unsigned>(n));
+            n++;
+        }
+    }
+    return words;
+}
+
+// 由返回源代码的 lambda 推出 N：mas::assemble([] { return "..."; })
+template <typename Source, typename = std::enable_if_t<std::is_invocable_v<Source>>>
+constexpr auto assemble(Source source) {
+    constexpr std::string_view text = source();
+    return assemble<word_count(text)>(text);
+}
+
+}  // namespace mas
+
+// 布局自检：与 mas 对同一段代码的输出一致
+static_assert(mas::assemble<3>("addi $t0, $zero, 10\n"
+                               "loop: addi $t0, $t0, -1   # 倒数\n"
+                               "      bne  $t0, $zero, loop")[2] == 0x1500FFFE,
+              "branch offset");
+static_assert(mas::assemble<2>("  jal func\nfunc: jr $ra")[0] == 0x0C000001, "jump target");
@@ -11,14 +11,31 @@
  * - raw_data：最终生成的数据字节序列（如 .word/.byte 的结果）
  *
  * DataList：是由多条 Data 记录组成的数组，表示整个数据段。
+ * 与 Instruction 相同，字符串与数据字节随 DataList 从作业的 JobArena 分配。
  */
 struct Data {
-    std::string assembly;        // 原始汇编语句
-    std::string file;            // 源文件路径
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    std::pmr::string assembly;        // 原始汇编语句
+    std::pmr::string file;            // 源文件路径
     int line;                    // 行号
     int address;                 // 数据在内存中的位置
     bool done = false;           // 是否已解析完成
-    std::vector<std::uint8_t> raw_data;  // 最终生成的二进制数据（以字节形式存到数组中）
+    std::pmr::vector<std::uint8_t> raw_data;  // 最终生成的二进制数据（以字节形式存到数组中）
+
+    Data() = default;
+    explicit Data(const allocator_type& alloc) : assembly(alloc), file(alloc), raw_data(alloc) {}
+    Data(const Data& other, const allocator_type& alloc)
+        : assembly(other.assembly, alloc), file(other.file, alloc), line(other.line),
+          address(other.address), done(other.done), raw_data(other.raw_data, alloc) {}
+    Data(Data&& other, const allocator_type& alloc)
+        : assembly(std::move(other.assembly), alloc), file(std::move(other.file), alloc),
+          line(other.line), address(other.address), done(other.done),
+          raw_data(std::move(other.raw_data), alloc) {}
+    Data(const Data&) = default;
+    Data(Data&&) = default;
+    Data& operator=(const Data&) = default;
+    Data& operator=(Data&&) = default;
 };
 
-using DataList = std::vector<Data>;
\ No newline at end of file
+using DataList = std::pmr::vector<Data>;
\ No newline at end of file
@@ -3,7 +3,6 @@
 /*
  * I 格式指令（Immediate Format）处理模块
  * 包含：
- *   - I 格式指令的正则表达式
  *   - I 格式编码函数
  *   - I 格式指令判别函数
  *
@@ -12,8 +11,6 @@
  *     OP  |   RS  |   RT  | Immediate/offset
  */
 
-extern std::regex I_format_regex;
-
 /*
  * I_FormatInstruction
  *   输入：助记符 mnemonic、汇编文本 assembly
@@ -21,7 +18,7 @@ extern std::regex I_format_regex;
  *   功能：
  *     - 对不同 I 格式指令分类处理（算术/逻辑、分支、加载存储、COP0）
  *     - 管理未解析符号（保存到 unsolved_symbol_map）
- *     - 调用 SetOP/SetRS/SetRT/SetImmediate 写入字段
+ *     - 按指令选择立即数的扩展方式检查范围，再把操作数字段或进指令表中的 base
  *
  * machine_code_it：
  *     指向当前指令 machine_code 的迭代器，用于直接修改机器码
@@ -34,7 +31,6 @@ MachineCode I_FormatInstruction(const std::string& mnemonic,
 
 /*
  * isI_Format：
- *   判断一条机器码或一条汇编指令是否属于 I 格式
+ *   判断一条汇编指令是否交给 I 格式处理（查 Isa.h 的指令表，含 MFC0/MTC0）
  */
-bool isI_Format(MachineCode machine_code);
 bool isI_Format(const std::string& assembly);
\ No newline at end of file
@@ -11,8 +11,6 @@
  *   JAL addr
  */
 
-extern std::regex J_format_regex;
-
 MachineCode J_FormatInstruction(const std::string& mnemonic,
                                 const std::string& assembly,
                                 UnsolvedSymbolMap& unsolved_symbol_map,
@@ -20,7 +18,6 @@ MachineCode J_FormatInstruction(const std::string& mnemonic,
                                 Instruction* cur_instruction);    // 当前指令指针（用于错误报告）
 
 /*
- * 判断指令是否是 J 格式
+ * 判断指令是否是 J 格式（查 Isa.h 的指令表）
  */
-bool isJ_Format(MachineCode machine_code);
 bool isJ_Format(const std::string& assembly);
\ No newline at end of file
@@ -15,8 +15,6 @@
  *   - 系统 BREAK SYSCALL ERET
  */
 
-extern std::regex R_format_regex;
-
 MachineCode R_FormatInstruction(const std::string& mnemonic,
                                 const std::string& assembly,
                                 UnsolvedSymbolMap& unsolved_symbol_map,
@@ -24,7 +22,6 @@ MachineCode R_FormatInstruction(const std::string& mnemonic,
                                 Instruction* cur_instruction);
 
 /*
- * R 格式判断
+ * R 格式判断（查 Isa.h 的指令表）
  */
-bool isR_Format(MachineCode machine_code);
 bool isR_Format(const std::string& assembly);
\ No newline at end of file
@@ -9,8 +9,6 @@
  *   - NOP  : 空操作（SLL $0,$0,0 模拟）
  */
 
-extern std::regex Macro_format_regex;
-
 /*
  * Macro_FormatInstruction：
  *
@@ -34,6 +32,6 @@ MachineCode Macro_FormatInstruction(const std::string& mnemonic,
                                 Instruction* cur_instruction);
 
 /*
- * 判断一条汇编语句是否是宏指令（MOV/PUSH/POP/NOP）
+ * 判断一条汇编语句是否是宏指令（MOV/PUSH/POP/NOP，查 Isa.h 的指令表）
  */
 bool isMacro_Format(const std::string& assembly);
\ No newline at end of file
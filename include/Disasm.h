@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+ * 反汇编模块（mas --disasm）
+ *
+ * 把旧版本生成的、或从硬件上读出的代码镜像（格式见 Image.h）还原为 mas 可以重新汇编的源程序：
+ *   - 解码：DecodeOpcode() 按 OP 查表，OP 相同的再按 Func/RT/RS 查第二级表（表由 isagen 生成）
+ *   - 分支、跳转的目标在镜像内时输出 Label：有 --symbols 时使用 details.txt 中的名字，
+ *     否则生成 L_<地址>
+ *   - 立即数的写法与编码器一致（有符号扩展的写十进制，零扩展的写十六进制），
+ *     重新汇编得到的镜像与原镜像逐字相同；解码失败的字输出为 .word 并在 stderr 给出警告
+ *   - 末尾连续的 0 字省略（mas 输出 COE 时会补齐）
+ *
+ * 镜像按块分给多个线程：先并行收集跳转目标，再并行生成各块文本，最后按顺序拼接，
+ * 结果与线程数无关。
+ */
+struct DisasmOptions {
+    std::string symbols_path;   // --symbols：mas 生成的 details.txt
+    unsigned threads = 0;       // 0 表示按硬件线程数
+};
+
+/*
+ * ReadLabelTable：从 details.txt 的代码段部分读取 Label 的地址（每个地址取第一次出现的名字）。
+ * details.txt 只有语句行：写在语句前的 Label 直接读出；单独占一行的 Label 从分支、跳转语句的
+ * 目标操作数反推（目标地址由机器码算出），定义处的名字优先
+ */
+bool ReadLabelTable(const std::string& path, std::unordered_map<unsigned, std::string>& labels,
+                    std::string& error);
+
+/*
+ * Disassemble：把代码镜像（第一个字的地址为 0）反汇编为源程序文本，追加到 out；
+ * 返回无法解码的字数
+ */
+size_t Disassemble(const std::vector<uint32_t>& words,
+                   const std::unordered_map<unsigned, std::string>& labels, unsigned threads,
+                   std::string& out);
+
+/*
+ * doDisassemble：mas --disasm 的入口，output_path 为空时写到标准输出
+ * 返回 0 表示成功
+ */
+int doDisassemble(const std::string& input_path, const std::string& output_path,
+                  const DisasmOptions& options);
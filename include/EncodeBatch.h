@@ -0,0 +1,48 @@
+#pragma once
+
+/*
+ * 批量编码模块
+ *
+ * 操作数已经解码为定宽字段、按列存放（struct of arrays）时，编码只是移位与按位或。
+ * 这里对同一格式的一批指令一次编码：
+ *   - 寄存器号、OP、Func、Shamt 等字段为 8 位列，立即数、地址为 32 位列
+ *   - x86 上每步编码 16 条（AVX-512）或 8 条（AVX2），运行时检测，其他平台逐条编码
+ *   - 范围检查同样按向量进行：超宽字段在右移字段宽度后不为 0；
+ *     I 格式立即数的上下界由 OP 决定（见 ImmediateExtend），用有符号比较检查
+ *
+ * 返回值为成功编码的条数：全部合法时为 count，否则为第一条越界指令的下标，
+ * 它之前的各条已经写入 out，由调用者决定如何报告（如抛出 NumberOverflow）。
+ *
+ * 与 R_FormatInstruction 等逐条编码的结果一致；逐行汇编仍走逐条路径（瓶颈在文本解析），
+ * 批量接口供生成大规模测试程序等已经得到操作数列的场合使用。
+ */
+struct RColumns {
+    const std::uint8_t* op;
+    const std::uint8_t* rs;
+    const std::uint8_t* rt;
+    const std::uint8_t* rd;
+    const std::uint8_t* shamt;
+    const std::uint8_t* func;
+    size_t count;
+};
+
+struct IColumns {
+    const std::uint8_t* op;
+    const std::uint8_t* rs;
+    const std::uint8_t* rt;
+    const std::int32_t* immediate;   // 源代码中的值：符号扩展的为有符号数，零扩展的为 0 ~ 65535
+    size_t count;
+};
+
+struct JColumns {
+    const std::uint8_t* op;
+    const std::uint32_t* address;    // 字地址（字节地址 >> 2）
+    size_t count;
+};
+
+size_t EncodeRBatch(const RColumns& in, MachineCode* out);
+size_t EncodeIBatch(const IColumns& in, MachineCode* out);
+size_t EncodeJBatch(const JColumns& in, MachineCode* out);
+
+// 当前使用的实现："avx512"、"avx2" 或 "scalar"（--stats 输出）
+const char* BatchEncoderName();
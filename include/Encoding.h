@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * 机器码字段的编译期描述
+ *
+ * 各格式的 bit 分布：
+ *   R：OP(31~26) | RS(25~21) | RT(20~16) | RD(15~11) | Shamt(10~6) | Func(5~0)
+ *   I：OP(31~26) | RS(25~21) | RT(20~16) | Immediate(15~0)
+ *   J：OP(31~26) | Address(25~0)
+ *
+ * Field<Shift, Width> 只负责移位与掩码，不做范围检查、不抛异常：
+ * 操作数在分类时（寄存器、立即数、移位量、地址等）已经检查过范围，
+ * 编码函数把一整条指令在一个表达式中拼好。
+ * 本头文件不依赖项目中的其他头文件（ConstexprAssembler.h 可单独使用）。
+ */
+
+// MachineCode 表示 32 位机器码
+using MachineCode = std::uint32_t;
+
+template <unsigned Shift, unsigned Width>
+struct Field {
+    static_assert(Width > 0 && Shift + Width <= 32, "field must fit in a 32-bit word");
+
+    static constexpr unsigned kShift = Shift;
+    static constexpr unsigned kWidth = Width;
+    static constexpr MachineCode kMax = static_cast<MachineCode>((std::uint64_t(1) << Width) - 1);
+    static constexpr MachineCode kMask = kMax << Shift;
+
+    // 取 value 的低 Width 位放到字段位置
+    static constexpr MachineCode Pack(MachineCode value) { return (value & kMax) << Shift; }
+    // 从机器码中取出字段值（零扩展）
+    static constexpr MachineCode Get(MachineCode code) { return (code >> Shift) & kMax; }
+    // 替换机器码中的这个字段，其余 bit 不变（第二遍回填符号时使用）
+    static constexpr MachineCode Replace(MachineCode code, MachineCode value) {
+        return (code & ~kMask) | Pack(value);
+    }
+};
+
+using OpField = Field<26, 6>;
+using RsField = Field<21, 5>;
+using RtField = Field<16, 5>;
+using RdField = Field<11, 5>;
+using ShamtField = Field<6, 5>;
+using FuncField = Field<0, 6>;
+using ImmediateField = Field<0, 16>;
+using AddressField = Field<0, 26>;
+
+constexpr MachineCode EncodeR(unsigned op, unsigned rs, unsigned rt, unsigned rd, unsigned shamt,
+                              unsigned func) {
+    return OpField::Pack(op) | RsField::Pack(rs) | RtField::Pack(rt) | RdField::Pack(rd) |
+           ShamtField::Pack(shamt) | FuncField::Pack(func);
+}
+
+constexpr MachineCode EncodeI(unsigned op, unsigned rs, unsigned rt, unsigned immediate) {
+    return OpField::Pack(op) | RsField::Pack(rs) | RtField::Pack(rt) |
+           ImmediateField::Pack(immediate);
+}
+
+constexpr MachineCode EncodeJ(unsigned op, unsigned address) {
+    return OpField::Pack(op) | AddressField::Pack(address);
+}
+
+// 字段布局的自检：add $t0,$t1,$t2 / addi $sp,$sp,-4 / lw $ra,0($sp) / jal 0x100
+static_assert(EncodeR(0, 9, 10, 8, 0, 0b100000) == 0x012A4020, "R layout");
+static_assert(EncodeI(0b001000, 29, 29, static_cast<unsigned>(-4)) == 0x23BDFFFC, "I layout");
+static_assert(EncodeI(0b100011, 29, 31, 0) == 0x8FBF0000, "I layout");
+static_assert(EncodeJ(0b000011, 0x100 >> 2) == 0x0C000040, "J layout");
+static_assert(ImmediateField::Replace(0x2008FFFF, 0x1234) == 0x20081234, "field replace");
+
+/*
+ * 16 位立即数的扩展方式，决定源代码中允许的取值范围：
+ *   Sign：硬件做符号扩展（addi/addiu/slti/sltiu、访存 offset、分支偏移），-32768 ~ 65535：
+ *         32768 ~ 65535 按 16 位写入，即扩展后的负数（如 sw $t0, 0xFC60($zero) 访问 0xFFFFFC60 的 I/O 端口）
+ *   Zero：硬件做零扩展（andi/ori/xori）或作为高半字（lui），0 ~ 65535
+ */
+enum class Extend { Sign, Zero };
+
+/*
+ * I 格式立即数的扩展方式只取决于 OP：
+ *   andi/ori/xori/lui（0b0011xx）零扩展，其余（addi 类、分支、访存）符号扩展
+ */
+constexpr Extend ImmediateExtend(unsigned op) {
+    return (op >> 2) == 0b0011 ? Extend::Zero : Extend::Sign;
+}
+
+/*
+ * 操作数范围检查，在分类操作数时调用，超出范围抛出 NumberOverflow。
+ * 返回可以直接交给 Field::Pack 的值（负数为其补码的低位）。
+ */
+unsigned CheckImmediate(long long value, Extend extend, const char* name = "Immediate");
+unsigned CheckUnsigned(long long value, unsigned width, const char* name);
+// 由地址算出的有符号值（分支偏移）须真正放得下：-2^(width-1) ~ 2^(width-1)-1
+unsigned CheckSigned(long long value, unsigned width, const char* name);
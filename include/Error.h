@@ -4,34 +4,47 @@
  * 本文件定义了一系列汇编器用到的异常种类，用于描述具体的错误类型，
  * 例如：寄存器错误、数字溢出、操作数错误等。
  *
- * 每个异常继承自 std::runtime_error，以便在解析和生成机器码时抛出。
+ * 每个异常继承自 AssemblerError（std::runtime_error 的子类），以便在解析和生成机器码时抛出。
+ * AssemblerError 额外记录出错的源文本片段（如寄存器名、操作数），语言服务器据此计算列号。
  */
 
-class ExceptNumberOrSymbol : public std::runtime_error {
+class AssemblerError : public std::runtime_error {
+   public:
+    AssemblerError(const std::string &msg, const std::string &token)
+        : std::runtime_error(msg), token(token) {}
+
+    // 出错的源文本片段（已转为大写），可能为空
+    const std::string &Token() const { return token; }
+
+   private:
+    std::string token;
+};
+
+class ExceptNumberOrSymbol : public AssemblerError {
    public:
     // 期望一个“数字或符号”时抛出
     explicit ExceptNumberOrSymbol(const std::string &msg);
 };
 
-class ExceptNumber : public std::runtime_error {
+class ExceptNumber : public AssemblerError {
    public:
     // 期望一个“纯数字”时抛出
     explicit ExceptNumber(const std::string &msg);
 };
 
-class ExceptPositive : public std::runtime_error {
+class ExceptPositive : public AssemblerError {
    public:
     // 期望“正数”时抛出
     explicit ExceptPositive(const std::string &msg);
 };
 
-class ExceptRegister : public std::runtime_error {
+class ExceptRegister : public AssemblerError {
    public:
     // 传入的字符串不是寄存器名时报错
     explicit ExceptRegister(const std::string &name);
 };
 
-class OperandError : public std::runtime_error {
+class OperandError : public AssemblerError {
    public:
     // 一般操作数错误，如格式不对、类型不对等
     explicit OperandError(const std::string &mnemonic,
@@ -42,18 +55,28 @@ class TooManyOperand : public OperandError {
    public:
     // 操作数过多
     explicit TooManyOperand(const std::string &mnemonic)
-        : OperandError(mnemonic, "Too mamy operands"){};
+        : OperandError(mnemonic, "Too mamy operands") {
+        CountException(ExceptionKind::TooManyOperand);
+    };
 };
 
-class UnknownInstruction : public std::runtime_error {
+class UnknownInstruction : public AssemblerError {
    public:
     // 未知指令
     explicit UnknownInstruction(const std::string &mnemonic);
 };
 
-class NumberOverflow : public std::runtime_error {
+class NumberOverflow : public AssemblerError {
    public:
     // 数字超出合法范围，如立即数超过 bit 宽度
     explicit NumberOverflow(const std::string &name, const std::string &max,
                             const std::string &now);
-};
\ No newline at end of file
+    // 有下限的字段（如有符号立即数），超出 [min, max] 任一端
+    NumberOverflow(const std::string &name, const std::string &min, const std::string &max,
+                   const std::string &now);
+};
+class ExpressionError : public AssemblerError {
+   public:
+    // 表达式语法正确但无法使用，如除以 0、两个符号相加、%hi/%lo 用在分支中
+    ExpressionError(const std::string &expression, const std::string &reason);
+};
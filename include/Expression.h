@@ -0,0 +1,73 @@
+#pragma once
+
+/*
+ * 操作数表达式模块
+ *
+ * 立即数、访存 offset、移位量、分支与跳转目标，以及数据段的 .byte/.half/.word 的值，
+ * 除了数字和符号以外还可以写表达式：
+ *   - 运算符：+ - * / % << >> & | ^ ~ 和括号，优先级与 C 相同；数字的写法与 toNumber 相同
+ *   - 只含数字的表达式在解析时折叠为常量，按 32 位补码计算（与 toNumber 的截断一致）
+ *   - 含符号的表达式须能化为“符号 + 常量”，如 label+8、4+label、label-(2*4)、
+ *     end-end+4（同一符号相减后为常量）；编码时登记为带 addend 的引用，
+ *     回填时写入“符号地址 + addend”，不需要额外的指令；符号也可以是局部 Label 的引用 1b/1f（见 LocalLabel.h）
+ *   - %hi(expr)/%lo(expr) 取 expr 的高/低半字，须包住整个操作数，只能用于 16 位立即数：
+ *       %lo(x) = x & 0xFFFF，%hi(x) = (x + 0x8000) >> 16
+ *     %hi 已为低半字的符号扩展做了进位修正，与 addi/lw/sw 中的 %lo 配对使用：
+ *       lui $t0, %hi(table)
+ *       lw  $t1, %lo(table)($t0)
+ *     取出的半字直接写入立即数字段，不再按扩展方式检查范围
+ * 与其他操作数一样，表达式中不能有空白（GetOperand 以空白和逗号分隔操作数）。
+ */
+
+// 引用符号地址的哪一部分
+enum class AddressPart : std::uint8_t { Whole, Hi, Lo };
+
+// 符号引用的附加部分：回填的值为“符号地址 + value”按 part 取出的部分
+struct Addend {
+    int value = 0;
+    AddressPart part = AddressPart::Whole;
+};
+
+// 取地址的高/低半字，part 为 Whole 时原样返回
+constexpr long long AddressHalf(long long address, AddressPart part) {
+    switch (part) {
+        case AddressPart::Hi: return ((address + 0x8000) >> 16) & 0xFFFF;
+        case AddressPart::Lo: return address & 0xFFFF;
+        default: return address;
+    }
+}
+
+static_assert(AddressHalf(0x12348000, AddressPart::Hi) == 0x1235, "%hi carries into the high half");
+static_assert(AddressHalf(0x12348000, AddressPart::Lo) == 0x8000, "%lo is the low half");
+static_assert(AddressHalf(-1, AddressPart::Hi) == 0 && AddressHalf(-1, AddressPart::Lo) == 0xFFFF,
+              "%hi/%lo of a negative address");
+
+/*
+ * Operand：解析后的操作数
+ *   symbol 为空时是常量 value（有 %hi/%lo 时已取出半字，part 只表示不再检查范围），
+ *   否则为 symbol + value，再按 part 取出的部分
+ */
+struct Operand {
+    std::string symbol;
+    int value = 0;
+    AddressPart part = AddressPart::Whole;
+
+    bool IsConstant() const { return symbol.empty(); }
+    Addend GetAddend() const { return Addend{value, part}; }
+};
+
+/*
+ * ParseOperand：解析数字、符号或表达式
+ *   不是数字、符号或语法正确的表达式时抛出 ExceptNumberOrSymbol；
+ *   语法正确但无法求值（除以 0、移位量越界）或不能化为“符号 + 常量”时抛出 ExpressionError
+ */
+Operand ParseOperand(const std::string& str);
+
+// 同 ParseOperand，但语法上不是操作数时返回 false 而不抛出异常（求值错误仍抛出 ExpressionError）
+bool TryParseOperand(const std::string& str, Operand& operand);
+
+// 语法上是否为操作数（数字、符号或表达式），不抛出异常
+bool isOperand(const std::string& str);
+
+// 只能用于 16 位立即数的 %hi/%lo 出现在其他位置（分支、跳转、移位量）时抛出 ExpressionError
+void RequireWholeOperand(const Operand& operand, const std::string& str);
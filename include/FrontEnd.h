@@ -0,0 +1,26 @@
+#pragma once
+
+/*
+ * 并行读入模块（doAssemble 的文本扫描阶段）
+ *
+ * 整个源文件读入内存后按换行切成若干块，每块由一个线程独立完成：
+ *   - 按行切分、去注释、跳过空行
+ *   - 识别 .data/.text 段切换指令（handleSegmentDirective 的正则是逐行开销最大的部分）
+ * 块内只记录局部行号和指向缓冲区的文本；合并时按块顺序对各块的行数做前缀和得到全局行号，
+ * 再依次根据段切换指令确定每行属于哪个段，放入 InstructionList/DataList。
+ * 缓冲区和各行文本从列表的 memory_resource 分配（doAssemble 中为作业的 JobArena），
+ * 块内扫描不分配字符串。合并只复制各行文本，并对段切换指令重新调用一次 handleSegmentDirective
+ * （得到正确的行号、预留空间记录和异常），因此结果与逐行读入完全相同，
+ * 错误也按源文件中的先后顺序报告。
+ *
+ * 地址与 Label 仍在第一遍扫描中确定：指令长度取决于编码（宏指令会展开为多条），
+ * 读入阶段无法得知。
+ *
+ * 返回值：出错时返回 true（错误信息已输出到 stderr）
+ *   threads：使用的线程数，0 表示按 CPU 核数；文件较小时只用一个块
+ */
+bool ReadSource(std::istream& in,
+                const std::string& input_path,
+                InstructionList& instruction_list,
+                DataList& data_list,
+                unsigned threads = 0);
@@ -1,22 +1,51 @@
 #pragma once
+#include <atomic>
 #include <bitset>
 #include <cassert>
+#include <condition_variable>
 #include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <regex>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <cstring>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include "Arena.h"
+#include "Stats.h" // 需在 Error.h 之前，异常构造函数中会计数
 #include "Data.h"
 #include "Error.h"
+#include "Expression.h"
+#include "Symbol.h"
+#include "LocalLabel.h"
 #include "Instruction.h"
+#include "EncodeBatch.h"
+#include "Cache.h"
+#include "MemReport.h"
 #include "Output.h"
+#include "AsyncOutput.h"
+#include "Image.h"
+#include "Patch.h"
+#include "Disasm.h"
 #include "Process.h"
 #include "Register.h"
+#include "Scan.h"
 #include "Utility.h"
-#include "doAssemble.h"
\ No newline at end of file
+#include "doAssemble.h"
+#include "FrontEnd.h"
+#include "Stream.h"
+#include "SpscQueue.h"
+#include "Pipeline.h"
+#include "Watch.h"
+#include "Json.h"
+#include "Lsp.h"
+#include "ConstexprAssembler.h"
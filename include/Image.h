@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+ * 存储器镜像读取模块（反汇编与 --patch 使用）
+ *
+ * 支持的格式（按扩展名判断，其他扩展名按内容判断是否为 COE）：
+ *   .coe      ：Xilinx COE，memory_initialization_radix 为 2、10 或 16，
+ *               memory_initialization_vector 中以逗号/空白分隔，以分号结束
+ *   .bin      ：每字 4 字节、小端序的原始镜像
+ *   .mem/.hex ：Verilog $readmemh 格式，空白分隔的十六进制字，// 注释，@地址（字地址）跳转，
+ *               地址不能超过 4 * TOTAL_WORDS 个字
+ *
+ * 整个文件一次读入后逐字符解析（不使用流和正则）。
+ * 读出的字数即文件中的字数，不补齐到 TOTAL_WORDS。
+ */
+enum class ImageFormat { Coe, Bin, Mem };
+
+// 按扩展名（其次按内容）判断格式，无法判断时返回 false
+bool GuessImageFormat(const std::string& path, const std::string& content, ImageFormat& format);
+
+/*
+ * ReadImage：读入镜像文件到 words，
+ * 失败时返回 false 并在 error 中给出原因（文件无法打开、格式错误及其位置）
+ */
+bool ReadImage(const std::string& path, std::vector<uint32_t>& words, std::string& error);
+
+// 解析已经读入内存的镜像
+bool ParseImage(std::string_view content, ImageFormat format, std::vector<uint32_t>& words,
+                std::string& error);
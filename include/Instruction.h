@@ -1,10 +1,11 @@
 #pragma once
 
-// MachineCode 表示 32 位机器码
-using MachineCode = std::uint32_t;
+// 机器码（MachineCode）、字段布局与操作数范围检查，以及指令集表
+#include "Encoding.h"
+#include "Isa.h"
 
 // MachineCodeIt 是指向 machine_code 数组中某个具体机器码的迭代器
-using MachineCodeIt = std::vector<MachineCode>::iterator;
+using MachineCodeIt = std::pmr::vector<MachineCode>::iterator;
 
 /*
  * Instruction 结构体表示一行 .text 段中的指令。
@@ -16,14 +17,33 @@ using MachineCodeIt = std::vector<MachineCode>::iterator;
  * address：该指令在最终程序中的地址（字节为单位）
  * done：是否已经生成 machine_code
  * machine_code：本指令最终生成的一条或多条机器码（宏指令可能展开成多条）
+ *
+ * 字符串与机器码使用 std::pmr 容器：放进 InstructionList 时随列表从作业的 JobArena 分配
  */
 struct Instruction {
-    std::string assembly;
-    std::string file;
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    std::pmr::string assembly;
+    std::pmr::string file;
     unsigned line;
     unsigned address;
     bool done = false;
-    std::vector<MachineCode> machine_code;
+    std::pmr::vector<MachineCode> machine_code;
+
+    Instruction() = default;
+    explicit Instruction(const allocator_type& alloc)
+        : assembly(alloc), file(alloc), machine_code(alloc) {}
+    Instruction(const Instruction& other, const allocator_type& alloc)
+        : assembly(other.assembly, alloc), file(other.file, alloc), line(other.line),
+          address(other.address), done(other.done), machine_code(other.machine_code, alloc) {}
+    Instruction(Instruction&& other, const allocator_type& alloc)
+        : assembly(std::move(other.assembly), alloc), file(std::move(other.file), alloc),
+          line(other.line), address(other.address), done(other.done),
+          machine_code(std::move(other.machine_code), alloc) {}
+    Instruction(const Instruction&) = default;
+    Instruction(Instruction&&) = default;
+    Instruction& operator=(const Instruction&) = default;
+    Instruction& operator=(Instruction&&) = default;
 };
 
 /*
@@ -37,24 +57,82 @@ struct SymbolRef {
     Instruction* instruction; // 引用符号属于哪条 Instruction
 };
 
-using InstructionList = std::vector<Instruction>;
+using InstructionList = std::pmr::vector<Instruction>;
 
 /*
- * UnsolvedSymbolMap（未解决符号表）：
- *      key   = 符号名（如 Label）
- *      value = 所有引用该符号的 SymbolRef 列表
- *
- * 用于解决前向引用，第二遍扫描进行符号回填时使用。
+ * Relocation：一处待回填的符号引用（符号 id + 引用位置 + addend，见 Expression.h）
+ */
+struct Relocation {
+    SymbolId symbol;
+    SymbolRef ref;
+    Addend addend;
+};
+
+/*
+ * LocalRelocation：对局部 Label 的引用（见 LocalLabel.h），名字不驻留到 SymbolInterner
  */
-using UnsolvedSymbolMap =
-    std::unordered_map<std::string, std::vector<SymbolRef>>;
+struct LocalRelocation {
+    std::string symbol;
+    SymbolRef ref;
+    Addend addend;
+};
 
 /*
- * SymbolMap（已解决符号表）：
- *      key   = 符号名
- *      value = 符号对应的地址
+ * RelocationTemplate：与地址无关的符号引用（机器码下标 + 符号名 + addend）
+ * 编码记忆、增量缓存和语言服务器用它把引用重新登记到另一份机器码上
  */
-using SymbolMap = std::unordered_map<std::string, unsigned int>;
+struct RelocationTemplate {
+    unsigned index;
+    std::string symbol;
+    Addend addend;
+};
+
+/*
+ * UnsolvedSymbolMap（未解决符号表）：
+ *      按登记顺序存放的 Relocation 数组，符号名驻留在对应 SymbolMap 的 SymbolInterner 中
+ *
+ * 用于解决前向引用，第二遍扫描按数组顺序回填，错误也按源文件顺序报告。
+ * 对局部 Label 的引用另存在 Locals() 中，由各汇编流程逐行交给所在作用域的 LocalLabelScope。
+ */
+class UnsolvedSymbolMap {
+public:
+    // 从 names 所在的 SymbolMap 构造时与它使用同一个 memory_resource，否则使用默认的
+    explicit UnsolvedSymbolMap(SymbolInterner& names) : names(&names) {}
+    explicit UnsolvedSymbolMap(SymbolMap& symbol_map)
+        : names(&symbol_map.Names()), relocations(symbol_map.Names().Resource()) {}
+
+    void Add(std::string_view symbol, SymbolRef ref, Addend addend = {}) {
+        if (isLocalReference(symbol)) {
+            locals.push_back(LocalRelocation{std::string(symbol), ref, addend});
+            return;
+        }
+        Add(names->Intern(symbol), ref, addend);
+    }
+    void Add(SymbolId symbol, SymbolRef ref, Addend addend = {}) {
+        relocations.push_back(Relocation{symbol, ref, addend});
+    }
+
+    SymbolInterner& Names() const { return *names; }
+
+    std::pmr::vector<Relocation>::const_iterator begin() const { return relocations.begin(); }
+    std::pmr::vector<Relocation>::const_iterator end() const { return relocations.end(); }
+    size_t size() const { return relocations.size(); }
+    bool empty() const { return relocations.empty(); }
+    void clear() {
+        relocations.clear();
+        locals.clear();
+    }
+
+    const std::vector<LocalRelocation>& Locals() const { return locals; }
+    void ClearLocals() { locals.clear(); }
+
+    size_t MemoryBytes() const { return relocations.capacity() * sizeof(Relocation); }
+
+private:
+    SymbolInterner* names;
+    std::pmr::vector<Relocation> relocations;
+    std::vector<LocalRelocation> locals;
+};
 
 /*
  * NewMachineCode：
@@ -63,28 +141,17 @@ using SymbolMap = std::unordered_map<std::string, unsigned int>;
  */
 MachineCodeIt NewMachineCode(Instruction& i);
 
+// 常量操作数按 Extend 检查范围（%hi/%lo 取出的半字不检查），见 Encoding.h 的 CheckImmediate
+unsigned ImmediateOperand(const Operand& operand, Extend extend);
+// 常量移位量操作数（0 ~ 31）
+unsigned ShamtOperand(const Operand& operand);
+
 // 不同类型指令的处理模块
 #include "Deal_Instruction_I.h"
 #include "Deal_Instruction_J.h"
 #include "Deal_Macro.h"
 #include "Deal_Instruction_R.h"
 
-/*
- * 下面的函数用于向一个 32-bit machine_code 中写入对应字段。
- * 每个函数都负责：
- *    - 检查数值范围是否合法
- *    - 清空 machine_code 对应 bit 位
- *    - 写入新的值
- */
-void SetOP(MachineCode& machine_code, unsigned OP);
-void SetRS(MachineCode& machine_code, unsigned RS);
-void SetRT(MachineCode& machine_code, unsigned RT);
-void SetRD(MachineCode& machine_code, unsigned RD);
-void SetShamt(MachineCode& machine_code, unsigned shamt);
-void SetFunc(MachineCode& machine_code, unsigned func);
-void SetImmediate(MachineCode& machine_code, int immediate);
-void SetAddress(MachineCode& machine_code, unsigned address);
-
 /*
  * 从汇编语句中提取助记符（mnemonic）
  * 例如： "  add $t1, $t2, $t3"
@@ -0,0 +1,158 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+#include "Encoding.h"
+
+/*
+ * MiniSys-1A 指令集表（constexpr）
+ *
+ * 指令表由 isa/minisys1a.isa 描述，isa/isagen 生成 IsaTables.h（见 Makefile）；
+ * 本文件定义表的类型与查找函数。
+ * 运行时的分发与逐条编码（Deal_Instruction_R/I/J、Deal_Macro）、符号回填、寄存器解析（Register.cpp）
+ * 与编译期汇编器（ConstexprAssembler.h）共用这里的表，编码结果保持一致。
+ * 本头文件只依赖标准库与 Encoding.h，可以单独被仿真器等外部代码包含。
+ */
+
+// 汇编时交给哪个编码器处理
+enum class Format : std::uint8_t { R, I, J, Macro };
+
+// 汇编语法：操作数的个数、顺序与种类（也决定机器码布局，见 isagen）
+enum class Syntax : std::uint8_t {
+    RdRsRt,       // add   rd, rs, rt
+    RdRtRs,       // sllv  rd, rt, rs
+    RdRtShamt,    // sll   rd, rt, shamt
+    RsRt,         // mult  rs, rt
+    RdRs,         // jalr  rd, rs
+    Rs,           // jr    rs
+    Rd,           // mfhi  rd
+    NoOperand,    // syscall
+    RtRsImm,      // addi  rt, rs, imm
+    RsRtOffset,   // beq   rs, rt, label
+    RtImm,        // lui   rt, imm
+    RsOffset,     // bgez  rs, label
+    RtMem,        // lw    rt, offset(rs)
+    Target,       // j     target
+    Cop0,         // mfc0  rt, rd[, sel]
+    Macro,        // 宏指令，操作数由 Deal_Macro 自行解析
+};
+
+// 操作数为符号时第二遍回填的方式
+enum class Fixup : std::uint8_t {
+    None,    // 不接受符号
+    Shamt,   // 移位量，5 位无符号
+    Abs16,   // 符号的绝对地址，16 位无符号
+    Rel16,   // (target - (PC + 4)) >> 2，16 位有符号
+    Abs26,   // target >> 2，26 位无符号
+};
+
+/*
+ * 一条指令：
+ *   op/rs/rt/func：固定字段（ERET、MTC0 固定 RS；REGIMM 类分支用 RT 区分条件）
+ *   base：固定字段拼好的机器码，编码时把操作数字段或进去即可
+ *   mask：固定字段的掩码，(code & mask) == base 即为这条指令（宏指令均为 0）
+ * I 格式立即数的扩展方式由 OP 决定，见 ImmediateExtend()
+ */
+struct OpcodeInfo {
+    std::string_view mnemonic;   // 大写
+    Format format;
+    Syntax syntax;
+    Fixup fixup;
+    std::uint8_t op;
+    std::uint8_t rs;
+    std::uint8_t rt;
+    std::uint8_t func;
+    MachineCode base;
+    MachineCode mask;
+};
+
+// 助记符完美哈希的槽位，key 为 0 表示空槽
+struct MnemonicSlot {
+    std::uint64_t key;
+    std::int16_t index;
+};
+
+// OP 相同的一组指令按 (code >> shift) 的低 width 位再查一次
+struct DecodeGroup {
+    std::uint8_t shift;
+    std::uint8_t width;
+    std::int16_t entry[64];
+};
+
+#include "IsaTables.h"
+
+/*
+ * 寄存器别名（不含 $），k0/k1、gp、fp 各有两个名字
+ */
+struct RegisterName {
+    std::string_view name;   // 大写
+    std::uint8_t id;
+};
+
+inline constexpr RegisterName kRegisterNames[] = {
+    {"ZERO", 0}, {"AT", 1},  {"V0", 2},  {"V1", 3},  {"A0", 4},  {"A1", 5},  {"A2", 6},
+    {"A3", 7},   {"T0", 8},  {"T1", 9},  {"T2", 10}, {"T3", 11}, {"T4", 12}, {"T5", 13},
+    {"T6", 14},  {"T7", 15}, {"S0", 16}, {"S1", 17}, {"S2", 18}, {"S3", 19}, {"S4", 20},
+    {"S5", 21},  {"S6", 22}, {"S7", 23}, {"T8", 24}, {"T9", 25}, {"K0", 26}, {"I0", 26},
+    {"K1", 27},  {"I1", 27}, {"GP", 28}, {"S9", 28}, {"SP", 29}, {"FP", 30}, {"S8", 30},
+    {"RA", 31}};
+
+// s 与大写的 upper 是否相同（忽略 s 的大小写）
+constexpr bool EqualsIgnoreCase(std::string_view s, std::string_view upper) {
+    if (s.size() != upper.size()) return false;
+    for (size_t i = 0; i < s.size(); i++) {
+        char c = s[i] >= 'a' && s[i] <= 'z' ? static_cast<char>(s[i] - 'a' + 'A') : s[i];
+        if (c != upper[i]) return false;
+    }
+    return true;
+}
+
+/*
+ * 助记符打包为 64 位整数（转大写，低字节在前），超过 8 个字符或为空时返回 0。
+ * 与 isagen 的打包方式相同。
+ */
+constexpr std::uint64_t MnemonicKey(std::string_view mnemonic) {
+    if (mnemonic.empty() || mnemonic.size() > 8) return 0;
+    std::uint64_t key = 0;
+    for (size_t i = 0; i < mnemonic.size(); i++) {
+        char c = mnemonic[i];
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+        key |= std::uint64_t(static_cast<unsigned char>(c)) << (8 * i);
+    }
+    return key;
+}
+
+// 按助记符查找（不区分大小写），不存在时返回 nullptr：一次乘法定位槽位，一次比较确认
+constexpr const OpcodeInfo* FindOpcode(std::string_view mnemonic) {
+    std::uint64_t key = MnemonicKey(mnemonic);
+    if (key == 0) return nullptr;
+    const MnemonicSlot& slot =
+        kMnemonicSlots[(key * kMnemonicHashMultiplier) >> (64 - kMnemonicHashBits)];
+    return slot.key == key ? &kOpcodeTable[slot.index] : nullptr;
+}
+
+// 由机器码找到指令（反汇编、符号回填使用），固定字段不符时返回 nullptr
+constexpr const OpcodeInfo* DecodeOpcode(MachineCode code) {
+    int index = kDecodeByOp[OpField::Get(code)];
+    if (index <= -2) {
+        const DecodeGroup& group = kDecodeGroups[-2 - index];
+        index = group.entry[(code >> group.shift) & ((1u << group.width) - 1)];
+    }
+    if (index < 0) return nullptr;
+    const OpcodeInfo& info = kOpcodeTable[index];
+    return (code & info.mask) == info.base ? &info : nullptr;
+}
+
+// 生成的表自检：大小写、未定义的助记符与解码
+static_assert(FindOpcode("addiu") != nullptr && FindOpcode("addiu")->op == 0b001001, "FindOpcode");
+static_assert(FindOpcode("ADDIUX") == nullptr && FindOpcode("") == nullptr, "FindOpcode");
+static_assert(DecodeOpcode(0x1500FFFE) == FindOpcode("BNE"), "DecodeOpcode");
+static_assert(DecodeOpcode(0x42000018) == FindOpcode("ERET"), "DecodeOpcode");
+
+// 按别名查找寄存器编号（不区分大小写、不含 $），不存在时返回 -1
+constexpr int FindRegisterName(std::string_view name) {
+    for (const RegisterName& r : kRegisterNames) {
+        if (EqualsIgnoreCase(name, r.name)) return r.id;
+    }
+    return -1;
+}
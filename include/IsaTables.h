@@ -0,0 +1,355 @@
+#pragma once
+// 由 isa/isagen 从 isa/minisys1a.isa 生成，请勿手工修改（make 会在描述文件变化后重新生成）
+// 由 Isa.h 包含，类型与查找函数见 Isa.h
+
+inline constexpr OpcodeInfo kOpcodeTable[] = {
+    {"ADD", Format::R, Syntax::RdRsRt, Fixup::None, 0x00, 0x00, 0x00, 0x20, 0x00000020, 0xFC0007FF},
+    {"ADDU", Format::R, Syntax::RdRsRt, Fixup::None, 0x00, 0x00, 0x00, 0x21, 0x00000021, 0xFC0007FF},
+    {"SUB", Format::R, Syntax::RdRsRt, Fixup::None, 0x00, 0x00, 0x00, 0x22, 0x00000022, 0xFC0007FF},
+    {"SUBU", Format::R, Syntax::RdRsRt, Fixup::None, 0x00, 0x00, 0x00, 0x23, 0x00000023, 0xFC0007FF},
+    {"AND", Format::R, Syntax::RdRsRt, Fixup::None, 0x00, 0x00, 0x00, 0x24, 0x00000024, 0xFC0007FF},
+    {"OR", Format::R, Syntax::RdRsRt, Fixup::None, 0x00, 0x00, 0x00, 0x25, 0x00000025, 0xFC0007FF},
+    {"XOR", Format::R, Syntax::RdRsRt, Fixup::None, 0x00, 0x00, 0x00, 0x26, 0x00000026, 0xFC0007FF},
+    {"NOR", Format::R, Syntax::RdRsRt, Fixup::None, 0x00, 0x00, 0x00, 0x27, 0x00000027, 0xFC0007FF},
+    {"SLT", Format::R, Syntax::RdRsRt, Fixup::None, 0x00, 0x00, 0x00, 0x2A, 0x0000002A, 0xFC0007FF},
+    {"SLTU", Format::R, Syntax::RdRsRt, Fixup::None, 0x00, 0x00, 0x00, 0x2B, 0x0000002B, 0xFC0007FF},
+    {"SLLV", Format::R, Syntax::RdRtRs, Fixup::None, 0x00, 0x00, 0x00, 0x04, 0x00000004, 0xFC0007FF},
+    {"SRLV", Format::R, Syntax::RdRtRs, Fixup::None, 0x00, 0x00, 0x00, 0x06, 0x00000006, 0xFC0007FF},
+    {"SRAV", Format::R, Syntax::RdRtRs, Fixup::None, 0x00, 0x00, 0x00, 0x07, 0x00000007, 0xFC0007FF},
+    {"SLL", Format::R, Syntax::RdRtShamt, Fixup::Shamt, 0x00, 0x00, 0x00, 0x00, 0x00000000, 0xFFE0003F},
+    {"SRL", Format::R, Syntax::RdRtShamt, Fixup::Shamt, 0x00, 0x00, 0x00, 0x02, 0x00000002, 0xFFE0003F},
+    {"SRA", Format::R, Syntax::RdRtShamt, Fixup::Shamt, 0x00, 0x00, 0x00, 0x03, 0x00000003, 0xFFE0003F},
+    {"MULT", Format::R, Syntax::RsRt, Fixup::None, 0x00, 0x00, 0x00, 0x18, 0x00000018, 0xFC00FFFF},
+    {"MULTU", Format::R, Syntax::RsRt, Fixup::None, 0x00, 0x00, 0x00, 0x19, 0x00000019, 0xFC00FFFF},
+    {"DIV", Format::R, Syntax::RsRt, Fixup::None, 0x00, 0x00, 0x00, 0x1A, 0x0000001A, 0xFC00FFFF},
+    {"DIVU", Format::R, Syntax::RsRt, Fixup::None, 0x00, 0x00, 0x00, 0x1B, 0x0000001B, 0xFC00FFFF},
+    {"JALR", Format::R, Syntax::RdRs, Fixup::None, 0x00, 0x00, 0x00, 0x09, 0x00000009, 0xFC1F07FF},
+    {"JR", Format::R, Syntax::Rs, Fixup::None, 0x00, 0x00, 0x00, 0x08, 0x00000008, 0xFC1FFFFF},
+    {"MTHI", Format::R, Syntax::Rs, Fixup::None, 0x00, 0x00, 0x00, 0x11, 0x00000011, 0xFC1FFFFF},
+    {"MTLO", Format::R, Syntax::Rs, Fixup::None, 0x00, 0x00, 0x00, 0x13, 0x00000013, 0xFC1FFFFF},
+    {"MFHI", Format::R, Syntax::Rd, Fixup::None, 0x00, 0x00, 0x00, 0x10, 0x00000010, 0xFFFF07FF},
+    {"MFLO", Format::R, Syntax::Rd, Fixup::None, 0x00, 0x00, 0x00, 0x12, 0x00000012, 0xFFFF07FF},
+    {"BREAK", Format::R, Syntax::NoOperand, Fixup::None, 0x00, 0x00, 0x00, 0x0D, 0x0000000D, 0xFFFFFFFF},
+    {"SYSCALL", Format::R, Syntax::NoOperand, Fixup::None, 0x00, 0x00, 0x00, 0x0C, 0x0000000C, 0xFFFFFFFF},
+    {"ERET", Format::R, Syntax::NoOperand, Fixup::None, 0x10, 0x10, 0x00, 0x18, 0x42000018, 0xFFFFFFFF},
+    {"MFC0", Format::I, Syntax::Cop0, Fixup::None, 0x10, 0x00, 0x00, 0x00, 0x40000000, 0xFFE007C0},
+    {"MTC0", Format::I, Syntax::Cop0, Fixup::None, 0x10, 0x04, 0x00, 0x00, 0x40800000, 0xFFE007C0},
+    {"ADDI", Format::I, Syntax::RtRsImm, Fixup::Abs16, 0x08, 0x00, 0x00, 0x00, 0x20000000, 0xFC000000},
+    {"ADDIU", Format::I, Syntax::RtRsImm, Fixup::Abs16, 0x09, 0x00, 0x00, 0x00, 0x24000000, 0xFC000000},
+    {"ANDI", Format::I, Syntax::RtRsImm, Fixup::Abs16, 0x0C, 0x00, 0x00, 0x00, 0x30000000, 0xFC000000},
+    {"ORI", Format::I, Syntax::RtRsImm, Fixup::Abs16, 0x0D, 0x00, 0x00, 0x00, 0x34000000, 0xFC000000},
+    {"XORI", Format::I, Syntax::RtRsImm, Fixup::Abs16, 0x0E, 0x00, 0x00, 0x00, 0x38000000, 0xFC000000},
+    {"SLTI", Format::I, Syntax::RtRsImm, Fixup::Abs16, 0x0A, 0x00, 0x00, 0x00, 0x28000000, 0xFC000000},
+    {"SLTIU", Format::I, Syntax::RtRsImm, Fixup::Abs16, 0x0B, 0x00, 0x00, 0x00, 0x2C000000, 0xFC000000},
+    {"LUI", Format::I, Syntax::RtImm, Fixup::Abs16, 0x0F, 0x00, 0x00, 0x00, 0x3C000000, 0xFFE00000},
+    {"BEQ", Format::I, Syntax::RsRtOffset, Fixup::Rel16, 0x04, 0x00, 0x00, 0x00, 0x10000000, 0xFC000000},
+    {"BNE", Format::I, Syntax::RsRtOffset, Fixup::Rel16, 0x05, 0x00, 0x00, 0x00, 0x14000000, 0xFC000000},
+    {"BGEZ", Format::I, Syntax::RsOffset, Fixup::Rel16, 0x01, 0x00, 0x01, 0x00, 0x04010000, 0xFC1F0000},
+    {"BGTZ", Format::I, Syntax::RsOffset, Fixup::Rel16, 0x07, 0x00, 0x00, 0x00, 0x1C000000, 0xFC1F0000},
+    {"BLEZ", Format::I, Syntax::RsOffset, Fixup::Rel16, 0x06, 0x00, 0x00, 0x00, 0x18000000, 0xFC1F0000},
+    {"BLTZ", Format::I, Syntax::RsOffset, Fixup::Rel16, 0x01, 0x00, 0x00, 0x00, 0x04000000, 0xFC1F0000},
+    {"BGEZAL", Format::I, Syntax::RsOffset, Fixup::Rel16, 0x01, 0x00, 0x11, 0x00, 0x04110000, 0xFC1F0000},
+    {"BLTZAL", Format::I, Syntax::RsOffset, Fixup::Rel16, 0x01, 0x00, 0x10, 0x00, 0x04100000, 0xFC1F0000},
+    {"LW", Format::I, Syntax::RtMem, Fixup::Abs16, 0x23, 0x00, 0x00, 0x00, 0x8C000000, 0xFC000000},
+    {"LH", Format::I, Syntax::RtMem, Fixup::Abs16, 0x21, 0x00, 0x00, 0x00, 0x84000000, 0xFC000000},
+    {"LHU", Format::I, Syntax::RtMem, Fixup::Abs16, 0x25, 0x00, 0x00, 0x00, 0x94000000, 0xFC000000},
+    {"LB", Format::I, Syntax::RtMem, Fixup::Abs16, 0x20, 0x00, 0x00, 0x00, 0x80000000, 0xFC000000},
+    {"LBU", Format::I, Syntax::RtMem, Fixup::Abs16, 0x24, 0x00, 0x00, 0x00, 0x90000000, 0xFC000000},
+    {"SW", Format::I, Syntax::RtMem, Fixup::Abs16, 0x2B, 0x00, 0x00, 0x00, 0xAC000000, 0xFC000000},
+    {"SH", Format::I, Syntax::RtMem, Fixup::Abs16, 0x29, 0x00, 0x00, 0x00, 0xA4000000, 0xFC000000},
+    {"SB", Format::I, Syntax::RtMem, Fixup::Abs16, 0x28, 0x00, 0x00, 0x00, 0xA0000000, 0xFC000000},
+    {"J", Format::J, Syntax::Target, Fixup::Abs26, 0x02, 0x00, 0x00, 0x00, 0x08000000, 0xFC000000},
+    {"JAL", Format::J, Syntax::Target, Fixup::Abs26, 0x03, 0x00, 0x00, 0x00, 0x0C000000, 0xFC000000},
+    {"MOV", Format::Macro, Syntax::Macro, Fixup::None, 0x00, 0x00, 0x00, 0x00, 0x00000000, 0x00000000},
+    {"PUSH", Format::Macro, Syntax::Macro, Fixup::None, 0x00, 0x00, 0x00, 0x00, 0x00000000, 0x00000000},
+    {"POP", Format::Macro, Syntax::Macro, Fixup::None, 0x00, 0x00, 0x00, 0x00, 0x00000000, 0x00000000},
+    {"NOP", Format::Macro, Syntax::Macro, Fixup::None, 0x00, 0x00, 0x00, 0x00, 0x00000000, 0x00000000},
+};
+
+// 助记符完美哈希：槽位 = (MnemonicKey(m) * kMnemonicHashMultiplier) >> (64 - kMnemonicHashBits)
+inline constexpr std::uint64_t kMnemonicHashMultiplier = 0x244E51CC4883EC15ULL;
+inline constexpr unsigned kMnemonicHashBits = 8;
+inline constexpr MnemonicSlot kMnemonicSlots[256] = {
+    {0x0000000049444441ULL, 31},   // ADDI
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x000000003043464DULL, 29},   // MFC0
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x0000000049444E41ULL, 33},   // ANDI
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x0000000000504F50ULL, 59},   // POP
+    {0x0000005549444441ULL, 32},   // ADDIU
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x00000000524C414AULL, 20},   // JALR
+    {0x0000000049524F58ULL, 35},   // XORI
+    {0x000000000049554CULL, 38},   // LUI
+    {0, -1},
+    {0x0000000049544C53ULL, 36},   // SLTI
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x000000000055424CULL, 51},   // LBU
+    {0, -1},
+    {0, -1},
+    {0x00000000004C5253ULL, 14},   // SRL
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x0000005549544C53ULL, 37},   // SLTIU
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x00000000544C554DULL, 16},   // MULT
+    {0, -1},
+    {0, -1},
+    {0x0000000056415253ULL, 12},   // SRAV
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x000000005A544C42ULL, 44},   // BLTZ
+    {0x0000000000454E42ULL, 40},   // BNE
+    {0, -1},
+    {0, -1},
+    {0x0000000055564944ULL, 19},   // DIVU
+    {0, -1},
+    {0x000000000000524FULL, 5},   // OR
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x00000000004C4C53ULL, 13},   // SLL
+    {0, -1},
+    {0x00000055544C554DULL, 17},   // MULTU
+    {0, -1},
+    {0, -1},
+    {0x0000000048535550ULL, 58},   // PUSH
+    {0x000000003043544DULL, 30},   // MTC0
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x0000000000514542ULL, 39},   // BEQ
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x0000000000005753ULL, 52},   // SW
+    {0, -1},
+    {0x000000000000574CULL, 47},   // LW
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x0000000000524F4EULL, 7},   // NOR
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x0000000000564944ULL, 18},   // DIV
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x000000005A454C42ULL, 43},   // BLEZ
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x000000000000004AULL, 55},   // J
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x00004C415A454742ULL, 45},   // BGEZAL
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x0000000000564F4DULL, 57},   // MOV
+    {0, -1},
+    {0x0000000055444441ULL, 1},   // ADDU
+    {0x000000000000524AULL, 21},   // JR
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x000000004948464DULL, 24},   // MFHI
+    {0, -1},
+    {0, -1},
+    {0x0000004B41455242ULL, 26},   // BREAK
+    {0, -1},
+    {0x000000000049524FULL, 34},   // ORI
+    {0, -1},
+    {0, -1},
+    {0x0000000000415253ULL, 15},   // SRA
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x004C4C4143535953ULL, 27},   // SYSCALL
+    {0, -1},
+    {0, -1},
+    {0x000000004F4C464DULL, 25},   // MFLO
+    {0, -1},
+    {0x00000000004C414AULL, 56},   // JAL
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x0000000055544C53ULL, 9},   // SLTU
+    {0x0000000055425553ULL, 3},   // SUBU
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x000000005A544742ULL, 42},   // BGTZ
+    {0, -1},
+    {0x0000000000444441ULL, 0},   // ADD
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x00000000564C5253ULL, 11},   // SRLV
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x0000000000504F4EULL, 60},   // NOP
+    {0, -1},
+    {0x0000000000004853ULL, 53},   // SH
+    {0, -1},
+    {0x000000000000484CULL, 48},   // LH
+    {0x0000000000444E41ULL, 4},   // AND
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x00004C415A544C42ULL, 46},   // BLTZAL
+    {0x0000000000524F58ULL, 6},   // XOR
+    {0, -1},
+    {0, -1},
+    {0x0000000000544C53ULL, 8},   // SLT
+    {0x0000000000425553ULL, 2},   // SUB
+    {0, -1},
+    {0, -1},
+    {0x000000004948544DULL, 22},   // MTHI
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0x00000000564C4C53ULL, 10},   // SLLV
+    {0, -1},
+    {0, -1},
+    {0x000000004F4C544DULL, 23},   // MTLO
+    {0x000000005A454742ULL, 41},   // BGEZ
+    {0x0000000054455245ULL, 28},   // ERET
+    {0, -1},
+    {0, -1},
+    {0x0000000000004253ULL, 54},   // SB
+    {0x000000000055484CULL, 49},   // LHU
+    {0x000000000000424CULL, 50},   // LB
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+    {0, -1},
+};
+
+// 解码表：按 OP 索引，>= 0 为 kOpcodeTable 下标，-1 为未定义，<= -2 为 kDecodeGroups[-2 - v]
+inline constexpr std::int16_t kDecodeByOp[64] = {
+    -2, -3, 55, 56, 39, 40, 43, 42, 31, 32, 36, 37, 33, 34, 35, 38,
+    -4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    50, 48, -1, 47, 51, 49, -1, -1, 54, 53, -1, 52, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+inline constexpr DecodeGroup kDecodeGroups[] = {
+    {0, 6,   // Func
+     {13, -1, 14, 15, 10, -1, 11, 12, 21, 20, -1, -1, 27, 26, -1, -1,
+      24, 22, 25, 23, -1, -1, -1, -1, 16, 17, 18, 19, -1, -1, -1, -1,
+      0, 1, 2, 3, 4, 5, 6, 7, -1, -1, 8, 9, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,}},
+    {16, 5,   // RT
+     {44, 41, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      46, 45, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,}},
+    {21, 5,   // RS
+     {29, -1, -1, -1, 30, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      28, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,}},
+};
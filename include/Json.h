@@ -0,0 +1,63 @@
+#pragma once
+
+/*
+ * 最小的 JSON 模块（语言服务器使用）
+ *
+ * Json 可以是 null、bool、数字、字符串、数组或对象。
+ * 对象用 (键, 值) 数组保存，保持插入顺序；LSP 消息很小，线性查找即可。
+ * 字符串按 UTF-8 保存，解析时把 \uXXXX（含代理对）转换为 UTF-8。
+ */
+class Json {
+   public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Json() = default;
+    Json(std::nullptr_t) {}
+    Json(bool value) : type(Type::Bool), bool_value(value) {}
+    Json(int value) : type(Type::Number), number_value(value) {}
+    Json(unsigned value) : type(Type::Number), number_value(value) {}
+    Json(double value) : type(Type::Number), number_value(value) {}
+    Json(const char* value) : type(Type::String), string_value(value) {}
+    Json(std::string value) : type(Type::String), string_value(std::move(value)) {}
+
+    static Json MakeArray();
+    static Json MakeObject();
+
+    Type GetType() const { return type; }
+    bool IsNull() const { return type == Type::Null; }
+    bool IsString() const { return type == Type::String; }
+    bool IsNumber() const { return type == Type::Number; }
+    bool IsArray() const { return type == Type::Array; }
+    bool IsObject() const { return type == Type::Object; }
+
+    // 取值：类型不符时返回默认值
+    bool AsBool() const { return type == Type::Bool && bool_value; }
+    double AsNumber() const { return type == Type::Number ? number_value : 0; }
+    int AsInt() const { return static_cast<int>(AsNumber()); }
+    const std::string& AsString() const;
+
+    // 对象：读取不存在的键返回 null；写入时不存在则追加（null 会先变为空对象）
+    bool Has(const std::string& key) const;
+    const Json& operator[](const std::string& key) const;
+    Json& operator[](const std::string& key);
+
+    // 数组：Push 时 null 会先变为空数组
+    const std::vector<Json>& Items() const { return array_items; }
+    void Push(Json value);
+
+    std::string Dump() const;
+    void Dump(std::string& out) const;
+
+    // 解析 JSON 文本，格式错误时返回 false
+    static bool Parse(const std::string& text, Json& out);
+
+   private:
+    Type type = Type::Null;
+    bool bool_value = false;
+    double number_value = 0;
+    std::string string_value;
+    std::vector<Json> array_items;
+    std::vector<std::pair<std::string, Json>> object_items;
+
+    friend class JsonParser;
+};
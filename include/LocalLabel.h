@@ -0,0 +1,127 @@
+#pragma once
+
+/*
+ * 局部 Label 模块
+ *
+ * 两种局部 Label（写法与 GNU as 相同），都不进入全局符号表：
+ *   - 数字 Label：`1:`，可以重复定义；`1b` 引用之前最近一次定义的 1，`1f` 引用之后第一次定义的 1
+ *   - .L 开头的 Label：`.Lloop:`，只在所在的函数内可见，同一函数内不能重复定义；
+ *     前缀区分大小写（其余部分不区分），`.loop`、`.list` 仍是普通 Label
+ * 函数（作用域）指代码段中两个全局 Label（其余的 Label）之间的部分。
+ *
+ * 局部 Label 只登记在当前作用域的 LocalLabelScope 中：
+ *   - 后向引用（1b、已定义的 .L Label）在引用时立即回填
+ *   - 前向引用（1f、未定义的 .L Label）记在表中，Label 出现时回填
+ *   - 遇到下一个全局 Label 或代码段结束时关闭作用域，仍在等待的引用报 Unknown Symbol，整张表清空
+ * 因此数字 Label 的引用不能跨过全局 Label（GNU as 中可以），.L Label 也不能跨函数引用；
+ * 局部 Label 只能定义在代码段中。
+ * 名字都是 toCanonicalCase 之后的形式（1B、1F、.lLOOP）：.L 前缀记为 .l，与转成大写的普通 Label 区分。
+ */
+
+inline bool IsLocalDigits(std::string_view text) {
+    if (text.empty()) return false;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+    }
+    return true;
+}
+
+// 是否为 .L Label 的名字（".lLOOP"）
+inline bool IsLocalPrefixed(std::string_view name) {
+    return name.size() > 2 && name[0] == '.' && name[1] == 'l';
+}
+
+// 是否为局部 Label 的定义（"1"、".lLOOP"）
+inline bool isLocalLabel(std::string_view label) { return IsLocalDigits(label) || IsLocalPrefixed(label); }
+
+// 是否为对局部 Label 的引用（"1B"、"1F"、".lLOOP"）
+inline bool isLocalReference(std::string_view symbol) {
+    if (!symbol.empty() && (symbol.back() == 'B' || symbol.back() == 'F'))
+        if (IsLocalDigits(symbol.substr(0, symbol.size() - 1))) return true;
+    return IsLocalPrefixed(symbol);
+}
+
+// 错误信息中显示的名字：.lLOOP 显示为 .LLOOP
+inline std::string LocalLabelName(std::string_view name) {
+    std::string shown(name);
+    if (IsLocalPrefixed(shown)) shown[1] = 'L';
+    return shown;
+}
+
+/*
+ * LocalLabelScope：一个作用域内的局部 Label 与前向引用
+ *   Fixup 为调用方记录的回填位置（两遍扫描中是机器码的引用，流式汇编中是镜像中的字地址）
+ */
+template <typename Fixup>
+class LocalLabelScope {
+   public:
+    enum class Lookup { Resolved, Pending, Undefined };
+
+    /*
+     * 定义局部 Label：等待它的前向引用依次交给 resolve(引用名, fixup, 地址)
+     * .L Label 在本作用域内重复定义时不修改并返回 false
+     */
+    template <typename Resolve>
+    bool Define(const std::string& label, unsigned address, Resolve&& resolve) {
+        Entry& entry = labels[label];
+        const bool numeric = IsLocalDigits(label);
+        if (entry.defined && !numeric) return false;
+        entry.defined = true;
+        entry.address = address;
+
+        const std::string symbol = numeric ? label + "F" : label;
+        for (const auto& fixup : entry.waiting) resolve(symbol, fixup, address);
+        entry.waiting.clear();
+        return true;
+    }
+
+    /*
+     * 引用局部 Label：目标已定义时写入 address 并返回 Resolved，
+     * 前向引用记下 fixup 并返回 Pending，1B 之前没有定义 1 时返回 Undefined
+     */
+    Lookup Reference(const std::string& symbol, const Fixup& fixup, unsigned& address) {
+        const char direction = IsLocalDigits(symbol.substr(0, symbol.size() - 1)) ? symbol.back() : 0;
+        const std::string key = direction ? symbol.substr(0, symbol.size() - 1) : symbol;
+
+        if (direction == 'B') {
+            auto it = labels.find(key);
+            if (it == labels.end() || !it->second.defined) return Lookup::Undefined;
+            address = it->second.address;
+            return Lookup::Resolved;
+        }
+
+        Entry& entry = labels[key];
+        if (direction == 0 && entry.defined) {
+            address = entry.address;
+            return Lookup::Resolved;
+        }
+        if (entry.waiting.empty()) waiting_order.push_back(key);
+        entry.waiting.push_back(fixup);
+        return Lookup::Pending;
+    }
+
+    /*
+     * 关闭作用域：仍在等待的引用按名字（第一次引用的顺序）交给 undefined(引用名, fixups)，
+     * 然后清空整张表
+     */
+    template <typename Report>
+    void Close(Report&& undefined) {
+        for (const auto& key : waiting_order) {
+            Entry& entry = labels[key];
+            if (entry.waiting.empty()) continue;
+            undefined(IsLocalDigits(key) ? key + "F" : key, entry.waiting);
+            entry.waiting.clear();
+        }
+        labels.clear();
+        waiting_order.clear();
+    }
+
+   private:
+    struct Entry {
+        unsigned address = 0;
+        bool defined = false;
+        std::vector<Fixup> waiting;   // 等待下一次定义的前向引用
+    };
+    std::unordered_map<std::string, Entry> labels;   // 键：数字 Label 为数字，.L Label 为全名
+    std::vector<std::string> waiting_order;          // 有前向引用的键，按引用顺序（可能重复）
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+/*
+ * 语言服务器（mas --lsp）
+ *
+ * 通过标准输入/输出按 LSP（Content-Length 头 + JSON-RPC）与编辑器通信，支持：
+ *   - textDocument/didOpen、didChange（增量同步）、didClose
+ *   - textDocument/publishDiagnostics：Error.h 中的错误信息，带列号
+ *     （列号取自 AssemblerError::Token 在行中的位置，找不到时标出整条语句）
+ *   - textDocument/hover：光标所在行的地址与机器码（已回填符号），符号的地址
+ *   - textDocument/definition：跳转到 Label 的定义
+ *
+ * 文档在内存中按行保存解析结果（去注释后的文本、段切换指令、按代码段/数据段编码的机器码、
+ * Label、符号引用、地址、错误与警告），符号表记录每个全局 Label 的定义行与引用它的行。
+ * 每次修改只重新解析被修改的行，其余的行按地址差增量更新：
+ *   - 之后同一段中的行地址加上长度差，只重新检查目标地址变化了的引用
+ *     （引用处与目标一起移动的相对分支不变，不再检查）
+ *   - 局部 Label 只在修改所在的函数内重新解析
+ *   - 修改涉及段切换指令或重复定义的全局 Label 时，退回一次完整的全局扫描（只做地址累加、
+ *     符号表重建与回填检查，不重新编码未修改的行）
+ * 发布诊断时只访问有诊断的行。
+ *
+ * 诊断与命令行汇编的区别：命令行遇到第一个阶段的错误就停止，这里会尽量报告所有行的错误；
+ * 出错的行按已分配的机器码长度计算地址，使后面的 Label 地址在输入过程中保持稳定。
+ */
+int RunLanguageServer(std::istream& in, std::ostream& out);
@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+ * 内存占用报告模块（mas --mem-report 开启）
+ *
+ * 在每个阶段结束时估算各数据结构持有的字节数：
+ *   - InstructionList / DataList 本身（结构体数组）
+ *   - 每条指令/数据里的字符串（assembly、file）
+ *   - 每条指令的 machine_code、每条数据的 raw_data
+ *   - SymbolMap（名字字符区、开放寻址表、地址数组）、UnsolvedSymbolMap（Relocation 数组）
+ *   - 列表所在的 JobArena 持有的总字节数（上面各项大多在其中）
+ * 同时记录到该阶段为止的峰值常驻内存（peak RSS）。
+ *
+ * 估算值只统计容器直接持有的内存（capacity 而非 size），不含 malloc 自身的开销。
+ */
+
+// 返回进程到目前为止的峰值常驻内存（字节），无法获取时返回 0
+std::size_t PeakRssBytes();
+
+// 把字节数格式化为便于阅读的 B/KiB/MiB/GiB
+std::string FormatBytes(std::size_t bytes);
+
+class MemoryReport {
+   public:
+    // 记录一个阶段结束时的占用情况
+    void Snapshot(const std::string& phase,
+                  const InstructionList& instruction_list,
+                  const DataList& data_list,
+                  const SymbolMap& symbol_map,
+                  const UnsolvedSymbolMap& unsolved_symbol_map);
+
+    // 输出表格：行为数据结构，列为阶段
+    void Print(std::ostream& out) const;
+
+   private:
+    struct PhaseUsage {
+        std::string phase;
+        std::vector<std::size_t> bytes;  // 与报告中的条目一一对应
+        std::size_t peak_rss;
+    };
+
+    std::vector<PhaseUsage> phases;
+};
@@ -29,5 +29,51 @@ void OutputInstruction(std::ostream& out,
 void OutputDataSegment(std::ostream& out,
                        const DataList& instruction_list);
 
-void OutputDetails(InstructionList instruction_list, DataList data_list,
-                 std::ostream& out = std::cerr);
\ No newline at end of file
+void OutputDetails(const InstructionList& instruction_list, const DataList& data_list,
+                   std::ostream& out = std::cerr);
+
+/*
+ * 以下函数把输出拆成可单独调用的部分，供流式汇编直接操作内存镜像：
+ *
+ * PlaceInstructionWords()/PlaceDataWords()：把一条指令/数据写入字镜像 mem
+ *   （超出 mem 大小的部分丢弃）
+ * OutputImage()：输出 COE 文件头和镜像的前 TOTAL_WORDS 个字
+ *   （OutputImageHeader()/OutputImageWord() 为其中的文件头和单个字，供边编码边输出时使用）
+ * OutputDetails*()：details.txt 的段标题和单行格式
+ * Build*Image()：由指令/数据列表生成 TOTAL_WORDS 个字的镜像（OutputInstruction 等使用）
+ */
+void PlaceInstructionWords(std::vector<uint32_t>& mem, unsigned address,
+                           const std::pmr::vector<MachineCode>& machine_code);
+void PlaceDataWords(std::vector<uint32_t>& mem, unsigned address,
+                    const std::pmr::vector<std::uint8_t>& raw_data);
+void OutputImage(std::ostream& out, const std::vector<uint32_t>& mem);
+void OutputImageHeader(std::ostream& out);
+void OutputImageWord(std::ostream& out, size_t index, uint32_t word);
+std::vector<uint32_t> BuildInstructionImage(const InstructionList& instruction_list);
+std::vector<uint32_t> BuildDataImage(const DataList& data_list);
+
+void OutputDetailsCodeHeader(std::ostream& out);
+void OutputDetailsDataHeader(std::ostream& out);
+void OutputDetailsCodeLine(std::ostream& out, unsigned offset, MachineCode machine_code,
+                           std::string_view assembly);
+void OutputDetailsDataLine(std::ostream& out, unsigned offset, std::uint8_t raw_data,
+                           std::string_view assembly);
+
+/*
+ * WriteFileIfChanged()：
+ *   内容与已有文件相同时不写（保留时间戳，避免 Vivado 认为 COE 已修改而重新生成 BRAM），
+ *   否则先写入 path.tmp 再改名覆盖，保证其他程序不会读到写了一半的文件。
+ *   binary 为 false 时按文本方式读写（与直接用 ofstream 输出时的换行符一致）。
+ *   写入失败返回 false；changed 非空时写入是否真的改写了文件。
+ */
+bool WriteFileIfChanged(const std::string& path, const std::string& content,
+                        bool binary = false, bool* changed = nullptr);
+
+/*
+ * WriteStreamIfChanged()：
+ *   语义与 WriteFileIfChanged 相同，但内容由 write 逐段写出，不先在内存中拼成整个字符串：
+ *   写入 path.tmp 的同时按块与已有文件比较，内容相同时删除临时文件（原文件不动），否则改名覆盖。
+ *   只占用两个固定大小的缓冲区，用于 --stream 模式中随源文件增长的 details.txt。
+ */
+bool WriteStreamIfChanged(const std::string& path, const std::function<void(std::ostream&)>& write,
+                          bool binary = false, bool* changed = nullptr);
@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+ * 增量 BRAM 补丁模块（mas --patch / --patch-base）
+ *
+ * 把新生成的代码/数据镜像与上一次的输出（输出目录中已有的 COE）或指定目录中的 COE 逐字比较，
+ * 生成只包含变化字的补丁，供 UART 引导程序只改写变化的部分：
+ *
+ *   prgmip32.patch / dmem32.patch：引导程序使用的二进制格式（小端序）
+ *       若干记录：u16 起始字地址、u16 字数 N、N 个 u32 字
+ *       结束记录：地址 0xFFFF、字数 0
+ *   patch.txt：可读的摘要（每段变化的地址范围、字数、补丁大小）
+ *
+ * 相邻两段之间只隔 1 个未变化的字时合并为一段（多写一个字与多一个记录头的开销相同）。
+ * 找不到作为基准的 COE 时，补丁包含整个镜像。
+ */
+
+// 一段连续的变化：起始字地址和新值
+struct PatchRun {
+    unsigned address;
+    std::vector<uint32_t> words;
+};
+
+/*
+ * ReadCoeImage：读取 COE 文件（格式见 Image.h）到 TOTAL_WORDS 个字的镜像，
+ * 文件不存在或格式错误时返回 false
+ */
+bool ReadCoeImage(const std::string& path, std::vector<uint32_t>& mem);
+
+// 比较两个镜像，返回变化的各段（超出 TOTAL_WORDS 的部分忽略，不足的部分按 0 处理）
+std::vector<PatchRun> DiffImages(const std::vector<uint32_t>& old_mem,
+                                 const std::vector<uint32_t>& new_mem);
+
+void OutputPatchBinary(std::ostream& out, const std::vector<PatchRun>& runs);
+
+/*
+ * WritePatches：与 base_dir 中的 prgmip32.coe/dmem32.coe 比较，
+ * 在 output_dir 中写出两个补丁文件和 patch.txt；写文件失败返回 false
+ * （base_dir 与 output_dir 相同时，必须在写新的 COE 之前调用）
+ */
+bool WritePatches(const std::string& base_dir, const std::string& output_dir,
+                  const std::vector<uint32_t>& code_image,
+                  const std::vector<uint32_t>& data_image);
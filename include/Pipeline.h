@@ -0,0 +1,21 @@
+#pragma once
+
+/*
+ * 流水线汇编模块（mas --pipeline）
+ *
+ * 与流式模式一样只扫描一遍（前向引用记为待回填项，Label 出现时回填），
+ * 但把三个阶段放到不同的线程上同时进行：
+ *   - 读入线程：逐行读入、去注释、跳过空行，按批放入有界无锁队列
+ *   - 编码（调用线程）：段切换、编码、符号表与回填
+ *   - 输出线程：把已经确定的区域格式化为 COE 与 details 文本
+ * 代码段中一条指令之前的所有字都不会再有待回填项时，这些字即为“已确定”，
+ * 编码线程把它们（连同 details 所需的汇编文本）交给输出线程；数据段不需要回填，
+ * 当前地址之前的字都已确定。全部编码完成后只剩尾部的格式化与写文件。
+ *
+ * 参数与返回值同 doAssemble；cache 为增量汇编缓存（可为 nullptr）。
+ */
+int doAssemblePipeline(std::istream& in,
+                       const std::string& input_path,
+                       const std::string& output_dir,
+                       const AssembleOptions& options,
+                       AssemblyCache* cache = nullptr);
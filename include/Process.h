@@ -21,17 +21,107 @@ public:
     bool ResolveSymbols(UnsolvedSymbolMap& unsolved_symbol_map,
                         const SymbolMap& symbol_map);
 
+    // 逐行处理：两遍扫描的循环体，也供流式汇编使用
+    // 地址取自 current_address 并向后推进；defined_label 非空时返回本行定义的 Label
+    bool ProcessInstruction(Instruction& instruction,
+                            UnsolvedSymbolMap& unsolved_symbol_map,
+                            SymbolMap& symbol_map,
+                            std::string* defined_label = nullptr);
+    bool ProcessData(Data& data, SymbolMap& symbol_map,
+                     std::string* defined_label = nullptr);
+
+    // 按指令格式把符号地址（加上 addend）回填进一条机器码（出错时抛出异常）
+    void PatchSymbol(MachineCode& machine_code, unsigned inst_addr, int symbol_addr,
+                     Addend addend = {}) const;
+
+    // 当前地址指针（流式汇编在代码段与数据段之间切换时使用）
+    unsigned int GetCurrentAddress() const { return current_address; }
+    void SetCurrentAddress(unsigned int address) { current_address = address; }
+
+    // 设置增量汇编缓存（nullptr 表示不使用缓存）
+    void SetCache(AssemblyCache* assembly_cache) { cache = assembly_cache; }
+
+    // 记录错误信息
+    void LogError(const std::string& msg, std::string_view context = {});
+
+    // 最近一次的错误信息，以及出错的源文本片段（见 AssemblerError::Token，可能为空）
+    const std::string& LastError() const { return last_error; }
+    const std::string& LastErrorToken() const { return last_error_token; }
+
+    // quiet 为 true 时 LogError 只记录、不输出（语言服务器自行发布诊断）
+    void SetQuiet(bool value) { quiet = value; }
+
+    // 符号回填使用的线程数，0 表示按 CPU 核数（引用较少时只用一个线程）
+    void SetResolveThreads(unsigned threads) { resolve_threads = threads; }
+
 private:
     // 内部状态
     unsigned int current_address; // 当前地址指针
     bool has_error; // 是否发生错误
+    bool undefined_local = false; // 第一遍扫描中有未定义的局部 Label（由 ResolveSymbols 返回）
     const Instruction* current_instruction_ptr = nullptr; // 当前处理的指令指针
+    AssemblyCache* cache = nullptr; // 增量汇编缓存
+    bool quiet = false;
+    unsigned resolve_threads = 0;
+    std::string last_error;
+    std::string last_error_token;
+    std::string statement;   // 当前行去掉 Label 与注释并转大写后的文本（缓冲区逐行复用）
+
+    /*
+     * 运行内的编码记忆：同一条语句（去掉 Label 与注释、转大写后的文本）的编码与地址无关，
+     * 重复出现时直接复制机器码，符号引用按 RelocationTemplate（下标、符号名、addend）重新登记，
+     * 编码时输出的警告也原样重放。出错的语句不记忆。
+     * 模板保存符号名而不是 id：语言服务器每次编码使用新的 SymbolMap，id 不能跨表复用。
+     */
+    struct EncodingMemo {
+        std::vector<MachineCode> machine_code;
+        std::vector<RelocationTemplate> relocations;
+        std::string diagnostics;
+    };
+    std::unordered_map<std::string, EncodingMemo> encoding_memo;
+    static constexpr size_t kMaxMemoEntries = 1 << 16; // 超过后清空（语言服务器长期复用同一个 AssemblerCore）
+
+    // 对 assembly 编码（先查编码记忆），符号引用登记到 refs
+    void EncodeInstruction(const std::string& assembly, Instruction& instruction,
+                           UnsolvedSymbolMap& refs);
+
+    // 回填中的一条错误：unknown 为未定义的符号（同一符号只报告一次），回填出错时为 kNoSymbol
+    struct ResolveError {
+        SymbolId unknown;
+        std::string message;
+        std::string context;
+    };
+    // 回填一个分片（ResolveSymbols 并行调用），错误记入 errors 而不直接输出
+    void ResolveShard(const UnsolvedSymbolMap& unsolved_symbol_map, const SymbolMap& symbol_map,
+                      size_t begin, size_t end, std::vector<ResolveError>& errors) const;
+
+    // 从捕获的异常中取出出错的源文本片段
+    void NoteErrorToken(const std::exception& e);
+
+    // 缓存命中时直接套用缓存的编码结果
+    bool ApplyCachedInstruction(const CacheEntry& entry,
+                                Instruction& instruction,
+                                UnsolvedSymbolMap& unsolved_symbol_map,
+                                SymbolMap& symbol_map,
+                                std::string* defined_label);
+    bool ApplyCachedData(const CacheEntry& entry, Data& data, SymbolMap& symbol_map,
+                         std::string* defined_label);
+    // 缓存中记录的 Label 登记到符号表，重复定义时报错并返回 false
+    bool DefineCachedLabel(const std::string& label, std::string_view assembly,
+                           SymbolMap& symbol_map, std::string* defined_label);
+
+    // 局部 Label：登记本行的定义并回填本行的局部引用（全局 Label 先关闭上一个作用域）
+    bool ResolveLocalLabels(LocalLabelScope<LocalRelocation>& scope, const std::string& label,
+                            const Instruction& instruction, UnsolvedSymbolMap& refs);
+    // 关闭作用域，仍在等待的局部引用报告为未定义的符号
+    void CloseLocalScope(LocalLabelScope<LocalRelocation>& scope);
 
     // 辅助函数
     // 提取标签并去除注释
-    std::string ExtractLabelAndStripComment(unsigned int address,
-                                            const std::string& assembly,
-                                            SymbolMap& symbol_map);
+    std::string_view ExtractLabelAndStripComment(unsigned int address,
+                                                 std::string_view assembly,
+                                                 SymbolMap& symbol_map,
+                                                 std::string* defined_label = nullptr);
     
     // 分发指令和数据处理
     void DispatchInstruction(const std::string& assembly, 
@@ -39,10 +129,4 @@ private:
                              UnsolvedSymbolMap& unsolved_symbol_map);
     
     void DispatchData(const std::string& assembly, Data& data);
-
-    // 工具函数
-    // 检查是否为分支指令
-    bool IsBranchOpcode(int op) const;
-    // 记录错误信息
-    void LogError(const std::string& msg, const std::string& context = "");
 };
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+ * 字符分类扫描模块
+ *
+ * 逐行路径上的分隔符查找（注释、Label 的冒号、操作数之间的逗号、offset(base) 的括号、空白）
+ * 原来由回溯正则完成。这里改为先把文本按字节分类为位图，再用位运算跳到下一个分隔符：
+ *   - ClassifyBlock()：一次最多 64 字节，第 i 位表示第 i 个字节属于 classes 中的某一类
+ *     x86 上每次比较 32 字节（AVX2，运行时检测）或 16 字节（SSE2），其他平台逐字节查表
+ *   - ScanFirst()/ScanFirstNot()：从 from 开始第一个属于/不属于 classes 的位置，没有时返回 s.size()
+ *   - ScanLastNot()：[from, to) 中最后一个不属于 classes 的字节之后的位置，没有时返回 from
+ *
+ * 空白与正则的 \s 一致（空格、\t、\n、\v、\f、\r）；kCharLineEnd 是正则中 . 不匹配的字符。
+ */
+enum CharClass : unsigned {
+    kCharSpace = 1u << 0,     // 空白
+    kCharHash = 1u << 1,      // #
+    kCharColon = 1u << 2,     // :
+    kCharComma = 1u << 3,     // ,
+    kCharParen = 1u << 4,     // ( )
+    kCharLineEnd = 1u << 5,   // \n \r
+};
+
+std::uint64_t ClassifyBlock(const char* p, size_t n, unsigned classes);
+size_t ScanFirst(std::string_view s, size_t from, unsigned classes);
+size_t ScanFirstNot(std::string_view s, size_t from, unsigned classes);
+size_t ScanLastNot(std::string_view s, size_t from, size_t to, unsigned classes);
+
+// 当前使用的实现："avx2"、"sse2" 或 "scalar"（--stats 输出）
+const char* ScannerName();
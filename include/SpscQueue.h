@@ -0,0 +1,99 @@
+#pragma once
+
+/*
+ * SpscQueue：有界的单生产者/单消费者队列（流水线模式的各线程之间传递批次）
+ *
+ * 环形缓冲区，head 只由消费者修改，tail 只由生产者修改，两者放在不同的缓存行；
+ * 队列不满/不空时 Push/Pop 不加锁。
+ * 队列满/空时先让出 CPU 重试有限次，仍不满足再在条件变量上阻塞，
+ * 等待的线程（例如编码较慢时的输出线程）因此不占用 CPU；
+ * 只有确实有线程在等待时，另一方才加锁唤醒它。
+ *   - Close()：生产者结束，消费者取完剩余元素后 Pop 返回 false
+ *   - Cancel()：消费者放弃（例如遇到致命错误），之后 Push 立即返回 false
+ */
+template <typename T>
+class SpscQueue {
+   public:
+    explicit SpscQueue(size_t capacity) : slots(capacity + 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    bool Push(T value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = Next(t);
+        Wait([&] {
+            return next != head.load(std::memory_order_acquire) ||
+                   cancelled.load(std::memory_order_relaxed);
+        });
+        if (cancelled.load(std::memory_order_relaxed)) return false;
+        slots[t] = std::move(value);
+        tail.store(next, std::memory_order_release);
+        Notify();
+        return true;
+    }
+
+    bool Pop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        // closed 在最后一次 Push 之后才设置，设置后队列中的元素仍要取完
+        Wait([&] {
+            return h != tail.load(std::memory_order_acquire) ||
+                   cancelled.load(std::memory_order_relaxed) ||
+                   closed.load(std::memory_order_acquire);
+        });
+        if (h == tail.load(std::memory_order_acquire)) return false;   // 已关闭（或放弃）且为空
+        value = std::move(slots[h]);
+        slots[h] = T();
+        head.store(Next(h), std::memory_order_release);
+        Notify();
+        return true;
+    }
+
+    void Close() {
+        closed.store(true, std::memory_order_release);
+        Notify();
+    }
+    void Cancel() {
+        cancelled.store(true, std::memory_order_relaxed);
+        Notify();
+    }
+    size_t Capacity() const { return slots.size() - 1; }
+
+   private:
+    static constexpr int kSpinRounds = 64;   // 阻塞前让出 CPU 重试的次数
+
+    std::vector<T> slots;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    std::atomic<bool> closed{false};
+    std::atomic<bool> cancelled{false};
+
+    // 阻塞等待用；waiters 为正在（或即将）阻塞的线程数
+    alignas(64) std::atomic<int> waiters{0};
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    size_t Next(size_t i) const { return i + 1 == slots.size() ? 0 : i + 1; }
+
+    template <typename Ready>
+    void Wait(Ready ready) {
+        for (int i = 0; i < kSpinRounds; i++) {
+            if (ready()) return;
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        // 与 Notify 中的栅栏配对：对方要么看到 waiters，要么本线程看到对方的修改
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        changed.wait(lock, ready);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // 修改 head/tail/closed/cancelled 之后调用
+    void Notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.notify_all();
+    }
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+/*
+ * 热点统计模块（mas --stats 开启）
+ *
+ * 记录一次汇编过程中：
+ *   - 每个调用点执行 std::regex 匹配的次数，以及临时构造（编译）正则的次数
+ *   - 全局 operator new 的调用次数与字节数
+ *   - Error.h 中每种异常被构造（抛出）的次数
+ *   - 各阶段耗时
+ * 最后按“每条语句”（指令或数据定义）折算输出，用于发现悄悄加进逐行路径的正则或字符串拷贝。
+ *
+ * 未开启时所有计数函数只做一次标志判断。
+ */
+
+// 使用正则的调用点
+// （去注释、段切换、Label、助记符与操作数的切分已改为字符分类扫描，见 Scan.h；
+//   指令格式判断改为查指令表，见 Isa.h）
+enum class RegexSite {
+    DispatchData,
+    I_FormatInstruction,           // I 格式内部的访存判断与 offset(base) 拆分
+    isPositive,
+    isDecimal,
+    isSymbol,
+    Count
+};
+
+// Error.h 中的异常类型
+enum class ExceptionKind {
+    ExceptNumberOrSymbol,
+    ExceptNumber,
+    ExceptPositive,
+    ExceptRegister,
+    OperandError,                  // 含 TooManyOperand
+    TooManyOperand,
+    UnknownInstruction,
+    NumberOverflow,
+    ExpressionError,
+    Count
+};
+
+// 计时的阶段
+enum class StatsPhase {
+    Read,          // 读入源文件并分段
+    DataSegment,   // 第一遍：数据段
+    TextSegment,   // 第一遍：代码段
+    Resolve,       // 第二遍：符号回填
+    Output,        // 生成 COE / details
+    OutputIo,      // 写出输出文件（见 AsyncOutput.h）
+    Count
+};
+
+void EnableStats();
+void EnableAllocationCounting();   // 只统计分配次数/字节数，不开启其余计数和 --stats 报告
+bool StatsEnabled();
+void ResetStats();
+
+void CountRegex(RegexSite site);
+void CountRegexCompile(RegexSite site);
+void CountException(ExceptionKind kind);
+void CountStatement(bool is_instruction);
+void CountCache(bool hit);         // 增量汇编缓存的命中/未命中
+void CountMemo(bool hit);          // 运行内编码记忆的命中/未命中
+
+// 开启统计（或只开启分配统计）后的累计分配次数/字节数（供 bench 使用）
+std::size_t StatsAllocationCount();
+std::size_t StatsAllocationBytes();
+
+/*
+ * ScopedPhaseTimer：在作用域内累计某个阶段的耗时
+ */
+class ScopedPhaseTimer {
+   public:
+    explicit ScopedPhaseTimer(StatsPhase phase);
+    ~ScopedPhaseTimer();
+
+   private:
+    StatsPhase phase;
+    long long start_ns;
+};
+
+void ReportStats(std::ostream& out);
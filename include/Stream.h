@@ -0,0 +1,19 @@
+#pragma once
+
+/*
+ * 流式汇编模块（mas --stream）
+ *
+ * 普通模式先把整个源文件读入 InstructionList/DataList，全部编码完成后才输出。
+ * 流式模式逐行读入、立即编码，把机器码直接写入输出镜像：
+ *   - 后向引用（符号已定义）立即回填
+ *   - 前向引用记为待回填项（字地址 + 指令地址），在 Label 出现时回填
+ *   - details.txt 的内容先写入临时文件，最后再结合镜像生成
+ * 因此峰值内存只与输出镜像、符号表和未解决的引用有关，与源文件大小无关。
+ *
+ * 参数与返回值同 doAssemble；cache 为增量汇编缓存（可为 nullptr）。
+ */
+int doAssembleStream(std::istream& in,
+                     const std::string& input_path,
+                     const std::string& output_dir,
+                     const AssembleOptions& options,
+                     AssemblyCache* cache = nullptr);
@@ -0,0 +1,90 @@
+#pragma once
+
+/*
+ * 符号驻留（interning）模块
+ *
+ * 符号名只在第一次出现时保存一份，之后用稠密的 32 位 id 表示：
+ *   - 名字存放在按块分配的字符区中，块不会搬移，Name() 返回的 string_view 始终有效
+ *   - 查找表是线性探测的开放寻址表，槽中只存 id；容量为 2 的幂，负载不超过 1/2，
+ *     每个 id 另存一份哈希值，探测时先比较哈希再比较名字，扩容时也不必重新计算哈希
+ * Label 定义和符号引用都只对名字哈希一次，之后符号表、待回填表与回填都按 id 访问数组。
+ * 字符区和各数组都从构造时给定的 memory_resource 分配（doAssemble 中为作业的 JobArena）。
+ */
+using SymbolId = std::uint32_t;
+constexpr SymbolId kNoSymbol = ~SymbolId(0);
+
+class SymbolInterner {
+public:
+    explicit SymbolInterner(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : blocks(resource), names(resource), hashes(resource), slots(resource) {}
+    ~SymbolInterner();
+    SymbolInterner(const SymbolInterner&) = delete;
+    SymbolInterner& operator=(const SymbolInterner&) = delete;
+
+    std::pmr::memory_resource* Resource() const { return blocks.get_allocator().resource(); }
+
+    // 返回 name 的 id，第一次出现时分配新 id（按出现顺序从 0 递增）
+    SymbolId Intern(std::string_view name);
+    // 只查找不分配，不存在时返回 kNoSymbol
+    SymbolId Find(std::string_view name) const;
+
+    std::string_view Name(SymbolId id) const { return names[id]; }
+    size_t Size() const { return names.size(); }
+
+    // 持有的堆内存字节数（--mem-report）
+    size_t MemoryBytes() const;
+
+private:
+    static constexpr size_t kBlockBytes = 16 * 1024;
+
+    struct Block {
+        char* data;
+        size_t size;
+    };
+    std::pmr::vector<Block> blocks;                // 名字字符区
+    char* NewBlock(size_t size);
+
+    char* block_cursor = nullptr;                  // 当前块中下一个空闲字节
+    size_t block_left = 0;                         // 当前块剩余的字节数
+    size_t block_bytes = 0;                        // 所有块的总字节数
+    std::pmr::vector<std::string_view> names;      // id -> 名字
+    std::pmr::vector<size_t> hashes;               // id -> 哈希值
+    std::pmr::vector<SymbolId> slots;              // 开放寻址表，kNoSymbol 为空槽
+
+    const char* Store(std::string_view name);
+    void Rehash(size_t capacity);
+};
+
+/*
+ * SymbolMap（已解决符号表）：符号 id -> 地址
+ *      名字由内部的 SymbolInterner 管理；未定义的符号也可以先有 id（被引用时驻留）
+ */
+class SymbolMap {
+public:
+    explicit SymbolMap(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : names(resource), addresses(resource) {}
+
+    SymbolInterner& Names() { return names; }
+    const SymbolInterner& Names() const { return names; }
+
+    // 定义符号；已经定义过时不修改并返回 false
+    bool Define(std::string_view name, unsigned address) { return Define(names.Intern(name), address); }
+    bool Define(SymbolId id, unsigned address);
+
+    bool IsDefined(SymbolId id) const { return id < addresses.size() && addresses[id] != kUndefined; }
+    unsigned Address(SymbolId id) const { return addresses[id]; }
+
+    // 按名字查找已定义符号的地址，未定义时返回 nullptr
+    const unsigned* Find(std::string_view name) const;
+
+    // 已定义的符号个数
+    size_t Size() const { return defined; }
+    size_t MemoryBytes() const;
+
+private:
+    static constexpr unsigned kUndefined = ~0u;
+
+    SymbolInterner names;
+    std::pmr::vector<unsigned> addresses;   // 按 id 下标，kUndefined 表示尚未定义
+    size_t defined = 0;
+};
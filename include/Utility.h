@@ -6,6 +6,7 @@
  * 包含多个与解析汇编字符串相关的重要函数：
  *
  *  - toUppercase            将字符串转为大写
+ *  - toCanonicalCase        代码段语句与 Label 的大写形式：区分大小写的 .L 前缀（局部 Label）记为 .l
  *  - isNumber               判断是否为合法数字（支持 0x 十六进制）
  *  - isPositive             判断是否为非负整数（包含十六进制表示）
  *  - isDecimal              判断是否为十进制整数
@@ -14,13 +15,20 @@
  *  - isSymbol               判断字符串是否为符号（标签）
  *  - isMemory               判断是否为 offset(base) 格式的内存操作
  * 这些函数在汇编指令解析和处理过程中确保输入的合法性和正确转换
+ *
+ *  - Diag / SetDiagStream   诊断信息（警告、提示）的输出通道（每个线程各自一个），默认 std::cerr；
+ *                           标准输出可能被用作汇编结果，编码过程中不得直接写 std::cout
  */
 
 std::string toUppercase(std::string str);
+std::string toCanonicalCase(std::string str);
 bool isNumber(const std::string& str);
 bool isPositive(const std::string& str);
 bool isDecimal(const std::string& str);
 int toNumber(const std::string& str, bool enable_hex = true);
 unsigned toUNumber(const std::string& str, bool enable_hex = true);
 bool isSymbol(const std::string& str);
-bool isMemory(const std::string& str);
\ No newline at end of file
+bool isMemory(const std::string& str);
+
+std::ostream& Diag();
+std::ostream* SetDiagStream(std::ostream* out);  // 返回原来的通道
@@ -0,0 +1,18 @@
+#pragma once
+
+/*
+ * 监视模式（mas --watch）
+ *
+ * 先汇编一次，然后等待输入文件变化，每次变化后重新汇编并覆盖输出：
+ *   - Linux 下使用 inotify 监视输入文件所在目录（兼容编辑器“写临时文件再改名”的保存方式），
+ *     其他平台或 inotify 不可用时每 200ms 检查一次修改时间和大小
+ *   - 各次汇编之间在内存中保留增量汇编缓存（见 Cache.h），未修改的行直接使用缓存的编码，
+ *     只有修改过的行会重新解析；地址与符号回填按缓存的长度重新计算
+ *   - 同时指定 --cache 时，启动时读入缓存文件，每次汇编后写回
+ *
+ * 源程序不支持包含其他文件，因此只监视输入文件本身。
+ * 该函数不会返回（Ctrl+C 结束），参数错误时返回非 0。
+ */
+int doWatch(const std::string& input_path,
+            const std::string& output_dir,
+            const AssembleOptions& options);
@@ -1,15 +1,64 @@
 #pragma once
 
+/*
+ * StdoutFormat：-o - 时写到标准输出的格式（只能选一种）
+ * None 表示按原方式在输出目录下写三个文件
+ */
+enum class StdoutFormat { None, Prgm, Dmem, Details };
+
+/*
+ * AssembleOptions：命令行选项中影响单次汇编过程的部分
+ */
+struct AssembleOptions {
+    bool mem_report = false;  // --mem-report：各阶段结束时输出各数据结构的内存估算
+    bool stream = false;      // --stream：流式汇编，内存占用只与输出镜像和未解决引用有关
+    bool pipeline = false;    // --pipeline：读入、编码、格式化输出分别在不同线程上流水进行
+    StdoutFormat stdout_format = StdoutFormat::None;  // -o -：结果写到标准输出
+    std::string cache_path;   // --cache：增量汇编缓存文件，为空表示不使用缓存
+    bool patch = false;       // --patch：生成与基准 COE 相比的增量补丁
+    std::string patch_base;   // --patch-base：基准 COE 所在目录，为空时与输出目录中上次的输出比较
+};
+
+/**
+ * 段状态枚举：标记当前扫描行属于哪个区域
+ * Global: 初始状态，不允许出现指令或数据
+ * Data:   数据段，存储变量、字符串等
+ * Text:   代码段，存储指令机器码
+ */
+enum class SegmentState { Global, Data, Text };
+
+/*
+ * 读入源文件时使用的两个预处理函数（doAssemble 与流式汇编共用）：
+ *  - KillComment：去除汇编行中的注释部分
+ *  - handleSegmentDirective：识别 .data/.text 段切换指令并更新 state，
+ *    带预留空间参数时向对应列表追加一条已完成（done）的零填充记录
+ */
+std::string_view KillComment(std::string_view assembly);
+bool handleSegmentDirective(std::string_view input,
+                            SegmentState& state,
+                            const std::string& path,
+                            int line,
+                            InstructionList& inst_list,
+                            DataList& data_list);
+
 /*
  *  doAssemble：汇编器主入口函数
  *
  * 参数：
- *  - input_file_path：输入的源汇编文件 (.s 或 .asm)
+ *  - input_file_path：输入的源汇编文件 (.s 或 .asm)，"-" 表示从标准输入读取
  *  - output_folder_path：输出文件路径，默认当前目录下
+ *  - options：其他选项
+ *  - cache：调用方持有的增量汇编缓存（监视模式下跨多次汇编保留）；
+ *           为 nullptr 时按 options.cache_path 自行读写缓存文件
+ *  - arena：调用方持有的作业内存区（监视模式、bench 跨多次汇编复用，开始时 Reset）；
+ *           为 nullptr 时使用本次调用内的临时内存区
  *
  * 返回值：
  *  - 0：成功
  *  - 非 0：失败
  */
 int doAssemble(const std::string &input_file_path,
-               const std::string &output_folder_path = "./");
\ No newline at end of file
+               const std::string &output_folder_path = "./",
+               const AssembleOptions &options = AssembleOptions(),
+               AssemblyCache *cache = nullptr,
+               JobArena *arena = nullptr);
\ No newline at end of file
@@ -0,0 +1,385 @@
+/*
+ * isagen：由指令集描述文件生成 include/IsaTables.h
+ *
+ * 用法：
+ *   isagen <spec.isa> <output.h>
+ *
+ * 生成内容（Isa.h 包含，类型定义见 Isa.h）：
+ *   - kOpcodeTable：每条指令的格式、语法、回填方式，以及预先拼好的固定字段 base 与掩码 mask，
+ *     编码时只需把操作数字段或进 base
+ *   - 助记符的完美哈希：MnemonicKey 把不超过 8 个字符的助记符打包成 64 位整数，
+ *     (key * multiplier) >> (64 - bits) 得到无冲突的槽位，查找只需一次乘法与一次比较
+ *   - 解码表：按 OP 索引，OP 相同的多条指令再按一个固定字段（Func / RT / RS）区分
+ *
+ * 描述文件有误（未知语法、重复助记符、操作数字段写了固定值、两条指令无法区分等）时
+ * 报告行号并返回非 0，不生成输出。
+ * 相同的输入一定得到完全相同的输出（哈希参数由固定种子搜索得到）。
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 与 Encoding.h 相同的字段位置
+struct FieldDesc {
+    const char* name;
+    unsigned shift;
+    unsigned width;
+};
+
+enum FieldId { kOp, kRs, kRt, kRd, kShamt, kFunc, kImmediate, kAddress, kFieldCount };
+
+static const FieldDesc kFields[kFieldCount] = {
+    {"OP", 26, 6},     {"RS", 21, 5},    {"RT", 16, 5},         {"RD", 11, 5},
+    {"Shamt", 6, 5},   {"Func", 0, 6},   {"Immediate", 0, 16},  {"Address", 0, 26},
+};
+
+static std::uint32_t FieldMask(FieldId id) {
+    return ((std::uint32_t(1) << kFields[id].width) - 1) << kFields[id].shift;
+}
+
+/*
+ * 语法：名称（与 Isa.h 的 Syntax 一致）、布局、由操作数给出的字段
+ */
+enum Layout { kLayoutR, kLayoutI, kLayoutJ, kLayoutNone };
+
+struct SyntaxDesc {
+    const char* name;
+    Layout layout;
+    std::vector<FieldId> operands;
+};
+
+static const SyntaxDesc kSyntaxes[] = {
+    {"RdRsRt", kLayoutR, {kRd, kRs, kRt}},
+    {"RdRtRs", kLayoutR, {kRd, kRt, kRs}},
+    {"RdRtShamt", kLayoutR, {kRd, kRt, kShamt}},
+    {"RsRt", kLayoutR, {kRs, kRt}},
+    {"RdRs", kLayoutR, {kRd, kRs}},
+    {"Rs", kLayoutR, {kRs}},
+    {"Rd", kLayoutR, {kRd}},
+    {"NoOperand", kLayoutR, {}},
+    {"RtRsImm", kLayoutI, {kRt, kRs, kImmediate}},
+    {"RsRtOffset", kLayoutI, {kRs, kRt, kImmediate}},
+    {"RtImm", kLayoutI, {kRt, kImmediate}},
+    {"RsOffset", kLayoutI, {kRs, kImmediate}},
+    {"RtMem", kLayoutI, {kRt, kImmediate, kRs}},
+    {"Target", kLayoutJ, {kAddress}},
+    {"Cop0", kLayoutR, {kRt, kRd, kFunc}},
+    {"Macro", kLayoutNone, {}},
+};
+
+static const std::map<std::string, std::string> kFormats = {
+    {"R", "Format::R"}, {"I", "Format::I"}, {"J", "Format::J"}, {"M", "Format::Macro"}};
+
+static const std::map<std::string, std::string> kFixups = {
+    {"-", "Fixup::None"},   {"shamt", "Fixup::Shamt"}, {"abs16", "Fixup::Abs16"},
+    {"rel16", "Fixup::Rel16"}, {"abs26", "Fixup::Abs26"}};
+
+struct Entry {
+    int line;
+    std::string mnemonic;
+    std::string format;
+    const SyntaxDesc* syntax;
+    std::string fixup;
+    unsigned op, rs, rt, func;
+    std::uint32_t base, mask;
+};
+
+static bool Fail(int line, const std::string& message) {
+    std::cerr << "isagen: line " << line << ": " << message << "\n";
+    return false;
+}
+
+// 字段值：- 表示 0（且表示未写固定值），支持 0b / 0x / 十进制
+static bool ParseValue(const std::string& text, unsigned width, unsigned& value, bool& given) {
+    given = text != "-";
+    if (!given) {
+        value = 0;
+        return true;
+    }
+    char* end = nullptr;
+    unsigned long v;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'b' || text[1] == 'B'))
+        v = std::strtoul(text.c_str() + 2, &end, 2);
+    else
+        v = std::strtoul(text.c_str(), &end, 0);
+    if (end == text.c_str() || *end != '\0' || v >= (1ul << width)) return false;
+    value = static_cast<unsigned>(v);
+    return true;
+}
+
+// 与 Isa.h 的 MnemonicKey 相同：大写后逐字节打包（低字节在前）
+static std::uint64_t MnemonicKey(const std::string& s) {
+    std::uint64_t key = 0;
+    for (size_t i = 0; i < s.size(); i++) key |= std::uint64_t(static_cast<unsigned char>(s[i])) << (8 * i);
+    return key;
+}
+
+static bool ReadSpec(const char* path, std::vector<Entry>& entries) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "isagen: cannot open " << path << "\n";
+        return false;
+    }
+
+    std::map<std::string, int> seen;
+    std::string text;
+    for (int line = 1; std::getline(in, text); line++) {
+        size_t hash = text.find('#');
+        if (hash != std::string::npos) text.erase(hash);
+        std::istringstream ss(text);
+        std::vector<std::string> cols;
+        for (std::string col; ss >> col;) cols.push_back(col);
+        if (cols.empty()) continue;
+        if (cols.size() != 8) return Fail(line, "expected 8 columns");
+
+        Entry e{};
+        e.line = line;
+        e.mnemonic = cols[0];
+        for (char c : e.mnemonic) {
+            if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '_'))
+                return Fail(line, "mnemonic must be upper case: " + e.mnemonic);
+        }
+        if (e.mnemonic.size() > 8) return Fail(line, "mnemonic longer than 8 characters");
+        if (seen.count(e.mnemonic)) {
+            return Fail(line, e.mnemonic + " already defined at line " +
+                                  std::to_string(seen[e.mnemonic]));
+        }
+        seen[e.mnemonic] = line;
+
+        if (!kFormats.count(cols[1])) return Fail(line, "unknown format " + cols[1]);
+        e.format = cols[1];
+        for (const SyntaxDesc& s : kSyntaxes) {
+            if (cols[2] == s.name) e.syntax = &s;
+        }
+        if (e.syntax == nullptr) return Fail(line, "unknown syntax " + cols[2]);
+        if ((e.format == "M") != (e.syntax->layout == kLayoutNone))
+            return Fail(line, "macro instructions must use the Macro syntax");
+        if (!kFixups.count(cols[7])) return Fail(line, "unknown fixup " + cols[7]);
+        e.fixup = cols[7];
+
+        // 固定字段：不能与操作数字段重叠；未写出的非操作数字段固定为 0
+        const FieldId ids[4] = {kOp, kRs, kRt, kFunc};
+        unsigned* values[4] = {&e.op, &e.rs, &e.rt, &e.func};
+        for (int i = 0; i < 4; i++) {
+            bool given = false;
+            if (!ParseValue(cols[3 + i], kFields[ids[i]].width, *values[i], given))
+                return Fail(line, std::string("bad ") + kFields[ids[i]].name + " value " + cols[3 + i]);
+            bool is_operand = false;
+            for (FieldId f : e.syntax->operands) is_operand |= (FieldMask(f) & FieldMask(ids[i])) != 0;
+            if (given && is_operand)
+                return Fail(line, std::string(kFields[ids[i]].name) + " is an operand of " + cols[2]);
+        }
+        if (e.syntax->layout == kLayoutNone) {
+            if (e.op || e.rs || e.rt || e.func || e.fixup != "-")
+                return Fail(line, "macro instructions have no fixed fields");
+        } else {
+            if (e.syntax->layout != kLayoutR && e.func)
+                return Fail(line, "Func is only valid in the R layout");
+            if (e.syntax->layout == kLayoutJ && (e.rs || e.rt))
+                return Fail(line, "RS/RT are not valid in the J layout");
+
+            std::uint32_t operand_mask = 0;
+            for (FieldId f : e.syntax->operands) operand_mask |= FieldMask(f);
+            e.mask = ~operand_mask;
+            e.base = (e.op << kFields[kOp].shift) | (e.rs << kFields[kRs].shift) |
+                     (e.rt << kFields[kRt].shift) | (e.func << kFields[kFunc].shift);
+        }
+        entries.push_back(e);
+    }
+    if (entries.empty()) return Fail(0, "no instructions");
+    if (entries.size() > 32767) return Fail(0, "too many instructions");
+    return true;
+}
+
+/*
+ * 完美哈希：固定种子的 splitmix64 依次产生奇数乘数，槽位数从最小的 2 的幂开始尝试
+ */
+struct PerfectHash {
+    std::uint64_t multiplier;
+    unsigned bits;
+    std::vector<int> slots;   // 槽位 -> 指令下标，-1 为空
+};
+
+static bool SearchHash(const std::vector<Entry>& entries, PerfectHash& hash) {
+    unsigned bits = 1;
+    while ((1u << bits) < entries.size()) bits++;
+
+    std::uint64_t state = 2024;
+    for (; bits <= 16; bits++) {
+        for (int attempt = 0; attempt < (1 << 22); attempt++) {
+            std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            std::uint64_t multiplier = (z ^ (z >> 31)) | 1;
+
+            std::vector<int> slots(size_t(1) << bits, -1);
+            bool ok = true;
+            for (size_t i = 0; i < entries.size() && ok; i++) {
+                size_t slot = (MnemonicKey(entries[i].mnemonic) * multiplier) >> (64 - bits);
+                ok = slots[slot] < 0;
+                slots[slot] = static_cast<int>(i);
+            }
+            if (ok) {
+                hash = PerfectHash{multiplier, bits, std::move(slots)};
+                return true;
+            }
+        }
+    }
+    return Fail(0, "no perfect hash found");
+}
+
+/*
+ * 解码表：OP 唯一的指令直接索引；OP 相同的一组指令，按在组内每条指令中都是固定字段、
+ * 且取值互不相同的第一个字段（Func、RT、RS 的顺序）区分
+ */
+struct DecodeGroup {
+    FieldId field;
+    std::vector<int> entry;
+};
+
+static bool BuildDecode(const std::vector<Entry>& entries, std::vector<int>& by_op,
+                        std::vector<DecodeGroup>& groups) {
+    std::map<unsigned, std::vector<int>> ops;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].syntax->layout != kLayoutNone) ops[entries[i].op].push_back(static_cast<int>(i));
+    }
+
+    by_op.assign(64, -1);
+    for (const auto& [op, members] : ops) {
+        if (members.size() == 1) {
+            by_op[op] = members[0];
+            continue;
+        }
+        bool found = false;
+        for (FieldId field : {kFunc, kRt, kRs}) {
+            std::vector<int> table(size_t(1) << kFields[field].width, -1);
+            bool ok = true;
+            for (int i : members) {
+                const Entry& e = entries[i];
+                if ((e.mask & FieldMask(field)) != FieldMask(field)) ok = false;
+                if (!ok) break;
+                unsigned value = (e.base & FieldMask(field)) >> kFields[field].shift;
+                if (table[value] >= 0) ok = false;
+                table[value] = i;
+            }
+            if (ok) {
+                by_op[op] = -2 - static_cast<int>(groups.size());
+                groups.push_back(DecodeGroup{field, std::move(table)});
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return Fail(entries[members[1]].line,
+                        entries[members[1]].mnemonic + " cannot be told apart from " +
+                            entries[members[0]].mnemonic);
+        }
+    }
+    return true;
+}
+
+static std::string Hex(std::uint64_t value, int digits) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "0x%0*llX", digits, static_cast<unsigned long long>(value));
+    return buf;
+}
+
+static void EmitIndexArray(std::ostream& out, const std::vector<int>& values) {
+    for (size_t i = 0; i < values.size(); i++) {
+        out << (i % 16 == 0 ? "\n    " : " ") << values[i] << ",";
+    }
+    out << "\n";
+}
+
+static void Emit(std::ostream& out, const char* spec, const std::vector<Entry>& entries,
+                 const PerfectHash& hash, const std::vector<int>& by_op,
+                 const std::vector<DecodeGroup>& groups) {
+    out << "#pragma once\n"
+        << "// 由 isa/isagen 从 " << spec << " 生成，请勿手工修改（make 会在描述文件变化后重新生成）\n"
+        << "// 由 Isa.h 包含，类型与查找函数见 Isa.h\n\n";
+
+    out << "inline constexpr OpcodeInfo kOpcodeTable[] = {\n";
+    for (const Entry& e : entries) {
+        out << "    {\"" << e.mnemonic << "\", " << kFormats.at(e.format) << ", Syntax::"
+            << e.syntax->name << ", " << kFixups.at(e.fixup) << ", " << Hex(e.op, 2) << ", "
+            << Hex(e.rs, 2) << ", " << Hex(e.rt, 2) << ", " << Hex(e.func, 2) << ", "
+            << Hex(e.base, 8) << ", " << Hex(e.mask, 8) << "},\n";
+    }
+    out << "};\n\n";
+
+    out << "// 助记符完美哈希：槽位 = (MnemonicKey(m) * kMnemonicHashMultiplier) >> (64 - kMnemonicHashBits)\n"
+        << "inline constexpr std::uint64_t kMnemonicHashMultiplier = " << Hex(hash.multiplier, 16)
+        << "ULL;\n"
+        << "inline constexpr unsigned kMnemonicHashBits = " << hash.bits << ";\n"
+        << "inline constexpr MnemonicSlot kMnemonicSlots[" << hash.slots.size() << "] = {\n";
+    for (int index : hash.slots) {
+        if (index < 0)
+            out << "    {0, -1},\n";
+        else
+            out << "    {" << Hex(MnemonicKey(entries[index].mnemonic), 16) << "ULL, " << index
+                << "},   // " << entries[index].mnemonic << "\n";
+    }
+    out << "};\n\n";
+
+    out << "// 解码表：按 OP 索引，>= 0 为 kOpcodeTable 下标，-1 为未定义，<= -2 为 kDecodeGroups[-2 - v]\n"
+        << "inline constexpr std::int16_t kDecodeByOp[64] = {";
+    EmitIndexArray(out, by_op);
+    out << "};\n\n"
+        << "inline constexpr DecodeGroup kDecodeGroups[] = {\n";
+    for (const DecodeGroup& g : groups) {
+        std::vector<int> entry = g.entry;
+        entry.resize(64, -1);
+        out << "    {" << kFields[g.field].shift << ", " << kFields[g.field].width << ",   // "
+            << kFields[g.field].name << "\n     {";
+        for (size_t i = 0; i < entry.size(); i++) {
+            out << (i % 16 == 0 ? (i ? "\n      " : "") : " ") << entry[i] << ",";
+        }
+        out << "}},\n";
+    }
+    if (groups.empty()) out << "    {0, 0, {}},\n";
+    out << "};\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage:\n"
+                  << "  isagen <spec.isa> <output.h>\n";
+        return 1;
+    }
+
+    std::vector<Entry> entries;
+    PerfectHash hash;
+    std::vector<int> by_op;
+    std::vector<DecodeGroup> groups;
+    if (!ReadSpec(argv[1], entries) || !SearchHash(entries, hash) ||
+        !BuildDecode(entries, by_op, groups)) {
+        return 1;
+    }
+
+    // 先写临时文件再改名，生成失败时不留下半个头文件
+    std::string tmp = std::string(argv[2]) + ".tmp";
+    {
+        std::ofstream out(tmp);
+        if (!out) {
+            std::cerr << "isagen: cannot write " << tmp << "\n";
+            return 1;
+        }
+        Emit(out, argv[1], entries, hash, by_op, groups);
+    }
+    // std::rename 在 Windows 上不能覆盖已存在的文件，filesystem::rename 可以
+    std::error_code ec;
+    std::filesystem::rename(tmp, argv[2], ec);
+    if (ec) {
+        std::cerr << "isagen: cannot write " << argv[2] << ": " << ec.message() << "\n";
+        std::filesystem::remove(tmp, ec);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "Headers.h"
+
+JobArena::~JobArena() {
+    for (const auto& chunk : chunks) ::operator delete(chunk.data);
+}
+
+void* JobArena::do_allocate(size_t bytes, size_t alignment) {
+    while (current < chunks.size()) {
+        Chunk& chunk = chunks[current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+        size_t aligned = ((base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+        if (aligned + bytes <= chunk.size) {
+            offset = aligned + bytes;
+            return chunk.data + aligned;
+        }
+        // 当前块放不下：转到下一块（Reset 之后只有一块，这里只在作业变大时发生）
+        used_before += offset;
+        offset = 0;
+        current++;
+    }
+
+    size_t size = std::max(next_chunk_bytes, bytes + alignment);
+    chunks.push_back(Chunk{static_cast<char*>(::operator new(size)), size});
+    next_chunk_bytes = size * 2;
+    current = chunks.size() - 1;
+    return do_allocate(bytes, alignment);
+}
+
+void JobArena::Reset() {
+    if (chunks.size() > 1) {
+        size_t total = BytesReserved();
+        for (const auto& chunk : chunks) ::operator delete(chunk.data);
+        chunks.assign(1, Chunk{static_cast<char*>(::operator new(total)), total});
+        next_chunk_bytes = total * 2;
+    }
+    current = 0;
+    offset = 0;
+    used_before = 0;
+}
+
+size_t JobArena::BytesReserved() const {
+    size_t total = 0;
+    for (const auto& chunk : chunks) total += chunk.size;
+    return total;
+}
@@ -0,0 +1,316 @@
+#include <atomic>
+#include <filesystem>
+
+#include "Headers.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+// 需要 IORING_OP_READ/WRITE（5.6）；以 5.7 加入的 IORING_FEAT_FAST_POLL 判断内核是否足够新
+#if defined(IORING_FEAT_FAST_POLL) && defined(__NR_io_uring_setup)
+#define MAS_IO_URING 1
+#endif
+#endif
+#endif
+
+static std::atomic<const char*> g_backend{"none"};
+
+const char* OutputBackendName() { return g_backend.load(); }
+
+void AsyncOutputWriter::Add(std::string path, std::string content, bool binary) {
+    files.push_back(File{std::move(path), std::move(content), binary, {}});
+}
+
+void AsyncOutputWriter::AddStream(std::string path, std::function<void(std::ostream&)> write,
+                                  bool binary) {
+    files.push_back(File{std::move(path), std::string(), binary, std::move(write)});
+}
+
+std::vector<bool> AsyncOutputWriter::Flush() {
+    ScopedPhaseTimer timer(StatsPhase::OutputIo);
+    std::vector<char> written(files.size(), 0);   // vector<bool> 的元素不能由多个线程同时写
+
+    // 逐段写出的文件各用一个线程，与内存中的文件同时写出
+    std::vector<std::thread> streams;
+    for (size_t k = 0; k < files.size(); k++) {
+        if (!files[k].write) continue;
+        streams.emplace_back([this, &written, k] {
+            written[k] = WriteStreamIfChanged(files[k].path, files[k].write, files[k].binary);
+        });
+    }
+
+    if (allow_io_uring && FlushIoUring(written)) {
+        g_backend = "io_uring";
+    } else {
+        FlushThreads(written);
+        g_backend = "threads";
+    }
+    for (auto& stream : streams) stream.join();
+    files.clear();
+    return std::vector<bool>(written.begin(), written.end());
+}
+
+bool FlushOutputs(AsyncOutputWriter& writer) {
+    const std::vector<bool> written = writer.Flush();
+    if (!written[0]) std::cerr << "IO Error: Could not write to prgmip32.coe" << std::endl;
+    if (!written[1]) std::cerr << "IO Error: Could not write to dmem32.coe" << std::endl;
+    return written[0] && written[1];
+}
+
+/*
+ * 每个文件一个线程（第一个文件在当前线程上写）
+ */
+void AsyncOutputWriter::FlushThreads(std::vector<char>& written) {
+    auto run = [&](size_t k) {
+        written[k] = WriteFileIfChanged(files[k].path, files[k].content, files[k].binary);
+    };
+    std::vector<size_t> pending;
+    for (size_t k = 0; k < files.size(); k++) {
+        if (!files[k].write) pending.push_back(k);
+    }
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < pending.size(); i++) workers.emplace_back(run, pending[i]);
+    if (!pending.empty()) run(pending[0]);
+    for (auto& worker : workers) worker.join();
+}
+
+#ifndef MAS_IO_URING
+
+bool AsyncOutputWriter::FlushIoUring(std::vector<char>&) { return false; }
+
+#else
+
+namespace {
+
+/*
+ * 一次读或写：从文件偏移 0 开始传输 length 字节，短读写时继续提交剩余部分
+ *   读到文件末尾时提前结束（done < length），出错时 error 为 errno
+ */
+struct IoRequest {
+    int fd;
+    char* buffer;
+    size_t length;
+    bool write;
+    size_t done = 0;
+    int error = 0;
+};
+
+/*
+ * IoUring：最小的 io_uring 封装，只做一批读写的提交与收割
+ */
+class IoUring {
+   public:
+    IoUring() = default;
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) munmap(cq_ring, cq_ring_size);
+        if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_size);
+        if (ring_fd >= 0) close(ring_fd);
+    }
+
+    // 创建队列，内核不支持（或被禁用）时返回 false
+    bool Init(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd < 0 || !(params.features & IORING_FEAT_FAST_POLL)) return false;
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+        sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd, IORING_OFF_SQ_RING);
+        if (sq_ring == MAP_FAILED) return false;
+        cq_ring = single_mmap ? sq_ring
+                              : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) return false;
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                    IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+
+        char* sq = static_cast<char*>(sq_ring);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_entries = params.sq_entries;
+
+        char* cq = static_cast<char*>(cq_ring);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // 提交 requests 中的全部读写并等待完成；io_uring_enter 本身失败时返回 false
+    bool Run(std::vector<IoRequest>& requests) {
+        std::vector<size_t> queue;   // 等待提交（或需要继续传输）的请求
+        for (size_t i = requests.size(); i-- > 0;) {
+            if (requests[i].length > 0) queue.push_back(i);
+        }
+
+        unsigned queued = 0;     // 已放入提交队列、内核尚未取走的条目数
+        size_t in_flight = 0;    // 内核已取走、尚未完成的条目数（不超过 sq_entries，完成队列不会溢出）
+        while (!queue.empty() || queued > 0 || in_flight > 0) {
+            unsigned tail = *sq_tail;
+            while (!queue.empty() && in_flight + queued < sq_entries) {
+                const size_t i = queue.back();
+                queue.pop_back();
+                const IoRequest& request = requests[i];
+
+                io_uring_sqe& sqe = static_cast<io_uring_sqe*>(sqes)[tail & sq_mask];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = request.write ? IORING_OP_WRITE : IORING_OP_READ;
+                sqe.fd = request.fd;
+                sqe.addr = reinterpret_cast<__u64>(request.buffer + request.done);
+                sqe.len = static_cast<__u32>(std::min<size_t>(request.length - request.done, 1u << 30));
+                sqe.off = request.done;
+                sqe.user_data = i;
+                sq_array[tail & sq_mask] = tail & sq_mask;
+                tail++;
+                queued++;
+            }
+            __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+            long submitted = syscall(__NR_io_uring_enter, ring_fd, queued, 1,
+                                     IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (submitted < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+                return false;
+            }
+            queued -= static_cast<unsigned>(submitted);
+            in_flight += static_cast<size_t>(submitted);
+
+            // 收割完成事件：未传输完的请求放回队列
+            unsigned head = *cq_head;
+            const unsigned completed = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != completed; head++) {
+                const io_uring_cqe& cqe = cqes[head & cq_mask];
+                IoRequest& request = requests[cqe.user_data];
+                in_flight--;
+                if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                    queue.push_back(cqe.user_data);
+                } else if (cqe.res < 0) {
+                    request.error = -cqe.res;
+                } else if (cqe.res == 0) {
+                    if (request.write) request.error = EIO;   // 读到文件末尾时直接结束
+                } else {
+                    request.done += static_cast<size_t>(cqe.res);
+                    if (request.done < request.length) queue.push_back(cqe.user_data);
+                }
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+        return true;
+    }
+
+   private:
+    int ring_fd = -1;
+    void* sq_ring = MAP_FAILED;
+    void* cq_ring = MAP_FAILED;
+    void* sqes = MAP_FAILED;
+    size_t sq_ring_size = 0, cq_ring_size = 0, sqes_size = 0;
+
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned sq_mask = 0, sq_entries = 0;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+};
+
+}  // namespace
+
+/*
+ * io_uring：一、读取大小相同的已有文件并比较；二、内容变化的文件写入 path.tmp；三、依次改名
+ * （Linux 上文本方式与二进制方式相同，binary 不影响写出的内容）
+ * 队列无法创建或 io_uring_enter 失败时返回 false，此时还没有改写任何输出文件，由调用方改用线程写出
+ */
+bool AsyncOutputWriter::FlushIoUring(std::vector<char>& written) {
+    IoUring ring;
+    if (!ring.Init(8)) return false;
+
+    const size_t n = files.size();
+
+    // 一、比较已有文件（大小不同时不必读取）
+    std::vector<bool> changed(n, true);
+    std::vector<std::string> existing(n);
+    std::vector<IoRequest> reads;
+    std::vector<size_t> read_files;
+    for (size_t k = 0; k < n; k++) {
+        if (files[k].write) {
+            changed[k] = false;   // 由 Flush 中的线程写出
+            continue;
+        }
+        int fd = open(files[k].path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+            static_cast<size_t>(st.st_size) != files[k].content.size()) {
+            close(fd);
+            continue;
+        }
+        existing[k].resize(files[k].content.size());
+        reads.push_back(IoRequest{fd, existing[k].data(), existing[k].size(), false});
+        read_files.push_back(k);
+    }
+    const bool read_ok = ring.Run(reads);
+    for (size_t r = 0; r < reads.size(); r++) {
+        close(reads[r].fd);
+        const size_t k = read_files[r];
+        if (read_ok && reads[r].error == 0 && reads[r].done == reads[r].length &&
+            existing[k] == files[k].content) {
+            changed[k] = false;
+            written[k] = true;
+        }
+    }
+    if (!read_ok) return false;
+
+    // 二、写入临时文件
+    std::vector<IoRequest> writes;
+    std::vector<size_t> write_files;
+    for (size_t k = 0; k < n; k++) {
+        if (!changed[k]) continue;
+        std::string tmp_path = files[k].path + ".tmp";
+        int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (fd < 0) continue;
+        writes.push_back(IoRequest{fd, files[k].content.data(), files[k].content.size(), true});
+        write_files.push_back(k);
+    }
+    const bool write_ok = ring.Run(writes);
+
+    // 三、全部完成后改名覆盖
+    for (size_t w = 0; w < writes.size(); w++) {
+        const size_t k = write_files[w];
+        const std::string tmp_path = files[k].path + ".tmp";
+        bool ok = write_ok && writes[w].error == 0 && writes[w].done == writes[w].length;
+        if (close(writes[w].fd) != 0) ok = false;
+        if (!ok) {
+            std::remove(tmp_path.c_str());
+            continue;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, files[k].path, ec);
+        if (ec) {
+            std::remove(tmp_path.c_str());
+            continue;
+        }
+        written[k] = true;
+    }
+    return write_ok;
+}
+
+#endif
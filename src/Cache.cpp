@@ -0,0 +1,194 @@
+#include <sstream>
+
+#include "Headers.h"
+
+// 缓存格式或任何编码逻辑变化时需要修改
+const char* const kCacheVersion = "mas-cache-3";
+
+static const char kCacheMagic[4] = {'M', 'A', 'S', 'C'};
+
+/*
+ * 二进制读写辅助函数：整数按小端序，字符串与数组先写长度
+ * 读取时长度不能超过 limit（文件大小）：损坏的长度字段不会导致按其分配内存
+ */
+static void WriteU32(std::ostream& out, std::uint32_t v) {
+    char buf[4] = {char(v), char(v >> 8), char(v >> 16), char(v >> 24)};
+    out.write(buf, 4);
+}
+
+static void WriteString(std::ostream& out, const std::string& s) {
+    WriteU32(out, s.size());
+    out.write(s.data(), s.size());
+}
+
+static bool ReadU32(std::istream& in, std::uint32_t& v) {
+    unsigned char buf[4];
+    if (!in.read(reinterpret_cast<char*>(buf), 4)) return false;
+    v = buf[0] | (buf[1] << 8) | (buf[2] << 16) | (std::uint32_t(buf[3]) << 24);
+    return true;
+}
+
+// 读取数组长度，每个元素至少占 unit 字节
+static bool ReadCount(std::istream& in, std::uint32_t& count, std::uint64_t unit, std::uint64_t limit) {
+    return ReadU32(in, count) && count * unit <= limit;
+}
+
+static bool ReadString(std::istream& in, std::string& s, std::uint64_t limit) {
+    std::uint32_t size;
+    if (!ReadCount(in, size, 1, limit)) return false;
+    s.resize(size);
+    return size == 0 || static_cast<bool>(in.read(&s[0], size));
+}
+
+// FNV-1a 64：从 hash 开始继续混入 bytes
+static const std::uint64_t kFnvOffset = 14695981039346656037ULL;
+static std::uint64_t Fnv1a(std::uint64_t hash, std::string_view bytes) {
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::uint64_t AssemblyCache::Key(Kind kind, std::string_view text) {
+    const char k = static_cast<char>(kind);
+    return Fnv1a(Fnv1a(kFnvOffset, std::string_view(&k, 1)), text);
+}
+
+CacheEntry* AssemblyCache::Find(Kind kind, std::string_view text) {
+    auto it = entries.find(Key(kind, text));
+    if (it == entries.end() || it->second.text != text) return nullptr;
+    it->second.used = true;
+    return &it->second;
+}
+
+void AssemblyCache::Store(Kind kind, CacheEntry entry) {
+    entry.used = true;
+    std::uint64_t key = Key(kind, entry.text);
+    entries[key] = std::move(entry);
+}
+
+void AssemblyCache::Prune() {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (!it->second.used) {
+            it = entries.erase(it);
+        } else {
+            it->second.used = false;
+            ++it;
+        }
+    }
+}
+
+/*
+ * 文件格式：
+ *   "MASC" 版本字符串 条目数
+ *   每个条目：key(2×u32) text label 机器码数 机器码... 数据字节串
+ *             引用数 (下标 符号 addend 取的部分)... 警告文本
+ *   校验和：之前所有字节的 FNV-1a 64（2×u32）
+ * 文件不完整或损坏（校验和不符、长度字段超出文件大小）时放弃整个文件，从空缓存开始
+ */
+void AssemblyCache::Load(const std::string& path) {
+    entries.clear();
+    std::string content;
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return;
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        content = buffer.str();
+    }
+    if (content.size() < 8) return;
+    const std::uint64_t limit = content.size() - 8;
+    std::uint32_t sum_lo, sum_hi;
+    std::istringstream trailer(content.substr(limit));
+    if (!ReadU32(trailer, sum_lo) || !ReadU32(trailer, sum_hi)) return;
+    if (Fnv1a(kFnvOffset, std::string_view(content).substr(0, limit)) !=
+        ((std::uint64_t(sum_hi) << 32) | sum_lo))
+        return;
+    content.resize(limit);
+    std::istringstream in(std::move(content));
+
+    // 各部分至少占用的字节数
+    const std::uint64_t kEntryBytes = 8 + 4 * 6, kRelocationBytes = 4 * 4;
+
+    char magic[4];
+    std::string version;
+    std::uint32_t count;
+    if (!in.read(magic, 4) || std::memcmp(magic, kCacheMagic, 4) != 0) return;
+    if (!ReadString(in, version, limit) || version != kCacheVersion) return;
+    if (!ReadCount(in, count, kEntryBytes, limit)) return;
+
+    std::unordered_map<std::uint64_t, CacheEntry> loaded;
+    loaded.reserve(count);
+    for (std::uint32_t i = 0; i < count; i++) {
+        std::uint32_t key_lo, key_hi, words, relocations;
+        std::string raw_data;
+        CacheEntry entry;
+
+        if (!ReadU32(in, key_lo) || !ReadU32(in, key_hi)) return;
+        if (!ReadString(in, entry.text, limit) || !ReadString(in, entry.label, limit)) return;
+
+        if (!ReadCount(in, words, 4, limit)) return;
+        entry.machine_code.resize(words);
+        for (auto& word : entry.machine_code) {
+            if (!ReadU32(in, word)) return;
+        }
+
+        if (!ReadString(in, raw_data, limit)) return;
+        entry.raw_data.assign(raw_data.begin(), raw_data.end());
+
+        if (!ReadCount(in, relocations, kRelocationBytes, limit)) return;
+        entry.relocations.resize(relocations);
+        for (auto& [index, symbol, addend] : entry.relocations) {
+            std::uint32_t value, part;
+            if (!ReadU32(in, index) || !ReadString(in, symbol, limit)) return;
+            if (!ReadU32(in, value) || !ReadU32(in, part)) return;
+            if (index >= words || part > static_cast<std::uint32_t>(AddressPart::Lo)) return;  // 损坏的条目
+            addend = Addend{static_cast<int>(value), static_cast<AddressPart>(part)};
+        }
+
+        if (!ReadString(in, entry.diagnostics, limit)) return;
+        loaded[(std::uint64_t(key_hi) << 32) | key_lo] = std::move(entry);
+    }
+    entries = std::move(loaded);
+}
+
+bool AssemblyCache::Save(const std::string& path) const {
+    std::ostringstream out;
+
+    std::uint32_t count = 0;
+    for (const auto& [key, entry] : entries) {
+        (void)key;
+        if (entry.used) count++;
+    }
+
+    out.write(kCacheMagic, 4);
+    WriteString(out, kCacheVersion);
+    WriteU32(out, count);
+
+    for (const auto& [key, entry] : entries) {
+        if (!entry.used) continue;
+        WriteU32(out, static_cast<std::uint32_t>(key));
+        WriteU32(out, static_cast<std::uint32_t>(key >> 32));
+        WriteString(out, entry.text);
+        WriteString(out, entry.label);
+        WriteU32(out, entry.machine_code.size());
+        for (auto word : entry.machine_code) WriteU32(out, word);
+        WriteString(out, std::string(entry.raw_data.begin(), entry.raw_data.end()));
+        WriteU32(out, entry.relocations.size());
+        for (const auto& [index, symbol, addend] : entry.relocations) {
+            WriteU32(out, index);
+            WriteString(out, symbol);
+            WriteU32(out, static_cast<std::uint32_t>(addend.value));
+            WriteU32(out, static_cast<std::uint32_t>(addend.part));
+        }
+        WriteString(out, entry.diagnostics);
+    }
+
+    const std::uint64_t checksum = Fnv1a(kFnvOffset, out.str());
+    WriteU32(out, static_cast<std::uint32_t>(checksum));
+    WriteU32(out, static_cast<std::uint32_t>(checksum >> 32));
+
+    // 先写临时文件再改名，中断时不会留下损坏的缓存
+    return WriteFileIfChanged(path, out.str(), true);
+}
@@ -0,0 +1,9 @@
+/*
+ * ConstexprAssembler.h 是给仿真器、测试平台单独使用的 header-only 头文件，
+ * 这里有意不包含 Headers.h：只包含它本身，确保它（以及 Isa.h、Encoding.h）不依赖项目中的其他头文件。
+ * 头文件末尾的 static_assert 在编译本文件时求值。
+ */
+#include "ConstexprAssembler.h"
+
+// 与 mas 的编码一致：MiniSys-1A 的 I/O 端口访问（offset 0xFC60 符号扩展为 0xFFFFFC60）
+static_assert(mas::assemble<1>("sw $t0, 0xFC60($zero)")[0] == 0xAC08FC60, "I/O port offset");
@@ -1,21 +1,5 @@
 #include "Headers.h"
 
-/*
- * I 格式指令识别用的正则表达式：
- *
- * 包含以下种类：
- *   - 加减立即数：addi/addiu
- *   - 按位：andi / ori / xori
- *   - 加载立即数：lui
- *   - 加载存储：lb lh lw lbu lhu sb sh sw
- *   - 分支：beq bne bltz bgez bltzal bgezal bgtz blez
- *   - Coprocessor0：mfc0 mtc0
- */
-std::regex I_format_regex(
-    "^(addiu?|andi|x?ori|lui|l[bhw]u?|s[bhw]|beq|bne|sltiu?|m[ft]c0|b[gl][et]z|"
-    "bgezal|bltzal)",
-    std::regex::icase);
-
 /*
  * I_FormatInstruction
  *
@@ -30,7 +14,17 @@ std::regex I_format_regex(
  *   2. load/store 形式（LW rt, offset(rs)）
  *   3. 普通三操作数 I 指令（ADDI/ORI/ANDI/...）
  *   4. 特殊二操作数指令（LUI、分支跳转组）
+ *
+ * 语法取自 Isa.h 的指令表，立即数的扩展方式由 OP 决定（ImmediateExtend）。
+ * 每类先依次分类并检查各操作数（寄存器、立即数范围），最后把操作数字段或进表中拼好的
+ * 固定字段（info->base，含 OP、COP0 的 RS、REGIMM 分支的 RT）一次写入；
+ * 立即数可以是表达式（见 Expression.h），含符号的立即数先写 0，
+ * 连同 addend 加入未解决符号表等第二遍回填。
  */
+static unsigned ImmediateOrReference(const OpcodeInfo& info, const Operand& operand,
+                                     const std::string& op,
+                                     UnsolvedSymbolMap& unsolved_symbol_map, SymbolRef ref);
+
 MachineCode I_FormatInstruction(const std::string& mnemonic,
                                 const std::string& assembly,
                                 UnsolvedSymbolMap& unsolved_symbol_map,
@@ -44,12 +38,12 @@ MachineCode I_FormatInstruction(const std::string& mnemonic,
     std::string op1, op2, op3;
     GetOperand(assembly, op1, op2, op3);
 
-    // 检测是否为内存读写格式，如 lw rt, offset(rs)
-    bool is_mem = std::regex_match(mnemonic, std::regex("^L[BHW]U?|S[BHW]$"));
+    const OpcodeInfo* info = FindOpcode(mnemonic);
+    if (info == nullptr) goto err;
 
     
     // COP0 指令（MFC0 / MTC0）
-    if (mnemonic == "MFC0" || mnemonic == "MTC0") {
+    if (info->syntax == Syntax::Cop0) {
         /*
          * COP0 其实属于 R 格式，但为了方便，把它当成 I 格式统一处理。
          *
@@ -59,32 +53,29 @@ MachineCode I_FormatInstruction(const std::string& mnemonic,
          */
         if (op3.empty()) {
             op3 = "0";
-            std::cout<< "Unset sel field, set it to 0.";
+            Diag() << "Unset sel field, set it to 0.";
         }
 
-        unsigned sel = toUNumber(op3);
-        if (sel > 7) throw NumberOverflow("Sel", "7", std::to_string(sel));
-
-        SetOP(machine_code, 0b010000);                      // COP0
-        SetRS(machine_code, mnemonic == "MFC0" ? 0 : 0b00100); // MTC0 使用 RS = 4
-        SetRT(machine_code, Register(op1));
-        SetRD(machine_code, Register(op2));
-        SetShamt(machine_code, 0);
-        SetFunc(machine_code, sel);
+        unsigned sel = CheckUnsigned(toUNumber(op3), 3, "Sel");
+        unsigned rt = Register(op1);
+        unsigned rd = Register(op2);
 
+        // OP = COP0，MTC0 使用 RS = 4（均在 base 中）
+        machine_code = info->base | EncodeR(0, 0, rt, rd, 0, sel);
     }
 
     
     // 二、 内存访问指令（LW/SW/LH/...）
     // 格式： op rt, offset(rs)
     
-    else if (is_mem) {
+    else if (info->syntax == Syntax::RtMem) {
 
         static std::regex re(
             "\\s*\\S+\\s*(\\S+)\\s*,\\s*(\\S+)\\s*\\(\\s*(\\S+)\\)",
             std::regex::icase);
 
         std::smatch match;
+        CountRegex(RegexSite::I_FormatInstruction);
         std::regex_match(assembly, match, re);
 
         if (!match.empty()) {
@@ -95,37 +86,17 @@ MachineCode I_FormatInstruction(const std::string& mnemonic,
             std::string op1 = match[1].str(), offset = match[2].str(),
                         op2 = match[3].str();
 
-            // offset 可以是数字或符号
-            if (isNumber(offset) || isSymbol(offset)) {
-
-                // 根据不同的 load/store 设置 OP
-                if (mnemonic == "LW")      SetOP(machine_code, 0b100011);
-                else if (mnemonic == "LH") SetOP(machine_code, 0b100001);
-                else if (mnemonic == "LHU")SetOP(machine_code, 0b100101);
-                else if (mnemonic == "LB") SetOP(machine_code, 0b100000);
-                else if (mnemonic == "LBU")SetOP(machine_code, 0b100100);
-                else if (mnemonic == "SW") SetOP(machine_code, 0b101011);
-                else if (mnemonic == "SH") SetOP(machine_code, 0b101001);
-                else if (mnemonic == "SB") SetOP(machine_code, 0b101000);
-                else goto err;
-
-                // rs = 基址寄存器
-                SetRS(machine_code, Register(op2));
-                // rt = 目标寄存器
-                SetRT(machine_code, Register(op1));
-
-                // offset 立即数
-                if (isNumber(offset)) {
-                    SetImmediate(machine_code, toNumber(offset));
-                } else {
-                    // 符号，先用 0 占位，加入未解决符号表
-                    SetImmediate(machine_code, 0);
-                    unsolved_symbol_map[offset].push_back(
-                        SymbolRef{machine_code_it, cur_instruction});
-                }
-            } else {
-                throw ExceptNumberOrSymbol(offset);
-            }
+            // offset 可以是数字、符号或表达式（不是时抛出 ExceptNumberOrSymbol）
+            Operand operand = ParseOperand(offset);
+
+            unsigned rs = Register(op2);   // 基址寄存器
+            unsigned rt = Register(op1);   // 目标寄存器
+
+            // offset 立即数（访存 OP 为符号扩展）；符号先用 0 占位，加入未解决符号表
+            unsigned immediate = ImmediateOrReference(*info, operand, offset, unsolved_symbol_map,
+                SymbolRef{machine_code_it, cur_instruction});
+
+            machine_code = info->base | EncodeI(0, rs, rt, immediate);
 
         } else {
             if (isI_Format(assembly)) throw OperandError(mnemonic);
@@ -140,86 +111,39 @@ MachineCode I_FormatInstruction(const std::string& mnemonic,
     else {
         if (!op1.empty() && !op2.empty() && !op3.empty()) {
 
-            std::unordered_map<std::string, int> op{
-                {"ADDI", 0b001000}, {"ADDIU", 0b001001},
-                {"ANDI", 0b001100}, {"ORI", 0b001101},
-                {"XORI", 0b001110}, {"BEQ", 0b000100},
-                {"BNE", 0b000101},  {"SLTI", 0b001010},
-                {"SLTIU", 0b001011}
-            };
-
-            auto it = op.find(mnemonic);
-            if (it != op.end()) {
+            if (info->syntax == Syntax::RtRsImm || info->syntax == Syntax::RsRtOffset) {
 
                 // BEQ/BNE 操作数顺序不同，需要交换
-                if (mnemonic == "BEQ" || mnemonic == "BNE") {
+                if (info->syntax == Syntax::RsRtOffset) {
                     std::swap(op1, op2);
                 }
 
-                SetOP(machine_code, it->second);
-                SetRS(machine_code, Register(op2));
-                SetRT(machine_code, Register(op1));
-
-                // imm 可能是数字或符号
-                if (isNumber(op3)) {
-                    SetImmediate(machine_code, toNumber(op3));
-
-                    if (mnemonic.front() == 'B') {
-                        std::cout<<("Immediate value in branch instruction.\n");
-                    }
-
-                // 如果是符号，需要加入未解决符号表
-                } else if (isSymbol(op3)) {
-                    SetImmediate(machine_code, 0);
-                    unsolved_symbol_map[op3].push_back(
-                        SymbolRef{machine_code_it, cur_instruction});
-                } else {
-                    throw ExceptNumberOrSymbol(op3);
-                }
-            }
+                unsigned rs = Register(op2);
+                unsigned rt = Register(op1);
+
+                // imm 可能是数字、符号或表达式；含符号时加入未解决符号表
+                unsigned immediate = ImmediateOrReference(*info, ParseOperand(op3), op3,
+                    unsolved_symbol_map, SymbolRef{machine_code_it, cur_instruction});
+
+                machine_code = info->base | EncodeI(0, rs, rt, immediate);
+            } else goto err;
         }
 
         // 二操作数 I 指令：LUI、BGEZ、BLTZ、BGEZAL、BLTZAL
         else if (!op1.empty() && !op2.empty() && op3.empty()) {
 
-            std::unordered_map<std::string, int> op{
-                {"LUI", 0b001111}, {"BGEZ", 0b000001},
-                {"BGTZ",0b000111}, {"BLEZ", 0b000110},
-                {"BLTZ",0b000001}, {"BGEZAL",0b000001},
-                {"BLTZAL",0b000001}
-            };
-
-            std::unordered_map<std::string, int> rt{
-                {"BGEZ", 1}, {"BGTZ", 0},
-                {"BLEZ", 0}, {"BLTZ", 0},
-                {"BGEZAL",0b10001}, {"BLTZAL",0b10000}
-            };
-
-            SetOP(machine_code, op.at(mnemonic));
-
-            if (mnemonic == "LUI") {
-                SetRS(machine_code, 0);
-                SetRT(machine_code, Register(op1));
-            } else {
-                SetRS(machine_code, Register(op1));
-                SetRT(machine_code, rt.at(mnemonic));
-            }
-
-            // 立即数或符号的处理
-            if (isNumber(op2)) {
-                SetImmediate(machine_code, toNumber(op2));
-
-                if (mnemonic[0] == 'B')
-                    std::cout<< "Immediate value in branch instruction.\n";
-
-            } else if (isSymbol(op2)) {
+            unsigned rs = 0, rt = 0;   // REGIMM 类分支用 RT 区分条件，已在 base 中
+            if (info->syntax == Syntax::RtImm) {
+                rt = Register(op1);
+            } else if (info->syntax == Syntax::RsOffset) {
+                rs = Register(op1);
+            } else goto err;
 
-                SetImmediate(machine_code, 0);
-                unsolved_symbol_map[op2].push_back(
-                    SymbolRef{machine_code_it, cur_instruction});
-
-            } else throw ExceptNumberOrSymbol(op2);
+            // 立即数、符号或表达式的处理
+            unsigned immediate = ImmediateOrReference(*info, ParseOperand(op2), op2,
+                unsolved_symbol_map, SymbolRef{machine_code_it, cur_instruction});
 
+            machine_code = info->base | EncodeI(0, rs, rt, immediate);
         }
 
         else {
@@ -233,32 +157,30 @@ MachineCode I_FormatInstruction(const std::string& mnemonic,
 }
 
 /*
- * 判断机器码是否为 I 格式：
+ * ImmediateOrReference：16 位立即数操作数（op 为其源文本，报错用）
+ *   常量按 OP 的扩展方式检查范围后返回（分支中写常量偏移时给出提示）；
+ *   含符号时返回 0 占位，连同 addend 加入未解决符号表。
+ *   %hi/%lo 只能用于按绝对值回填的立即数，不能用于分支偏移。
  */
-bool isI_Format(MachineCode machine_code) {
-    int op = machine_code >> 26;
-
-    // 1. 算术/逻辑立即数指令: 0b001xxx (8 ~ 15)
-    // 包括: addi, addiu, slti, sltiu, andi, ori, xori, lui
-    if ((op >> 3) == 1) return true;
-
-    // 2. 分支指令 (Branch): 0b0001xx (4 ~ 7) 和 0b000001 (1)
-    // 包括: beq, bne, blez, bgtz, 以及 REGIMM 类 (bltz, bgez, bltzal, bgezal)
-    if (op == 0b000001 || (op >> 2) == 1) return true;
-
-    // 3. 访存指令 (Load/Store): 0b10xxxx (32 ~ 47)
-    // 包括: lb, lh, lw, lbu, lhu, sb, sh, sw 等
-    if ((op >> 4) == 0b10) return true;
-
-    return false;
+static unsigned ImmediateOrReference(const OpcodeInfo& info, const Operand& operand,
+                                     const std::string& op,
+                                     UnsolvedSymbolMap& unsolved_symbol_map, SymbolRef ref) {
+    const bool branch = info.fixup == Fixup::Rel16;
+    if (branch) RequireWholeOperand(operand, op);
+
+    if (!operand.IsConstant()) {
+        unsolved_symbol_map.Add(operand.symbol, ref, operand.GetAddend());
+        return 0;
+    }
+    unsigned immediate = ImmediateOperand(operand, ImmediateExtend(info.op));
+    if (branch) Diag() << "Immediate value in branch instruction.\n";
+    return immediate;
 }
 
 /*
- * 正则判断汇编指令是否 I 格式
+ * 判断汇编指令是否交给 I 格式处理：按助记符查指令表
  */
 bool isI_Format(const std::string& assembly) {
-    std::string mnemonic = GetMnemonic(assembly);
-    std::cmatch m;
-    std::regex_match(mnemonic.c_str(), m, I_format_regex);
-    return (!m.empty() && m.prefix().str().empty() && m.suffix().str().empty());
-}
\ No newline at end of file
+    const OpcodeInfo* info = FindOpcode(GetMnemonic(assembly));
+    return info != nullptr && info->format == Format::I;
+}
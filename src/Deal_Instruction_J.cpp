@@ -1,14 +1,5 @@
 #include "Headers.h"
 
-/*
- * J 格式（Jump Format）指令识别正则表达式
- *
- * 包含指令：
- *   J   label/imm
- *   JAL label/imm
- */
-std::regex J_format_regex("^(j|jal)", std::regex::icase);
-
 /*
  * J_FormatInstruction
  *
@@ -44,35 +35,37 @@ MachineCode J_FormatInstruction(const std::string& mnemonic,
          * J / JAL 语法格式：
          *     J   target
          *     JAL target
-         * target 为数字 或 标签，且不能再有多余操作数
+         * target 为数字、标签或表达式（如 label+8），且不能再有多余操作数
          */
-        if ((isNumber(op1) || isSymbol(op1)) && op2.empty() && op3.empty()) {
+        Operand target;
+        if (op2.empty() && op3.empty() && TryParseOperand(op1, target)) {
 
-            // 设置 OP 字段
-            if (mnemonic == "J") {
-                SetOP(machine_code, 0b000010);  // J
-            } else {
-                SetOP(machine_code, 0b000011);  // JAL
-            }
+            // OP 字段（J / JAL）取自指令表拼好的 base
+            const OpcodeInfo* info = FindOpcode(mnemonic);
+            if (info == nullptr || info->syntax != Syntax::Target) throw UnknownInstruction(mnemonic);
 
             /*
              * op1 为跳转目的地址：
-             * 若是数字 → 除以 4 后直接写入
-             * 若是符号 → 写临时 0 占位，并加入未解决符号表
+             * 若是常量 → 除以 4 后检查是否放得下 26 位
+             * 若含符号 → 写临时 0 占位，连同 addend 加入未解决符号表
              */
-            if (isNumber(op1)) {
-                unsigned raw_addr = toNumber(op1);
+            RequireWholeOperand(target, op1);
+
+            unsigned address = 0;
+            if (target.IsConstant()) {
+                unsigned raw_addr = target.value;
                 if(raw_addr % 4 != 0)
-                    std::cout << "Warning: Jump target address " << raw_addr << " is not word-aligned!" << std::endl;
-                SetAddress(machine_code, raw_addr >> 2); // 除以4后写入
-                std::cout<< "You are using an immediate value in jump instruction, ";
+                    Diag() << "Warning: Jump target address " << raw_addr << " is not word-aligned!" << std::endl;
+                address = CheckUnsigned(raw_addr >> 2, AddressField::kWidth, "Address"); // 除以4后写入
+                Diag() << "You are using an immediate value in jump instruction, ";
             } else {
                 // 符号地址需第二遍回填
-                SetAddress(machine_code, 0);
-                unsolved_symbol_map[op1].push_back(
-                    SymbolRef{machine_code_it, cur_instruction});
+                unsolved_symbol_map.Add(target.symbol,
+                    SymbolRef{machine_code_it, cur_instruction}, target.GetAddend());
             }
 
+            machine_code = info->base | EncodeJ(0, address);
+
         } else {
             /*
              * J 型最多只有 1 个参数，如果有2-3个参数 → 错误
@@ -93,24 +86,9 @@ MachineCode J_FormatInstruction(const std::string& mnemonic,
 }
 
 /*
- * 判断机器码是否为 J 格式
- *
- * J (000010)
- * JAL (000011)
- */
-bool isJ_Format(MachineCode machine_code) {
-    int op = machine_code >> 26; // 取出 OP 字段
-    return op == 0b000010 || op == 0b000011;
-}
-
-/*
- * 判断汇编语句是否为 J 格式
+ * 判断汇编语句是否为 J 格式：按助记符查指令表
  */
 bool isJ_Format(const std::string& assembly) {
-    std::string mnemonic = GetMnemonic(assembly);
-    std::cmatch m;
-    std::regex_match(mnemonic.c_str(), m, J_format_regex);
-
-    // 如果正则完整匹配（前缀后缀均为空）
-    return (!m.empty() && m.prefix().str().empty() && m.suffix().str().empty());
-}
\ No newline at end of file
+    const OpcodeInfo* info = FindOpcode(GetMnemonic(assembly));
+    return info != nullptr && info->format == Format::J;
+}
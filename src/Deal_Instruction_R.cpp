@@ -1,24 +1,5 @@
 #include "Headers.h"
 
-/*
- * R 格式指令匹配正则：
- *
- * 包含：
- *   - 加法：add addu sub subu
- *   - 逻辑：and or xor nor
- *   - 比较：slt sltu
- *   - 移位：sll srl sra sllv srlv srav
- *   - 跳转：jr jalr
- *   - 乘除：mult multu div divu
- *   - 系统：break syscall eret
- *   - HI/LO 相关：mfhi mflo mthi mtlo
- *
- */
-std::regex R_format_regex(
-    "^(addu?|subu?|and|[xn]?or|sltu?|s(?:ll|rl|ra)v?|jr|multu?|divu?|m[tf]hi|"
-    "m[tf]lo|jalr|break|syscall|eret)",
-    std::regex::icase);
-
 /*
  * R_FormatInstruction：
  *
@@ -33,6 +14,8 @@ std::regex R_format_regex(
  *   OP  |  RS   |  RT   |  RD   |Shamt | Func
  *
  * OP 恒为 0（ERET 特例会被改成 0x10）
+ * 固定字段（OP、Func、ERET 的 RS）已由指令表拼好（info->base），按表中的语法分类操作数；
+ * 各分支只负责确定操作数字段（寄存器编号与移位量在分类时检查），最后或进 base 一次写入。
  */
 MachineCode R_FormatInstruction(const std::string& mnemonic,
                                 const std::string& assembly,
@@ -46,9 +29,14 @@ MachineCode R_FormatInstruction(const std::string& mnemonic,
     // 提取三个操作数
     std::string op1, op2, op3;
     GetOperand(assembly, op1, op2, op3);
+    Operand operand;   // 移位量（数字、符号或表达式）
 
-    // R 型中OP 字段 = 0（除 ERET、MFC0、MTC0）
-    SetOP(machine_code, 0);
+    // R 型中OP 字段 = 0（除 ERET），未用到的字段为 0
+    const OpcodeInfo* info = FindOpcode(mnemonic);
+    if (info == nullptr) goto err;
+
+    unsigned rs, rt, rd, shamt;
+    rs = rt = rd = shamt = 0;
 
     
     // 一、 三操作数 R 指令（ADD/ADDU/SUB/SUBU/SLT/移位变量类）
@@ -56,23 +44,6 @@ MachineCode R_FormatInstruction(const std::string& mnemonic,
     
     if (!op1.empty() && !op2.empty() && !op3.empty()) {
 
-        // 常规算术与逻辑类，Func 对应如下
-        std::unordered_map<std::string, int> func1{
-            {"ADD", 0b100000},  {"ADDU", 0b100001}, {"SUB", 0b100010},
-            {"SUBU", 0b100011}, {"AND", 0b100100}, {"OR", 0b100101},
-            {"XOR", 0b100110},  {"NOR", 0b100111}, {"SLT", 0b101010},
-            {"SLTU", 0b101011}, {"SLLV", 0b000100},{"SRLV",0b000110},
-            {"SRAV",0b000111}
-        };
-
-        // 固定移位（shift immediate）
-        std::unordered_map<std::string, int> func2{
-            {"SLL", 0b000000}, {"SRL", 0b000010}, {"SRA", 0b000011}
-        };
-
-        auto it1 = func1.find(mnemonic);
-        auto it2 = func2.find(mnemonic);
-
         /*
          *   三寄存器常规算术/逻辑类
          *
@@ -80,18 +51,16 @@ MachineCode R_FormatInstruction(const std::string& mnemonic,
          *   rs = op2
          *   rt = op3       ← 对于SLLV/SRLV/SRAV，需要交换 op2/op3
          */
-        if (it1 != func1.end()) {
+        if (info->syntax == Syntax::RdRsRt || info->syntax == Syntax::RdRtRs) {
 
             // 变量移位(sllv/srlv/srav)参数顺序与标准 R 格式不同，需交换
-            if (mnemonic == "SLLV" || mnemonic == "SRLV" || mnemonic == "SRAV") {
+            if (info->syntax == Syntax::RdRtRs) {
                 std::swap(op2, op3);
             }
 
-            SetFunc(machine_code, func1.at(mnemonic));
-            SetRS(machine_code, Register(op2));
-            SetRT(machine_code, Register(op3));
-            SetRD(machine_code, Register(op1));
-            SetShamt(machine_code, 0);
+            rs = Register(op2);
+            rt = Register(op3);
+            rd = Register(op1);
         }
 
         /*
@@ -100,20 +69,18 @@ MachineCode R_FormatInstruction(const std::string& mnemonic,
          * 格式：
          *   sll rd, rt, shamt
          */
-        else if (it2 != func2.end() && (isNumber(op3) || isSymbol(op3))) {
+        else if (info->syntax == Syntax::RdRtShamt && TryParseOperand(op3, operand)) {
             
-            SetFunc(machine_code, func2.at(mnemonic));
-            SetRS(machine_code, 0);
-            SetRT(machine_code, Register(op2));
-            SetRD(machine_code, Register(op1));
+            rt = Register(op2);
+            rd = Register(op1);
 
-            if (isNumber(op3)) {
-                SetShamt(machine_code, toNumber(op3));
+            RequireWholeOperand(operand, op3);
+            if (operand.IsConstant()) {
+                shamt = ShamtOperand(operand);
             } else {
                 // shamt 使用符号 → 第一次扫描先占位
-                SetShamt(machine_code, 0);
-                unsolved_symbol_map[op3].push_back(
-                    SymbolRef{machine_code_it, cur_instruction});
+                unsolved_symbol_map.Add(operand.symbol,
+                    SymbolRef{machine_code_it, cur_instruction}, operand.GetAddend());
             }
 
         } else goto err;
@@ -124,34 +91,15 @@ MachineCode R_FormatInstruction(const std::string& mnemonic,
     
     else if (!op1.empty() && !op2.empty() && op3.empty()) {
 
-        std::unordered_map<std::string, int> func3{
-            {"MULT", 0b011000},
-            {"MULTU",0b011001},
-            {"DIV",  0b011010},
-            {"DIVU", 0b011011},
-            {"JALR", 0b0001001}
-        };
-
-        auto it3 = func3.find(mnemonic);
-
-        if (it3 != func3.end()) {
-
-            // MULT/MULTU/DIV/DIVU
-            if (mnemonic != "JALR") {
-                SetRS(machine_code, Register(op1));
-                SetRT(machine_code, Register(op2));
-                SetRD(machine_code, 0);
-            } 
-            // JALR rd, rs
-            else {
-                SetRS(machine_code, Register(op2));
-                SetRT(machine_code, 0);
-                SetRD(machine_code, Register(op1));
-            }
-
-            SetShamt(machine_code, 0);
-            SetFunc(machine_code, func3.at(mnemonic));
-
+        // MULT/MULTU/DIV/DIVU
+        if (info->syntax == Syntax::RsRt) {
+            rs = Register(op1);
+            rt = Register(op2);
+        } 
+        // JALR rd, rs
+        else if (info->syntax == Syntax::RdRs) {
+            rs = Register(op2);
+            rd = Register(op1);
         } else goto err;
     }
 
@@ -160,64 +108,21 @@ MachineCode R_FormatInstruction(const std::string& mnemonic,
     
     else if (!op1.empty() && op2.empty() && op3.empty()) {
 
-        std::unordered_map<std::string, int> func4{
-            {"JR",   0b001000},
-            {"MFHI", 0b010000},
-            {"MFLO", 0b010010},
-            {"MTHI", 0b010001},
-            {"MTLO", 0b010011}
-        };
-
-        auto it4 = func4.find(mnemonic);
-
-        if (it4 != func4.end()) {
-
-            // JR rs
-            if (mnemonic != "MFHI" && mnemonic != "MFLO") {
-                SetRS(machine_code, Register(op1));
-                SetRT(machine_code, 0);
-                SetRD(machine_code, 0);
-            }
-            // MFHI rd   / MFLO rd
-            else {
-                SetRS(machine_code, 0);
-                SetRT(machine_code, 0);
-                SetRD(machine_code, Register(op1));
-            }
-
-            SetShamt(machine_code, 0);
-            SetFunc(machine_code, func4.at(mnemonic));
-
+        // JR rs
+        if (info->syntax == Syntax::Rs) {
+            rs = Register(op1);
+        }
+        // MFHI rd   / MFLO rd
+        else if (info->syntax == Syntax::Rd) {
+            rd = Register(op1);
         } else goto err;
     }
 
     
-    // 无操作数指令：BREAK / SYSCALL / ERET
+    // 无操作数指令：BREAK / SYSCALL / ERET（ERET 的 OP、RS 为 0x10，取自指令表）
     
     else if (op1.empty() && op2.empty() && op3.empty()) {
-
-        std::unordered_map<std::string, int> func5{
-            {"BREAK", 0b001101},
-            {"SYSCALL",0b001100},
-            {"ERET",   0b011000}
-        };
-
-        auto it5 = func5.find(mnemonic);
-
-        if (it5 != func5.end()) {
-
-            // ERET 特例：OP = 0x10, RS = 0x10
-            if (mnemonic == "ERET") {
-                SetOP(machine_code, 0b010000);
-            }
-
-            SetRS(machine_code, mnemonic == "ERET" ? 0b10000 : 0);
-            SetRT(machine_code, 0);
-            SetRD(machine_code, 0);
-            SetShamt(machine_code, 0);
-            SetFunc(machine_code, func5.at(mnemonic));
-
-        } else goto err;
+        if (info->syntax != Syntax::NoOperand) goto err;
     }
 
     
@@ -231,26 +136,15 @@ MachineCode R_FormatInstruction(const std::string& mnemonic,
             throw UnknownInstruction(mnemonic);
     }
 
+    machine_code = info->base | EncodeR(0, rs, rt, rd, shamt, 0);
     return machine_code;
 }
 
-/*
- * 判断机器码是否为 R 格式：
- *   R 格式要求 OP == 0
- */
-bool isR_Format(MachineCode machine_code) {
-    return (machine_code >> 26 == 0 || machine_code >> 26 == 0b010000); // 包含 ERET 特例
-}
-
 /*
  * 判断汇编行是否为 R 格式：
- *   使用正则匹配指令助记符
+ *   按助记符查指令表
  */
 bool isR_Format(const std::string& assembly) {
-    std::string mnemonic = GetMnemonic(assembly);
-    std::cmatch m;
-    std::regex_match(mnemonic.c_str(), m, R_format_regex);
-
-    // 必须完全匹配助记符
-    return (!m.empty() && m.prefix().str().empty() && m.suffix().str().empty());
-}
\ No newline at end of file
+    const OpcodeInfo* info = FindOpcode(GetMnemonic(assembly));
+    return info != nullptr && info->format == Format::R;
+}
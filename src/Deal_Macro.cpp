@@ -1,11 +1,5 @@
 #include "Headers.h"
 
-/*
- * 支持的宏指令正则表达式：
- *   mov / push / pop / nop
- */
-std::regex Macro_format_regex("^(mov|push|pop|nop)", std::regex::icase);
-
 /*
  * Macro_FormatInstruction
  *
@@ -41,6 +35,7 @@ MachineCode Macro_FormatInstruction(const std::string& mnemonic,
 
     std::string op1, op2, op3;
     GetOperand(assembly, op1, op2, op3);
+    Operand operand;   // MOV 的立即数（数字、符号或表达式）
 
     
     // 一、 MOV 宏指令（三种情况：寄存器间、寄存器与内存、寄存器与立即数）
@@ -84,11 +79,13 @@ MachineCode Macro_FormatInstruction(const std::string& mnemonic,
                     cur_instruction);
             }
 
-            // mov r1, imm(symbol)
-            else if (isRegister(op1) && (isNumber(op2) || isSymbol(op2))) {
+            // mov r1, imm(symbol / 表达式)
+            else if (isRegister(op1) && TryParseOperand(op2, operand)) {
 
-                // 判断立即数是否超过 16 位范围，如果超过需要用两条指令拆分
-                bool is_large_num = (!isSymbol(op2)) && (toUNumber(op2) > 0xffff);
+                // 判断常量是否超过 16 位范围，如果超过需要用两条指令拆分
+                // （符号与 %hi/%lo 交给 ORI，回填时检查）
+                bool is_large_num = operand.IsConstant() && operand.part == AddressPart::Whole &&
+                                    static_cast<unsigned>(operand.value) > 0xffff;
 
                 if (is_large_num) {
                     /*
@@ -99,7 +96,7 @@ MachineCode Macro_FormatInstruction(const std::string& mnemonic,
                      *   ori r, r, imm[15:0]
                      */
 
-                    unsigned number = toUNumber(op2);
+                    unsigned number = static_cast<unsigned>(operand.value);
 
                     // 新增一条 machine_code，用于后续 ORI
                     MachineCodeIt new_handel = NewMachineCode(*cur_instruction);
@@ -229,13 +226,9 @@ MachineCode Macro_FormatInstruction(const std::string& mnemonic,
 }
 
 /*
- * 判定是否是宏指令
+ * 判定是否是宏指令：按助记符查指令表
  */
 bool isMacro_Format(const std::string& assembly) {
-    std::string mnemonic = GetMnemonic(assembly);
-    std::cmatch m;
-    std::regex_match(mnemonic.c_str(), m, Macro_format_regex);
-
-    // 必须完整匹配助记符
-    return (!m.empty() && m.prefix().str().empty() && m.suffix().str().empty());
-}
\ No newline at end of file
+    const OpcodeInfo* info = FindOpcode(GetMnemonic(assembly));
+    return info != nullptr && info->format == Format::Macro;
+}
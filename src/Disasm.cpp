@@ -0,0 +1,410 @@
+#include <cctype>
+#include <charconv>
+#include <cstring>
+
+#include "Headers.h"
+
+static const size_t kMinChunkWords = 16384;   // 每个线程至少处理的字数
+static const size_t kCommentColumn = 40;      // 行尾注释（地址与机器码）的起始列
+
+/*
+ * 逐行输出：调用者先按一行的最大长度预留空间，之后直接用指针写入，不逐字符检查容量
+ */
+struct LineWriter {
+    char* p;
+
+    void Put(char c) { *p++ = c; }
+    void Put(std::string_view s) {
+        std::memcpy(p, s.data(), s.size());
+        p += s.size();
+    }
+    void Decimal(long long value) { p = std::to_chars(p, p + 24, value).ptr; }
+    void Hex(uint32_t value) { p = std::to_chars(p, p + 8, value, 16).ptr; }
+    void Hex8(uint32_t value) {
+        static const char kDigits[] = "0123456789abcdef";
+        for (int i = 7; i >= 0; i--, value >>= 4) p[i] = kDigits[value & 0xF];
+        p += 8;
+    }
+};
+
+// 各寄存器的输出名：取 Isa.h 别名表中每个编号的第一个名字，小写并加 $
+static const std::vector<std::string>& RegisterNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result(32);
+        for (const RegisterName& r : kRegisterNames) {
+            if (!result[r.id].empty()) continue;
+            result[r.id] = "$";
+            for (char c : r.name) result[r.id] += static_cast<char>(std::tolower(c));
+        }
+        return result;
+    }();
+    return names;
+}
+
+// 小写助记符，按 kOpcodeTable 的下标
+static const std::vector<std::string>& LowerMnemonics() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        for (const OpcodeInfo& info : kOpcodeTable) {
+            std::string name(info.mnemonic);
+            for (char& c : name) c = static_cast<char>(std::tolower(c));
+            result.push_back(name);
+        }
+        return result;
+    }();
+    return names;
+}
+
+/*
+ * 跳转目标的名字：slots 按字下标记录该地址的 Label，
+ * -1 为没有 Label，-2 为生成的 L_<地址>，>= 0 为 names 的下标（来自 --symbols）
+ */
+struct LabelSlots {
+    std::vector<int32_t> slots;   // 比镜像多一项：镜像末尾之后的地址也可以是目标
+    std::vector<std::string> names;
+    size_t max_length = 10;       // 最长的名字（L_<地址> 为 10 个字符）
+
+    bool Has(uint64_t address) const {
+        return address % 4 == 0 && address / 4 < slots.size() && slots[address / 4] != -1;
+    }
+
+    void Put(LineWriter& out, unsigned address) const {
+        int32_t slot = slots[address / 4];
+        if (slot >= 0) {
+            out.Put(names[slot]);
+        } else {
+            out.Put("L_");
+            out.Hex8(address);
+        }
+    }
+};
+
+// 分支指令的目标地址：PC + 4 + 符号扩展的 offset * 4
+static uint64_t BranchTarget(MachineCode code, unsigned address) {
+    int16_t offset = static_cast<int16_t>(ImmediateField::Get(code));
+    return static_cast<uint64_t>(static_cast<int64_t>(address) + 4 + offset * 4);
+}
+
+static bool IsBranch(Syntax syntax) {
+    return syntax == Syntax::RsRtOffset || syntax == Syntax::RsOffset;
+}
+
+/*
+ * 查表解码；表中匹配、但操作数超出编码器范围的字也按无法解码处理，保证输出可以重新汇编：
+ *   - MFC0/MTC0 的 sel 写在 Func 中，编码器只接受 3 位
+ */
+static const OpcodeInfo* DecodeInstruction(MachineCode code) {
+    const OpcodeInfo* info = DecodeOpcode(code);
+    if (info != nullptr && info->syntax == Syntax::Cop0 && FuncField::Get(code) > 7) return nullptr;
+    return info;
+}
+
+/*
+ * 输出一条指令的助记符与操作数（不含缩进与注释），写法与编码器接受的一致
+ */
+static void PutInstruction(LineWriter& out, const OpcodeInfo& info, MachineCode code,
+                           unsigned address, const LabelSlots& labels) {
+    const std::vector<std::string>& reg = RegisterNames();
+    const std::string& rs = reg[RsField::Get(code)];
+    const std::string& rt = reg[RtField::Get(code)];
+    const std::string& rd = reg[RdField::Get(code)];
+    uint32_t immediate = ImmediateField::Get(code);
+
+    out.Put(LowerMnemonics()[&info - kOpcodeTable]);
+    if (info.syntax != Syntax::NoOperand) out.Put(' ');
+
+    // 立即数：符号扩展的写有符号十进制，零扩展的写十六进制
+    auto put_immediate = [&] {
+        if (ImmediateExtend(info.op) == Extend::Sign) {
+            out.Decimal(static_cast<int16_t>(immediate));
+        } else {
+            out.Put("0x");
+            out.Hex(immediate);
+        }
+    };
+    // 分支目标：在镜像内写 Label，否则写原始的 offset
+    auto put_branch = [&] {
+        uint64_t target = BranchTarget(code, address);
+        if (labels.Has(target)) labels.Put(out, static_cast<unsigned>(target));
+        else out.Decimal(static_cast<int16_t>(immediate));
+    };
+    auto sep = [&] { out.Put(", "); };
+
+    switch (info.syntax) {
+        case Syntax::RdRsRt: out.Put(rd); sep(); out.Put(rs); sep(); out.Put(rt); break;
+        case Syntax::RdRtRs: out.Put(rd); sep(); out.Put(rt); sep(); out.Put(rs); break;
+        case Syntax::RdRtShamt:
+            out.Put(rd); sep(); out.Put(rt); sep();
+            out.Decimal(ShamtField::Get(code));
+            break;
+        case Syntax::RsRt: out.Put(rs); sep(); out.Put(rt); break;
+        case Syntax::RdRs: out.Put(rd); sep(); out.Put(rs); break;
+        case Syntax::Rs: out.Put(rs); break;
+        case Syntax::Rd: out.Put(rd); break;
+        case Syntax::NoOperand: break;
+        case Syntax::RtRsImm: out.Put(rt); sep(); out.Put(rs); sep(); put_immediate(); break;
+        case Syntax::RsRtOffset: out.Put(rs); sep(); out.Put(rt); sep(); put_branch(); break;
+        case Syntax::RtImm: out.Put(rt); sep(); put_immediate(); break;
+        case Syntax::RsOffset: out.Put(rs); sep(); put_branch(); break;
+        case Syntax::RtMem:
+            out.Put(rt); sep(); put_immediate();
+            out.Put('('); out.Put(rs); out.Put(')');
+            break;
+        case Syntax::Target: {
+            uint64_t target = uint64_t(AddressField::Get(code)) << 2;
+            if (labels.Has(target)) {
+                labels.Put(out, static_cast<unsigned>(target));
+            } else {
+                out.Put("0x");
+                out.Hex(static_cast<uint32_t>(target));
+            }
+            break;
+        }
+        case Syntax::Cop0:
+            // CP0 寄存器写编号
+            out.Put(rt); sep(); out.Put('$');
+            out.Decimal(RdField::Get(code)); sep();
+            out.Decimal(FuncField::Get(code));
+            break;
+        case Syntax::Macro: break;
+    }
+}
+
+/*
+ * 把 [begin, end) 号字的文本追加到 out，返回无法解码的字数
+ */
+static size_t DisassembleRange(const std::vector<uint32_t>& words, size_t begin, size_t end,
+                               const LabelSlots& labels, std::string& out) {
+    // 一行最长：Label 行 + 助记符与三个操作数（至多一个 Label）+ 注释
+    // out 按块扩大，used 为已写入的长度，最后截断到 used
+    const size_t max_line = 2 * labels.max_length + 128;
+    size_t used = out.size();
+    size_t unknown = 0;
+    for (size_t i = begin; i < end; i++) {
+        const unsigned address = static_cast<unsigned>(i * 4);
+        const MachineCode code = words[i];
+
+        if (out.size() - used < max_line) out.resize(std::max(2 * out.size(), used + (end - i) * 64 + max_line));
+        LineWriter line{&out[used]};
+        if (labels.slots[i] != -1) {
+            labels.Put(line, address);
+            line.Put(":\n");
+        }
+
+        char* line_start = line.p;
+        line.Put("    ");
+        const OpcodeInfo* info = DecodeInstruction(code);
+        if (code == 0) {
+            line.Put("nop");   // sll $zero, $zero, 0
+        } else if (info != nullptr) {
+            PutInstruction(line, *info, code, address, labels);
+        } else {
+            line.Put(".word 0x");
+            line.Hex8(code);
+            unknown++;
+        }
+
+        // 行尾注释：地址与机器码，与 details.txt 相同
+        size_t width = line.p - line_start;
+        size_t pad = width < kCommentColumn ? kCommentColumn - width : 1;
+        std::memset(line.p, ' ', pad);
+        line.p += pad;
+        line.Put("# ");
+        line.Hex8(address);
+        line.Put("  ");
+        line.Hex8(code);
+        if (info == nullptr && code != 0) line.Put("  unknown instruction");
+        line.Put('\n');
+        used = line.p - out.data();
+    }
+    out.resize(used);
+    return unknown;
+}
+
+/*
+ * 把 [0, count) 分成若干块并行处理：func(k, begin, end)，k 为块号
+ * （与 ReadSource 相同，第 0 块在当前线程上处理）
+ */
+template <typename Func>
+static void ForEachChunk(size_t count, size_t chunks, Func func) {
+    auto run = [&](size_t k) { func(k, count * k / chunks, count * (k + 1) / chunks); };
+    std::vector<std::thread> workers;
+    for (size_t k = 1; k < chunks; k++) workers.emplace_back(run, k);
+    run(0);
+    for (auto& worker : workers) worker.join();
+}
+
+size_t Disassemble(const std::vector<uint32_t>& words,
+                   const std::unordered_map<unsigned, std::string>& symbols, unsigned threads,
+                   std::string& out) {
+    const size_t n = words.size();
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, n / kMinChunkWords));
+
+    // 一、并行收集镜像内的分支/跳转目标（各块分别记录，再合并）
+    std::vector<std::vector<uint32_t>> targets(chunks);
+    ForEachChunk(n, chunks, [&](size_t k, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const OpcodeInfo* info = DecodeOpcode(words[i]);
+            if (info == nullptr) continue;
+            uint64_t target;
+            if (IsBranch(info->syntax)) target = BranchTarget(words[i], static_cast<unsigned>(i * 4));
+            else if (info->syntax == Syntax::Target) target = uint64_t(AddressField::Get(words[i])) << 2;
+            else continue;
+            if (target / 4 <= n) targets[k].push_back(static_cast<uint32_t>(target / 4));
+        }
+    });
+
+    LabelSlots labels;
+    labels.slots.assign(n + 1, -1);
+    for (const auto& [address, name] : symbols) {
+        if (address % 4 == 0 && address / 4 <= n) {
+            labels.slots[address / 4] = static_cast<int32_t>(labels.names.size());
+            labels.names.push_back(name);
+            labels.max_length = std::max(labels.max_length, name.size());
+        }
+    }
+    for (const auto& chunk : targets) {
+        for (uint32_t index : chunk) {
+            if (labels.slots[index] == -1) labels.slots[index] = -2;
+        }
+    }
+
+    // 末尾连续的 0 字省略，但保留到最后一个 Label 为止
+    size_t count = n;
+    while (count > 0 && words[count - 1] == 0 && labels.slots[count] == -1 &&
+           labels.slots[count - 1] == -1) {
+        count--;
+    }
+
+    out += "# mas --disasm: " + std::to_string(n) + " words";
+    if (count < n) out += ", trailing " + std::to_string(n - count) + " zero words omitted";
+    out += "\n.text\n";
+
+    // 二、并行生成各块文本：第 0 块直接写入 out，其余各块写好后按顺序拼接
+    const size_t text_chunks = std::max<size_t>(1, std::min<size_t>(threads, count / kMinChunkWords));
+    std::vector<std::string> parts(text_chunks);
+    std::vector<size_t> unknown(text_chunks, 0);
+    out.reserve(out.size() + count * 64);
+    ForEachChunk(count, text_chunks, [&](size_t k, size_t begin, size_t end) {
+        std::string& part = k == 0 ? out : parts[k];
+        if (k > 0) part.reserve((end - begin) * 64);
+        unknown[k] = DisassembleRange(words, begin, end, labels, part);
+    });
+
+    size_t total_unknown = unknown[0];
+    for (size_t k = 1; k < text_chunks; k++) {
+        out += parts[k];
+        total_unknown += unknown[k];
+    }
+
+    // 镜像末尾之后的 Label（如程序末尾的 end:）
+    if (count == n && labels.slots[n] != -1) {
+        std::string name(labels.max_length + 2, '\0');
+        LineWriter line{&name[0]};
+        labels.Put(line, static_cast<unsigned>(n * 4));
+        name.resize(line.p - name.data());
+        out += name + ":\n";
+    }
+    return total_unknown;
+}
+
+bool ReadLabelTable(const std::string& path, std::unordered_map<unsigned, std::string>& labels,
+                    std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    // 代码段的行：8 位十六进制地址、机器码、二进制，Tab 之后是源代码，可能带 Label。
+    // 单独占一行的 Label 没有自己的行，只能从引用它的分支、跳转语句反推：
+    // 目标操作数是普通 Label 时，用机器码算出的目标地址对应这个名字
+    std::unordered_map<unsigned, std::string> referenced;
+    std::string line;
+    bool in_code = false;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 12, "Code Segment") == 0) {
+            in_code = true;
+            continue;
+        }
+        if (line.compare(0, 12, "Data Segment") == 0) break;
+        if (!in_code) continue;
+
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos || tab < 18) continue;
+        unsigned address = 0;
+        MachineCode code = 0;
+        auto parsed = std::from_chars(line.data(), line.data() + 8, address, 16);
+        if (parsed.ec != std::errc() || parsed.ptr != line.data() + 8) continue;
+        parsed = std::from_chars(line.data() + 10, line.data() + 18, code, 16);
+        if (parsed.ec != std::errc() || parsed.ptr != line.data() + 18) continue;
+
+        std::string_view source(line);
+        source.remove_prefix(tab);
+        source = source.substr(0, source.find('#'));
+        size_t colon = source.find(':');
+        if (colon != std::string_view::npos) {
+            size_t begin = source.find_first_not_of(" \t");
+            std::string name(source.substr(begin, colon - begin));
+            // 局部 Label 离开所在函数后没有意义，改用 L_<地址>；只保留第一次出现的地址
+            if (isSymbol(name) && !isLocalLabel(toCanonicalCase(name))) labels.emplace(address, name);
+            source.remove_prefix(colon + 1);
+        }
+
+        // 宏展开的每个字都带同一行源代码，只有分支、跳转字的目标与操作数对应
+        const OpcodeInfo* info = DecodeOpcode(code);
+        if (info == nullptr) continue;
+        uint64_t target;
+        if (IsBranch(info->syntax)) target = BranchTarget(code, address);
+        else if (info->syntax == Syntax::Target) target = uint64_t(AddressField::Get(code)) << 2;
+        else continue;
+
+        // 最后一个操作数：从末尾取到空白或逗号为止
+        size_t end = source.find_last_not_of(" \t\r");
+        if (end == std::string_view::npos) continue;
+        size_t start = source.find_last_of(" \t,", end);
+        std::string name(source.substr(start + 1, end - start));
+        if (isSymbol(name) && !isLocalLabel(toCanonicalCase(name))) {
+            referenced.emplace(static_cast<unsigned>(target), std::move(name));
+        }
+    }
+    // 定义处的名字优先
+    for (auto& [address, name] : referenced) labels.emplace(address, std::move(name));
+    return true;
+}
+
+int doDisassemble(const std::string& input_path, const std::string& output_path,
+                  const DisasmOptions& options) {
+    std::vector<uint32_t> words;
+    std::string error;
+    if (!ReadImage(input_path, words, error)) {
+        std::cerr << "Disassembler Error: " << error << std::endl;
+        return 1;
+    }
+
+    std::unordered_map<unsigned, std::string> labels;
+    if (!options.symbols_path.empty() && !ReadLabelTable(options.symbols_path, labels, error)) {
+        std::cerr << "Disassembler Error: " << error << std::endl;
+        return 1;
+    }
+
+    std::string text;
+    size_t unknown = Disassemble(words, labels, options.threads, text);
+    if (unknown > 0) {
+        std::cerr << "Warning: " << unknown
+                  << " words do not decode to any instruction and were written as .word"
+                  << std::endl;
+    }
+
+    if (output_path.empty()) {
+        std::cout.write(text.data(), text.size());
+        std::cout.flush();
+        return std::cout ? 0 : 1;
+    }
+    if (!WriteFileIfChanged(output_path, text, false)) {
+        std::cerr << "IO Error: Could not write to " << output_path << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,239 @@
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MAS_ENCODE_X86 1
+#endif
+
+#include "Headers.h"
+
+/*
+ * 标量实现：逐条检查并编码，遇到越界的一条时返回其下标
+ * 向量实现处理不满一步的尾部、或某一步中有越界指令时，也从这一步的开头交给这里
+ */
+static bool ImmediateInRange(unsigned op, std::int32_t immediate) {
+    return immediate >= (ImmediateExtend(op) == Extend::Sign ? -32768 : 0) && immediate <= 65535;
+}
+
+static size_t EncodeRScalar(const RColumns& in, size_t i, MachineCode* out) {
+    for (; i < in.count; i++) {
+        if (in.op[i] > OpField::kMax || in.rs[i] > RsField::kMax || in.rt[i] > RtField::kMax ||
+            in.rd[i] > RdField::kMax || in.shamt[i] > ShamtField::kMax ||
+            in.func[i] > FuncField::kMax) {
+            return i;
+        }
+        out[i] = EncodeR(in.op[i], in.rs[i], in.rt[i], in.rd[i], in.shamt[i], in.func[i]);
+    }
+    return in.count;
+}
+
+static size_t EncodeIScalar(const IColumns& in, size_t i, MachineCode* out) {
+    for (; i < in.count; i++) {
+        if (in.op[i] > OpField::kMax || in.rs[i] > RsField::kMax || in.rt[i] > RtField::kMax ||
+            !ImmediateInRange(in.op[i], in.immediate[i])) {
+            return i;
+        }
+        out[i] = EncodeI(in.op[i], in.rs[i], in.rt[i], static_cast<unsigned>(in.immediate[i]));
+    }
+    return in.count;
+}
+
+static size_t EncodeJScalar(const JColumns& in, size_t i, MachineCode* out) {
+    for (; i < in.count; i++) {
+        if (in.op[i] > OpField::kMax || in.address[i] > AddressField::kMax) return i;
+        out[i] = EncodeJ(in.op[i], in.address[i]);
+    }
+    return in.count;
+}
+
+static size_t EncodeRScalar(const RColumns& in, MachineCode* out) { return EncodeRScalar(in, 0, out); }
+static size_t EncodeIScalar(const IColumns& in, MachineCode* out) { return EncodeIScalar(in, 0, out); }
+static size_t EncodeJScalar(const JColumns& in, MachineCode* out) { return EncodeJScalar(in, 0, out); }
+
+#ifdef MAS_ENCODE_X86
+/*
+ * AVX2：每步 8 条，8 位列用 vpmovzxbd 扩展为 32 位 lane
+ *   字段检查：把各字段右移自身宽度后按位或，整组为 0 才全部合法
+ *   立即数检查：OP 为 0b0011xx 的 lane 取 [0, 65535]，其余取 [-32768, 65535]（见 Encoding.h 的 Extend）
+ */
+__attribute__((target("avx2"))) static inline __m256i LoadU8x8(const std::uint8_t* p) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+
+__attribute__((target("avx2"))) static inline __m256i Load32x8(const void* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+__attribute__((target("avx2"))) static size_t EncodeRAvx2(const RColumns& in, MachineCode* out) {
+    size_t i = 0;
+    for (; i + 8 <= in.count; i += 8) {
+        __m256i op = LoadU8x8(in.op + i), rs = LoadU8x8(in.rs + i), rt = LoadU8x8(in.rt + i),
+                rd = LoadU8x8(in.rd + i), shamt = LoadU8x8(in.shamt + i),
+                func = LoadU8x8(in.func + i);
+
+        __m256i wide = _mm256_or_si256(
+            _mm256_srli_epi32(_mm256_or_si256(op, func), OpField::kWidth),
+            _mm256_srli_epi32(
+                _mm256_or_si256(_mm256_or_si256(rs, rt), _mm256_or_si256(rd, shamt)),
+                RsField::kWidth));
+        if (!_mm256_testz_si256(wide, wide)) return EncodeRScalar(in, i, out);
+
+        __m256i word = _mm256_or_si256(
+            _mm256_or_si256(_mm256_slli_epi32(op, OpField::kShift),
+                            _mm256_slli_epi32(rs, RsField::kShift)),
+            _mm256_or_si256(
+                _mm256_or_si256(_mm256_slli_epi32(rt, RtField::kShift),
+                                _mm256_slli_epi32(rd, RdField::kShift)),
+                _mm256_or_si256(_mm256_slli_epi32(shamt, ShamtField::kShift), func)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), word);
+    }
+    return EncodeRScalar(in, i, out);
+}
+
+__attribute__((target("avx2"))) static size_t EncodeIAvx2(const IColumns& in, MachineCode* out) {
+    const __m256i zero_extend_op = _mm256_set1_epi32(0b0011);
+    const __m256i sign_min = _mm256_set1_epi32(-32768), max = _mm256_set1_epi32(65535);
+
+    size_t i = 0;
+    for (; i + 8 <= in.count; i += 8) {
+        __m256i op = LoadU8x8(in.op + i), rs = LoadU8x8(in.rs + i), rt = LoadU8x8(in.rt + i);
+        __m256i immediate = Load32x8(in.immediate + i);
+
+        __m256i zero = _mm256_cmpeq_epi32(_mm256_srli_epi32(op, 2), zero_extend_op);
+        __m256i min = _mm256_andnot_si256(zero, sign_min);
+        __m256i bad = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpgt_epi32(min, immediate),
+                            _mm256_cmpgt_epi32(immediate, max)),
+            _mm256_or_si256(_mm256_srli_epi32(op, OpField::kWidth),
+                            _mm256_srli_epi32(_mm256_or_si256(rs, rt), RsField::kWidth)));
+        if (!_mm256_testz_si256(bad, bad)) return EncodeIScalar(in, i, out);
+
+        __m256i word = _mm256_or_si256(
+            _mm256_or_si256(_mm256_slli_epi32(op, OpField::kShift),
+                            _mm256_slli_epi32(rs, RsField::kShift)),
+            _mm256_or_si256(_mm256_slli_epi32(rt, RtField::kShift),
+                            _mm256_and_si256(immediate, _mm256_set1_epi32(ImmediateField::kMax))));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), word);
+    }
+    return EncodeIScalar(in, i, out);
+}
+
+__attribute__((target("avx2"))) static size_t EncodeJAvx2(const JColumns& in, MachineCode* out) {
+    size_t i = 0;
+    for (; i + 8 <= in.count; i += 8) {
+        __m256i op = LoadU8x8(in.op + i), address = Load32x8(in.address + i);
+
+        __m256i wide = _mm256_or_si256(_mm256_srli_epi32(op, OpField::kWidth),
+                                       _mm256_srli_epi32(address, AddressField::kWidth));
+        if (!_mm256_testz_si256(wide, wide)) return EncodeJScalar(in, i, out);
+
+        __m256i word = _mm256_or_si256(_mm256_slli_epi32(op, OpField::kShift), address);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), word);
+    }
+    return EncodeJScalar(in, i, out);
+}
+
+/*
+ * AVX-512：每步 16 条，检查结果直接是 16 位的 lane 掩码
+ * GCC 12 的 avx512fintrin.h 用自赋值的变量表示 “未定义” 的 lane，-O2 下会误报未初始化
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#define MAS_AVX512 __attribute__((target("avx512f")))
+
+MAS_AVX512 static inline __m512i LoadU8x16(const std::uint8_t* p) {
+    return _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+MAS_AVX512 static size_t EncodeRAvx512(const RColumns& in, MachineCode* out) {
+    size_t i = 0;
+    for (; i + 16 <= in.count; i += 16) {
+        __m512i op = LoadU8x16(in.op + i), rs = LoadU8x16(in.rs + i), rt = LoadU8x16(in.rt + i),
+                rd = LoadU8x16(in.rd + i), shamt = LoadU8x16(in.shamt + i),
+                func = LoadU8x16(in.func + i);
+
+        __mmask16 bad =
+            _mm512_cmpgt_epu32_mask(_mm512_or_si512(op, func), _mm512_set1_epi32(OpField::kMax)) |
+            _mm512_cmpgt_epu32_mask(
+                _mm512_or_si512(_mm512_or_si512(rs, rt), _mm512_or_si512(rd, shamt)),
+                _mm512_set1_epi32(RsField::kMax));
+        if (bad) return EncodeRScalar(in, i, out);
+
+        __m512i word = _mm512_or_si512(
+            _mm512_or_si512(_mm512_slli_epi32(op, OpField::kShift),
+                            _mm512_slli_epi32(rs, RsField::kShift)),
+            _mm512_or_si512(
+                _mm512_or_si512(_mm512_slli_epi32(rt, RtField::kShift),
+                                _mm512_slli_epi32(rd, RdField::kShift)),
+                _mm512_or_si512(_mm512_slli_epi32(shamt, ShamtField::kShift), func)));
+        _mm512_storeu_si512(out + i, word);
+    }
+    return EncodeRScalar(in, i, out);
+}
+
+MAS_AVX512 static size_t EncodeIAvx512(const IColumns& in, MachineCode* out) {
+    size_t i = 0;
+    for (; i + 16 <= in.count; i += 16) {
+        __m512i op = LoadU8x16(in.op + i), rs = LoadU8x16(in.rs + i), rt = LoadU8x16(in.rt + i);
+        __m512i immediate = _mm512_loadu_si512(in.immediate + i);
+
+        __mmask16 zero = _mm512_cmpeq_epi32_mask(_mm512_srli_epi32(op, 2), _mm512_set1_epi32(0b0011));
+        __m512i min = _mm512_mask_blend_epi32(zero, _mm512_set1_epi32(-32768), _mm512_setzero_si512());
+        __mmask16 bad = _mm512_cmplt_epi32_mask(immediate, min) |
+                        _mm512_cmpgt_epi32_mask(immediate, _mm512_set1_epi32(65535)) |
+                        _mm512_cmpgt_epu32_mask(op, _mm512_set1_epi32(OpField::kMax)) |
+                        _mm512_cmpgt_epu32_mask(_mm512_or_si512(rs, rt), _mm512_set1_epi32(RsField::kMax));
+        if (bad) return EncodeIScalar(in, i, out);
+
+        __m512i word = _mm512_or_si512(
+            _mm512_or_si512(_mm512_slli_epi32(op, OpField::kShift),
+                            _mm512_slli_epi32(rs, RsField::kShift)),
+            _mm512_or_si512(_mm512_slli_epi32(rt, RtField::kShift),
+                            _mm512_and_si512(immediate, _mm512_set1_epi32(ImmediateField::kMax))));
+        _mm512_storeu_si512(out + i, word);
+    }
+    return EncodeIScalar(in, i, out);
+}
+
+MAS_AVX512 static size_t EncodeJAvx512(const JColumns& in, MachineCode* out) {
+    size_t i = 0;
+    for (; i + 16 <= in.count; i += 16) {
+        __m512i op = LoadU8x16(in.op + i), address = _mm512_loadu_si512(in.address + i);
+
+        __mmask16 bad = _mm512_cmpgt_epu32_mask(op, _mm512_set1_epi32(OpField::kMax)) |
+                        _mm512_cmpgt_epu32_mask(address, _mm512_set1_epi32(AddressField::kMax));
+        if (bad) return EncodeJScalar(in, i, out);
+
+        _mm512_storeu_si512(out + i, _mm512_or_si512(_mm512_slli_epi32(op, OpField::kShift), address));
+    }
+    return EncodeJScalar(in, i, out);
+}
+#undef MAS_AVX512
+#pragma GCC diagnostic pop
+#endif
+
+/*
+ * 启动时选择实现
+ */
+struct BatchEncoder {
+    size_t (*encode_r)(const RColumns&, MachineCode*);
+    size_t (*encode_i)(const IColumns&, MachineCode*);
+    size_t (*encode_j)(const JColumns&, MachineCode*);
+    const char* name;
+};
+
+static BatchEncoder SelectBatchEncoder() {
+#ifdef MAS_ENCODE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return {EncodeRAvx512, EncodeIAvx512, EncodeJAvx512, "avx512"};
+    }
+    if (__builtin_cpu_supports("avx2")) return {EncodeRAvx2, EncodeIAvx2, EncodeJAvx2, "avx2"};
+#endif
+    return {EncodeRScalar, EncodeIScalar, EncodeJScalar, "scalar"};
+}
+static const BatchEncoder g_encoder = SelectBatchEncoder();
+
+size_t EncodeRBatch(const RColumns& in, MachineCode* out) { return g_encoder.encode_r(in, out); }
+size_t EncodeIBatch(const IColumns& in, MachineCode* out) { return g_encoder.encode_i(in, out); }
+size_t EncodeJBatch(const JColumns& in, MachineCode* out) { return g_encoder.encode_j(in, out); }
+
+const char* BatchEncoderName() { return g_encoder.name; }
@@ -12,19 +12,27 @@ ExceptNumberOrSymbol::ExceptNumberOrSymbol(const std::string &msg)
      * 会生成：
      *   "offset should be a number or a symbol."
      */
-    : std::runtime_error(msg + " should be a number or a symbol."){};
+    : AssemblerError(msg + " should be a number or a symbol.", msg) {
+    CountException(ExceptionKind::ExceptNumberOrSymbol);
+}
 
 ExceptNumber::ExceptNumber(const std::string &msg)
-    : std::runtime_error(msg + " should be a number."){};
+    : AssemblerError(msg + " should be a number.", msg) {
+    CountException(ExceptionKind::ExceptNumber);
+}
 
 ExceptPositive::ExceptPositive(const std::string &msg)
-    : std::runtime_error(msg + " should be a positive number."){};
+    : AssemblerError(msg + " should be a positive number.", msg) {
+    CountException(ExceptionKind::ExceptPositive);
+}
 
 ExceptRegister::ExceptRegister(const std::string &name)
     /*
      * 指令中给出的寄存器不是合法名称（如 “r33”、“ax”）
      */
-    : std::runtime_error(name + " is not a register."){};
+    : AssemblerError(name + " is not a register.", name) {
+    CountException(ExceptionKind::ExceptRegister);
+}
 
 OperandError::OperandError(const std::string &mnemonic, const std::string &msg)
     /*
@@ -34,14 +42,18 @@ OperandError::OperandError(const std::string &mnemonic, const std::string &msg)
      * 生成：
      *   "expected register (ADD)."
      */
-    : std::runtime_error(msg + " (" + mnemonic + ")."){};
+    : AssemblerError(msg + " (" + mnemonic + ").", mnemonic) {
+    CountException(ExceptionKind::OperandError);
+}
 
 UnknownInstruction::UnknownInstruction(const std::string &mnemonic)
     /*
      * 未知指令，如用户输入：
      *   foo r1, r2
      */
-    : std::runtime_error("Unknown instruction: " + mnemonic + "."){};
+    : AssemblerError("Unknown instruction: " + mnemonic + ".", mnemonic) {
+    CountException(ExceptionKind::UnknownInstruction);
+}
 
 NumberOverflow::NumberOverflow(const std::string &name, const std::string &max,
                                const std::string &now)
@@ -51,5 +63,23 @@ NumberOverflow::NumberOverflow(const std::string &name, const std::string &max,
      *   max：允许的最大值，如 "32767"
      *   now：当前值，如 "40000"
      */
-    : std::runtime_error(name + " is too large. It should not larger than " +
-                         max + ". Now it is " + now){};
\ No newline at end of file
+    : AssemblerError(name + " is too large. It should not larger than " +
+                         max + ". Now it is " + now, now) {
+    CountException(ExceptionKind::NumberOverflow);
+}
+
+NumberOverflow::NumberOverflow(const std::string &name, const std::string &min,
+                               const std::string &max, const std::string &now)
+    : AssemblerError(name + " is out of range. It should be between " + min + " and " + max +
+                         ". Now it is " + now, now) {
+    CountException(ExceptionKind::NumberOverflow);
+}
+ExpressionError::ExpressionError(const std::string &expression, const std::string &reason)
+    /*
+     * 例：ExpressionError("A+B", "An expression can only reference one symbol")
+     * 生成：
+     *   "An expression can only reference one symbol: A+B."
+     */
+    : AssemblerError(reason + ": " + expression + ".", expression) {
+    CountException(ExceptionKind::ExpressionError);
+}
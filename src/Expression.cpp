@@ -0,0 +1,279 @@
+#include <cctype>
+
+#include "Headers.h"
+
+namespace {
+
+/*
+ * Term：求值过程中的中间结果，表示 coefficient * symbol + value
+ *   coefficient 为 0 时是常量；value 按 32 位补码运算
+ */
+struct Term {
+    uint32_t value = 0;
+    std::string_view symbol;
+    long long coefficient = 0;
+
+    bool IsConstant() const { return coefficient == 0; }
+};
+
+bool IsSymbolStart(char c) {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '$';
+}
+bool IsSymbolChar(char c) { return IsSymbolStart(c) || std::isdigit(static_cast<unsigned char>(c)); }
+
+/*
+ * ExpressionParser：按优先级递归下降（二元运算符用优先级爬升）
+ *   失败时 syntax_error 区分语法错误（报 ExceptNumberOrSymbol）与求值错误（报 ExpressionError）
+ */
+class ExpressionParser {
+public:
+    explicit ExpressionParser(std::string_view text) : text(text) {}
+
+    bool Parse(Term& result) {
+        if (!ParseBinary(1, result)) return false;
+        if (pos != text.size()) return Fail("", true);
+        return true;
+    }
+
+    bool syntax_error = false;
+    std::string message;
+
+private:
+    std::string_view text;
+    size_t pos = 0;
+
+    bool Fail(const char* reason, bool syntax) {
+        syntax_error = syntax;
+        message = reason;
+        return false;
+    }
+
+    // 当前位置的二元运算符及其优先级（| 最低，* / % 最高），不是运算符时返回 0
+    int PeekOperator(char& op, size_t& length) const {
+        if (pos >= text.size()) return 0;
+        op = text[pos];
+        length = 1;
+        switch (op) {
+            case '|': return 1;
+            case '^': return 2;
+            case '&': return 3;
+            case '<':
+            case '>':
+                if (pos + 1 >= text.size() || text[pos + 1] != op) return 0;
+                length = 2;
+                return 4;
+            case '+':
+            case '-': return 5;
+            case '*':
+            case '/':
+            case '%': return 6;
+            default: return 0;
+        }
+    }
+
+    bool ParseBinary(int min_precedence, Term& left) {
+        if (!ParseUnary(left)) return false;
+        while (true) {
+            char op;
+            size_t length;
+            int precedence = PeekOperator(op, length);
+            if (precedence == 0 || precedence < min_precedence) return true;
+            pos += length;
+
+            Term right;
+            if (!ParseBinary(precedence + 1, right) || !Apply(op, left, right)) return false;
+        }
+    }
+
+    bool ParseUnary(Term& term) {
+        if (pos >= text.size()) return Fail("", true);
+        char c = text[pos];
+        if (c == '-' || c == '+' || c == '~') {
+            pos++;
+            if (!ParseUnary(term)) return false;
+            if (c == '-') {
+                term.value = 0u - term.value;
+                term.coefficient = -term.coefficient;
+            } else if (c == '~') {
+                if (!term.IsConstant()) return Fail("A symbol can only be added or subtracted", false);
+                term.value = ~term.value;
+            }
+            return true;
+        }
+        return ParsePrimary(term);
+    }
+
+    bool ParsePrimary(Term& term) {
+        char c = text[pos];
+        if (c == '(') {
+            pos++;
+            if (!ParseBinary(1, term)) return false;
+            if (pos >= text.size() || text[pos] != ')') return Fail("", true);
+            pos++;
+            return true;
+        }
+
+        if (c == '%') return Fail("%HI/%LO must enclose the whole operand", false);
+
+        size_t start = pos;
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            while (pos < text.size() && std::isalnum(static_cast<unsigned char>(text[pos]))) pos++;
+            std::string number(text.substr(start, pos - start));
+            // 1B/1F：对数字局部 Label 的引用（见 LocalLabel.h）
+            if (isLocalReference(number)) {
+                term.symbol = text.substr(start, pos - start);
+                term.coefficient = 1;
+                return true;
+            }
+            if (!isPositive(number)) return Fail("", true);
+            try {
+                term.value = static_cast<uint32_t>(toNumber(number));
+            } catch (const std::out_of_range&) {
+                return Fail("Number out of range", false);
+            }
+            return true;
+        }
+
+        if (IsSymbolStart(c)) {
+            while (pos < text.size() && IsSymbolChar(text[pos])) pos++;
+            term.symbol = text.substr(start, pos - start);
+            if (isRegister(std::string(term.symbol))) return Fail("", true);
+            term.coefficient = 1;
+            return true;
+        }
+        return Fail("", true);
+    }
+
+    bool Apply(char op, Term& left, const Term& right) {
+        if (op == '+' || op == '-') {
+            if (!left.IsConstant() && !right.IsConstant() && left.symbol != right.symbol)
+                return Fail("An expression can only reference one symbol", false);
+            if (left.IsConstant()) left.symbol = right.symbol;
+            if (op == '+') {
+                left.value += right.value;
+                left.coefficient += right.coefficient;
+            } else {
+                left.value -= right.value;
+                left.coefficient -= right.coefficient;
+            }
+            if (left.IsConstant()) left.symbol = {};
+            return true;
+        }
+
+        if (op == '*') {
+            if (!left.IsConstant() && !right.IsConstant())
+                return Fail("Two symbols cannot be multiplied", false);
+            const Term& scale = left.IsConstant() ? left : right;
+            long long coefficient = (left.IsConstant() ? right.coefficient : left.coefficient) *
+                                    static_cast<int32_t>(scale.value);
+            if (coefficient > 0xFFFFFFFFLL || coefficient < -0xFFFFFFFFLL)
+                return Fail("Expression must be a constant or a symbol plus a constant", false);
+            if (left.IsConstant()) left.symbol = right.symbol;
+            left.value *= right.value;
+            left.coefficient = coefficient;
+            if (left.IsConstant()) left.symbol = {};
+            return true;
+        }
+
+        // 其余运算只用于常量
+        if (!left.IsConstant() || !right.IsConstant())
+            return Fail("A symbol can only be added or subtracted", false);
+
+        const int32_t a = static_cast<int32_t>(left.value), b = static_cast<int32_t>(right.value);
+        switch (op) {
+            case '/':
+            case '%':
+                if (b == 0) return Fail("Division by zero", false);
+                // 按 64 位计算，避免 INT_MIN / -1 溢出
+                left.value = static_cast<uint32_t>(op == '/' ? static_cast<long long>(a) / b
+                                                             : static_cast<long long>(a) % b);
+                break;
+            case '<':
+            case '>':
+                if (b < 0 || b > 31) return Fail("Shift count out of range", false);
+                left.value = op == '<' ? left.value << b : static_cast<uint32_t>(a >> b);
+                break;
+            case '&': left.value &= right.value; break;
+            case '|': left.value |= right.value; break;
+            case '^': left.value ^= right.value; break;
+        }
+        return true;
+    }
+};
+
+// 整个操作数为 %HI(...) 或 %LO(...) 时去掉外层，返回取的部分
+AddressPart StripHalfModifier(std::string_view& text) {
+    if (text.size() < 5 || text[0] != '%' || text[3] != '(' || text.back() != ')') return AddressPart::Whole;
+    std::string name = toUppercase(std::string(text.substr(1, 2)));
+    if (name != "HI" && name != "LO") return AddressPart::Whole;
+
+    // 第 3 个字符处的括号须与最后的括号配对
+    int depth = 0;
+    for (size_t i = 3; i + 1 < text.size(); i++) {
+        depth += text[i] == '(';
+        depth -= text[i] == ')';
+        if (depth == 0) return AddressPart::Whole;
+    }
+    text = text.substr(4, text.size() - 5);
+    return name == "HI" ? AddressPart::Hi : AddressPart::Lo;
+}
+
+}  // namespace
+
+Operand ParseOperand(const std::string& str) {
+    Operand operand;
+    if (!TryParseOperand(str, operand)) throw ExceptNumberOrSymbol(str);
+    return operand;
+}
+
+bool TryParseOperand(const std::string& str, Operand& operand) {
+    operand = Operand();
+    if (str.empty()) return false;
+
+    // 单个数字或符号：与原来的解析完全一致
+    if (isNumber(str)) {
+        operand.value = toNumber(str);
+        return true;
+    }
+    if (isSymbol(str)) {
+        operand.symbol = str;
+        return true;
+    }
+
+    std::string_view text = str;
+    operand.part = StripHalfModifier(text);
+
+    ExpressionParser parser(text);
+    Term term;
+    if (!parser.Parse(term)) {
+        if (parser.syntax_error) return false;
+        throw ExpressionError(str, parser.message);
+    }
+
+    const int value = static_cast<int32_t>(term.value);
+    if (term.IsConstant()) {
+        operand.value = static_cast<int>(AddressHalf(value, operand.part));
+    } else if (term.coefficient == 1) {
+        operand.symbol = std::string(term.symbol);
+        operand.value = value;
+    } else {
+        throw ExpressionError(str, "Expression must be a constant or a symbol plus a constant");
+    }
+    return true;
+}
+
+bool isOperand(const std::string& str) {
+    if (str.empty()) return false;
+    if (isNumber(str) || isSymbol(str)) return true;
+
+    std::string_view text = str;
+    StripHalfModifier(text);
+    ExpressionParser parser(text);
+    Term term;
+    return parser.Parse(term) || !parser.syntax_error;
+}
+
+void RequireWholeOperand(const Operand& operand, const std::string& str) {
+    if (operand.part != AddressPart::Whole)
+        throw ExpressionError(str, "%HI/%LO can only be used as a 16-bit immediate");
+}
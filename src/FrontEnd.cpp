@@ -0,0 +1,168 @@
+#include <sstream>
+
+#include "Headers.h"
+
+static const size_t kMinChunkBytes = 256 * 1024;   // 每块至少的字节数，避免小文件也启动线程
+
+// 块内扫描出的一行（已去注释、非空）
+struct ScannedLine {
+    int line;              // 块内行号（从 1 开始）
+    bool directive;        // 是否为 .data/.text 段切换指令
+    std::string_view text; // 指向读入缓冲区
+};
+
+// 一个块的扫描结果
+struct ChunkResult {
+    std::vector<ScannedLine> lines;
+    int line_count = 0;    // 块内的行数（前缀和用）
+    bool failed = false;   // 扫描中途出现异常，lines 只含之前的行
+    std::string error;
+};
+
+/*
+ * 整个输入读入一个字符串（文件可以直接按大小读取），从 resource 分配
+ */
+static std::pmr::string ReadAll(std::istream& in, std::pmr::memory_resource* resource) {
+    std::streampos begin = in.tellg();
+    if (begin != std::streampos(-1) && in.seekg(0, std::ios::end)) {
+        std::streampos end = in.tellg();
+        in.seekg(begin);
+        if (end != std::streampos(-1) && end >= begin) {
+            std::pmr::string buffer(static_cast<size_t>(end - begin), '\0', resource);
+            in.read(&buffer[0], buffer.size());
+            buffer.resize(static_cast<size_t>(in.gcount()));
+            return buffer;
+        }
+    }
+    in.clear();
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    return std::pmr::string(buffer.str(), resource);
+}
+
+/*
+ * 扫描 [begin, end) 中的各行
+ * 段切换指令只在这里识别，预留空间与行号相关的异常留到合并时重新处理
+ */
+static void ScanChunk(const char* begin, const char* end, const std::string& input_path,
+                      ChunkResult& result) {
+    SegmentState state = SegmentState::Global;
+    InstructionList reserved_text;
+    DataList reserved_data;
+
+    const char* p = begin;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line_end = newline ? newline : end;
+        const int line = ++result.line_count;
+        std::string_view current_line(p, line_end - p);
+        p = newline ? newline + 1 : end;
+
+        try {
+            std::string_view clean_line = KillComment(current_line);
+            if (clean_line.empty() || clean_line.find_first_not_of(" \t\r\n") == std::string::npos) {
+                continue; // 跳过空行
+            }
+
+            bool directive;
+            try {
+                directive = handleSegmentDirective(clean_line, state, input_path, line,
+                                                   reserved_text, reserved_data);
+            } catch (const std::exception&) {
+                directive = true;   // 匹配成功但参数有误：合并时重新抛出
+            }
+            reserved_text.clear();
+            reserved_data.clear();
+            result.lines.push_back(ScannedLine{line, directive, clean_line});
+        } catch (const std::exception& e) {
+            result.failed = true;
+            result.error = e.what();
+            return;
+        }
+    }
+}
+
+bool ReadSource(std::istream& in,
+                const std::string& input_path,
+                InstructionList& instruction_list,
+                DataList& data_list,
+                unsigned threads) {
+    // 缓冲区与各行文本都从列表的 memory_resource（doAssemble 中为作业的 JobArena）分配
+    const std::pmr::string buffer = ReadAll(in, instruction_list.get_allocator().resource());
+
+    // 按换行切块：每块结束于换行符之后（最后一块结束于文件末尾）
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunk_count = std::max<size_t>(1, std::min<size_t>(threads, buffer.size() / kMinChunkBytes));
+
+    std::vector<std::pair<size_t, size_t>> ranges;
+    size_t start = 0;
+    for (size_t k = 1; k <= chunk_count && start < buffer.size(); k++) {
+        size_t end = buffer.size() * k / chunk_count;
+        if (k < chunk_count) {
+            end = buffer.find('\n', std::max(end, start));
+            end = end == std::string::npos ? buffer.size() : end + 1;
+        }
+        if (end > start) ranges.emplace_back(start, end);
+        start = end;
+    }
+
+    std::vector<ChunkResult> results(ranges.size());
+    {
+        ScopedPhaseTimer timer(StatsPhase::Read);
+        auto scan = [&](size_t k) {
+            ScanChunk(buffer.data() + ranges[k].first, buffer.data() + ranges[k].second,
+                      input_path, results[k]);
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t k = 1; k < ranges.size(); k++) workers.emplace_back(scan, k);
+        if (!ranges.empty()) scan(0);
+        for (auto& worker : workers) worker.join();
+    }
+
+    // 合并：行号取前缀和，段归属按段切换指令依次确定
+    // 代码段通常占绝大多数行，按总行数预留，避免列表反复扩容（在内存区中扩容的旧数组不会被复用）
+    size_t scanned_lines = 0;
+    for (const auto& result : results) scanned_lines += result.lines.size();
+    instruction_list.reserve(instruction_list.size() + scanned_lines);
+
+    SegmentState current_state = SegmentState::Global;
+    int line_base = 0;
+    try {
+        for (auto& result : results) {
+            for (auto& scanned : result.lines) {
+                const int line_counter = line_base + scanned.line;
+
+                // 处理 .data / .text 段切换指令
+                if (scanned.directive) {
+                    handleSegmentDirective(scanned.text, current_state, input_path, line_counter,
+                                           instruction_list, data_list);
+                    continue;
+                }
+
+                // 检查非法行：在定义任何段之前就出现内容
+                if (current_state == SegmentState::Global) {
+                    std::cerr << "Assembler Error: Statement found outside of any segment at " << input_path << ":" << line_counter << std::endl;
+                    return true;
+                }
+
+                // 根据当前状态将行存入对应的待处理列表
+                // 在列表中原地构造，字符串直接从列表的 memory_resource 分配
+                if (current_state == SegmentState::Data) {
+                    Data& d = data_list.emplace_back();
+                    d.file = input_path; d.line = line_counter; d.assembly = scanned.text;
+                } else {
+                    Instruction& inst = instruction_list.emplace_back();
+                    inst.file = input_path; inst.line = line_counter; inst.assembly = scanned.text;
+                }
+            }
+
+            if (result.failed) throw std::runtime_error(result.error);
+            line_base += result.line_count;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Critical Error during parsing: " << e.what() << std::endl;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,177 @@
+#include <filesystem>
+
+#include "Headers.h"
+
+static int DigitValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// .mem 中 @地址 的上限（字地址）：镜像最多 TOTAL_WORDS 个字，留出余量，拒绝明显错误的地址
+const size_t kMaxImageWords = 4 * TOTAL_WORDS;
+
+static bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+// 文件中第 pos 个字符所在的行号，报错用
+static size_t LineOf(std::string_view text, size_t pos) {
+    size_t line = 1;
+    for (size_t i = 0; i < pos && i < text.size(); i++) line += text[i] == '\n';
+    return line;
+}
+
+static bool Fail(std::string_view text, size_t pos, const std::string& message, std::string& error) {
+    error = "line " + std::to_string(LineOf(text, pos)) + ": " + message;
+    return false;
+}
+
+/*
+ * 从 pos 开始解析一个 radix 进制的字，pos 移到数字之后；
+ * 没有数字、含有非法数字或超过 32 位时返回 false
+ */
+static bool ParseWord(std::string_view text, size_t& pos, unsigned radix, uint32_t& word) {
+    uint64_t value = 0;
+    size_t start = pos;
+    for (int v; pos < text.size() && (v = DigitValue(text[pos])) >= 0; pos++) {
+        if (static_cast<unsigned>(v) >= radix) return false;
+        value = value * radix + v;
+        if (value > 0xFFFFFFFFull) return false;
+    }
+    word = static_cast<uint32_t>(value);
+    return pos > start;
+}
+
+static bool ParseCoe(std::string_view text, std::vector<uint32_t>& words, std::string& error) {
+    size_t radix_pos = text.find("memory_initialization_radix");
+    if (radix_pos == std::string_view::npos) return Fail(text, 0, "missing memory_initialization_radix", error);
+    size_t radix_value = text.find_first_of("0123456789", radix_pos);
+    uint32_t radix = 0;
+    if (radix_value == std::string_view::npos || !ParseWord(text, radix_value, 10, radix) ||
+        (radix != 2 && radix != 10 && radix != 16)) {
+        return Fail(text, radix_pos, "unsupported memory_initialization_radix", error);
+    }
+
+    size_t pos = text.find("memory_initialization_vector");
+    if (pos == std::string_view::npos) return Fail(text, 0, "missing memory_initialization_vector", error);
+    pos = text.find('=', pos);
+    if (pos == std::string_view::npos) return Fail(text, text.size(), "missing '='", error);
+    pos++;
+
+    words.clear();
+    words.reserve((text.size() - pos) / (radix == 2 ? 34 : 10) + 1);   // 按每字一行估计
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c == ';') return true;
+        if (c == ',' || IsBlank(c)) {
+            pos++;
+            continue;
+        }
+        uint32_t word;
+        if (!ParseWord(text, pos, radix, word)) return Fail(text, pos, "invalid word", error);
+        words.push_back(word);
+    }
+    return Fail(text, text.size(), "missing ';' at the end of the vector", error);
+}
+
+static bool ParseMem(std::string_view text, std::vector<uint32_t>& words, std::string& error) {
+    words.clear();
+    words.reserve(text.size() / 9 + 1);
+    size_t address = 0;   // 下一个字的字地址
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (IsBlank(c)) {
+            pos++;
+        } else if (c == '/' && pos + 1 < text.size() && text[pos + 1] == '/') {
+            pos = text.find('\n', pos);
+            if (pos == std::string_view::npos) pos = text.size();
+        } else if (c == '@') {
+            uint32_t target;
+            pos++;
+            if (!ParseWord(text, pos, 16, target)) return Fail(text, pos, "invalid address", error);
+            address = target;
+        } else {
+            uint32_t word;
+            if (!ParseWord(text, pos, 16, word) || (pos < text.size() && !IsBlank(text[pos]) && text[pos] != '/'))
+                return Fail(text, pos, "invalid word", error);
+            if (address >= kMaxImageWords) return Fail(text, pos, "address out of range", error);
+            if (address >= words.size()) words.resize(address + 1, 0);
+            words[address++] = word;
+        }
+    }
+    return true;
+}
+
+static bool ParseBin(std::string_view text, std::vector<uint32_t>& words, std::string& error) {
+    if (text.size() % 4 != 0) {
+        error = "size " + std::to_string(text.size()) + " is not a multiple of 4 bytes";
+        return false;
+    }
+    words.resize(text.size() / 4);
+    for (size_t i = 0; i < words.size(); i++) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data()) + 4 * i;
+        words[i] = uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+    }
+    return true;
+}
+
+bool GuessImageFormat(const std::string& path, const std::string& content, ImageFormat& format) {
+    size_t dot = path.find_last_of('.');
+    std::string ext = dot == std::string::npos ? "" : toUppercase(path.substr(dot + 1));
+    if (ext == "COE") format = ImageFormat::Coe;
+    else if (ext == "BIN") format = ImageFormat::Bin;
+    else if (ext == "MEM" || ext == "HEX") format = ImageFormat::Mem;
+    else if (content.find("memory_initialization_vector") != std::string::npos) format = ImageFormat::Coe;
+    else return false;
+    return true;
+}
+
+bool ParseImage(std::string_view content, ImageFormat format, std::vector<uint32_t>& words,
+                std::string& error) {
+    switch (format) {
+        case ImageFormat::Coe: return ParseCoe(content, words, error);
+        case ImageFormat::Bin: return ParseBin(content, words, error);
+        case ImageFormat::Mem: return ParseMem(content, words, error);
+    }
+    return false;
+}
+
+bool ReadImage(const std::string& path, std::vector<uint32_t>& words, std::string& error) {
+    // 目录在 Linux 上可以打开，但长度无意义
+    std::error_code ec;
+    if (std::filesystem::is_directory(path, ec)) {
+        error = path + " is a directory";
+        return false;
+    }
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    // 无法定位的文件 tellg() 返回 -1
+    in.seekg(0, std::ios::end);
+    std::streamoff size = in.tellg();
+    if (!in || size < 0) {
+        error = "cannot read " + path;
+        return false;
+    }
+    std::string content(static_cast<size_t>(size), '\0');
+    in.seekg(0, std::ios::beg);
+    in.read(&content[0], content.size());
+    if (!in) {
+        error = "cannot read " + path;
+        return false;
+    }
+
+    ImageFormat format;
+    if (!GuessImageFormat(path, content, format)) {
+        error = path + ": unknown image format (expected .coe, .bin, .mem or .hex)";
+        return false;
+    }
+    if (!ParseImage(content, format, words, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
@@ -5,7 +5,7 @@
  *    在当前 Instruction 的 machine_code 数组末尾增加一个新的 32 位机器码（初始为 0）
  *    返回指向这个新 machine_code 的迭代器。
  *
- * 多数编码函数首先调用 NewMachineCode，然后再用 SetOP/SetRS 等函数填充字段。
+ * 多数编码函数首先调用 NewMachineCode，分类并检查完操作数后用 EncodeR/EncodeI/EncodeJ 一次写入。
  */
 MachineCodeIt NewMachineCode(Instruction& i) {
     i.machine_code.push_back(0);
@@ -13,108 +13,76 @@ MachineCodeIt NewMachineCode(Instruction& i) {
 }
 
 /*
- * 以下函数操作 32bit MIPS 机器码，利用掩码(mask) 来清除旧字段，再写入新字段。
- * 
- * 各字段的 bit 分布：
- *   OP     (31~26)
- *   RS     (25~21)
- *   RT     (20~16)
- *   RD     (15~11)
- *   Shamt  (10~6)
- *   Func   (5~0)
+ * 操作数范围检查：
+ *   字段本身的移位与掩码见 Encoding.h；这里在操作数分类时检查一次范围，
+ *   超出时抛出 NumberOverflow，之后的编码不再检查。
+ *   大于上限时沿用 “too large” 的提示，小于下限时给出完整范围。
  */
-
-void SetOP(MachineCode& machine_code, unsigned OP) {
-    if (OP >= 64) {  // 6 bit 上限
-        throw NumberOverflow("OP", "63", std::to_string(OP));
+static void CheckRange(long long value, long long min, long long max, const char* name) {
+    if (value > max) throw NumberOverflow(name, std::to_string(max), std::to_string(value));
+    if (value < min) {
+        throw NumberOverflow(name, std::to_string(min), std::to_string(max),
+                             std::to_string(value));
     }
-    // 清除 bit 31-26，然后写入 OP
-    machine_code &= 0b00000011111111111111111111111111;
-    machine_code |= OP << 26;
 }
 
-void SetRS(MachineCode& machine_code, unsigned RS) {
-    if (RS >= 32) {  // 寄存器编号 5 bit
-        throw NumberOverflow("RS", "31", std::to_string(RS));
-    }
-    machine_code &= 0b11111100000111111111111111111111;
-    machine_code |= RS << 21;
+unsigned CheckImmediate(long long value, Extend extend, const char* name) {
+    CheckRange(value, extend == Extend::Sign ? -32768 : 0, 65535, name);
+    return static_cast<unsigned>(value) & ImmediateField::kMax;
 }
 
-void SetRT(MachineCode& machine_code, unsigned RT) {
-    if (RT >= 32) {
-        throw NumberOverflow("RT", "31", std::to_string(RT));
-    }
-    machine_code &= 0b11111111111000001111111111111111;
-    machine_code |= RT << 16;
+unsigned CheckUnsigned(long long value, unsigned width, const char* name) {
+    CheckRange(value, 0, (1LL << width) - 1, name);
+    return static_cast<unsigned>(value);
 }
 
-void SetRD(MachineCode& machine_code, unsigned RD) {
-    if (RD >= 32) {
-        throw NumberOverflow("RD", "31", std::to_string(RD));
-    }
-    machine_code &= 0b11111111111111110000011111111111;
-    machine_code |= RD << 11;
+unsigned CheckSigned(long long value, unsigned width, const char* name) {
+    CheckRange(value, -(1LL << (width - 1)), (1LL << (width - 1)) - 1, name);
+    return static_cast<unsigned>(value) & ((1u << width) - 1);
 }
 
-void SetShamt(MachineCode& machine_code, unsigned shamt) {
-    if (shamt >= 32) {
-        throw NumberOverflow("Shamt", "31", std::to_string(shamt));
-    }
-    machine_code &= 0b11111111111111111111100000111111;
-    machine_code |= shamt << 6;
+unsigned ImmediateOperand(const Operand& operand, Extend extend) {
+    if (operand.part != AddressPart::Whole) return operand.value & ImmediateField::kMax;
+    return CheckImmediate(operand.value, extend);
 }
 
-void SetFunc(MachineCode& machine_code, unsigned func) {
-    if (func >= 64) {  // 6 bit function code
-        throw NumberOverflow("Function code", "31", std::to_string(func));
-    }
-    machine_code &= 0b11111111111111111111111111000000;
-    machine_code |= func << 0;
+unsigned ShamtOperand(const Operand& operand) {
+    return CheckUnsigned(operand.value, ShamtField::kWidth, "Shamt");
 }
 
 /*
- * SetImmediate：
- *    写 I-format 的立即数字段 (bit 15~0)
- *
- * immediate 最终只保留低 16 bit
- * 注意：立即数未做符号扩展，这部分行为由调用者保证。
+ * GetMnemonic：
+ *    取出汇编行的第一个 token（第一个非空白串），即助记符（指令名）
  */
-void SetImmediate(MachineCode& machine_code, int immediate) {
-    // int op = machine_code >> 26;
-    if (immediate >= 65536) {    // 16 bit 极限
-        throw NumberOverflow("Immediate", "65535", std::to_string(immediate));
-    }
-    machine_code &= 0xffff0000;       // 清空低 16 bit
-    machine_code |= (immediate << 0) & 0xffff;
+std::string GetMnemonic(const std::string& assembly) {
+    size_t begin = ScanFirstNot(assembly, 0, kCharSpace);
+    return assembly.substr(begin, ScanFirst(assembly, begin, kCharSpace) - begin);
 }
 
 /*
- * SetAddress：
- *    写 J-format 的地址字段（bit 25~0，共 26 bit）
+ * 操作数之间的一段是否为“空白* 非空白串 空白*”
+ * （首尾的空白是否允许由 leading/trailing 决定）
  */
-void SetAddress(MachineCode& machine_code, unsigned address) {
-    if (address >= 67108864) { // 2^26 = 67,108,864
-        throw NumberOverflow("Address", "67108863", std::to_string(address));
-    }
-    machine_code &= 0b11111100000000000000000000000000;
-    machine_code |= address << 0;
+static bool IsOperandField(const std::string& s, size_t begin, size_t end, bool leading,
+                           bool trailing) {
+    size_t first = leading ? std::min(ScanFirstNot(s, begin, kCharSpace), end) : begin;
+    size_t last = trailing ? ScanLastNot(s, first, end, kCharSpace) : end;
+    return first < last && ScanFirst(s, first, kCharSpace) >= last;
 }
 
-/*
- * GetMnemonic：
- *    使用正则取出汇编行的第一个 token，即助记符（指令名）
- */
-std::string GetMnemonic(const std::string& assembly) {
-    static std::regex re("^\\s*(\\S+)");
-    std::smatch match;
-    std::regex_search(assembly, match, re);
-    return match[1].matched ? match[1].str() : "";
+static std::string TrimField(const std::string& s, size_t begin, size_t end) {
+    size_t first = std::min(ScanFirstNot(s, begin, kCharSpace), end);
+    return s.substr(first, ScanLastNot(s, first, end, kCharSpace) - first);
 }
 
 /*
  * GetOperand：
- *    利用三个不同正则表达式匹配 3/2/1 个操作数
+ *    按 3/2/1 个操作数依次尝试，与原来的三个正则语义一致：
+ *      \s*\S+\s+(\S+)\s*,\s*(\S+)\s*,\s*(\S+)
+ *      \s*\S+\s+(\S+)\s*,\s*(\S+)
+ *      \s*\S+\s+(\S+)
+ *    整行匹配，操作数本身不含空白但可以含逗号；有多种分法时取贪婪匹配的结果，
+ *    即靠前的操作数尽量长（分隔用的逗号尽量靠后）。
  *
  * 示例：
  *   "add $t1, $t2, $t3" -> op1="$t1", op2="$t2", op3="$t3"
@@ -123,40 +91,45 @@ std::string GetMnemonic(const std::string& assembly) {
  */
 void GetOperand(const std::string& assembly, std::string& op1, std::string& op2,
                 std::string& op3) {
-    static std::regex re_3("\\s*\\S+\\s+(\\S+)\\s*,\\s*(\\S+)\\s*,\\s*(\\S+)",
-                           std::regex::icase),  // 3 操作数
-        re_2("\\s*\\S+\\s+(\\S+)\\s*,\\s*(\\S+)",
-             std::regex::icase),                // 2 操作数
-        re_1("\\s*\\S+\\s+(\\S+)", std::regex::icase);  // 1 操作数
-
-    std::smatch match;
+    op1 = op2 = op3 = "";
+
+    // 助记符之后必须有空白，操作数从其后第一个非空白字符开始
+    const size_t n = assembly.size();
+    size_t mnemonic = ScanFirstNot(assembly, 0, kCharSpace);
+    size_t gap = ScanFirst(assembly, mnemonic, kCharSpace);
+    size_t begin = ScanFirstNot(assembly, gap, kCharSpace);
+    if (mnemonic == n || begin == n) return;
+
+    std::vector<size_t> commas;
+    for (size_t c = ScanFirst(assembly, begin, kCharComma); c < n;
+         c = ScanFirst(assembly, c + 1, kCharComma)) {
+        commas.push_back(c);
+    }
 
     // ----- 三操作数 -----
-    std::regex_match(assembly, match, re_3);
-    if (!match.empty()) {
-        op1 = match[1].str();
-        op2 = match[2].str();
-        op3 = match[3].str();
-        return;
+    for (size_t i = commas.size(); i-- > 1;) {
+        if (!IsOperandField(assembly, begin, commas[i - 1], false, true)) continue;
+        for (size_t j = commas.size(); j-- > i;) {
+            if (IsOperandField(assembly, commas[i - 1] + 1, commas[j], true, true) &&
+                IsOperandField(assembly, commas[j] + 1, n, true, false)) {
+                op1 = TrimField(assembly, begin, commas[i - 1]);
+                op2 = TrimField(assembly, commas[i - 1] + 1, commas[j]);
+                op3 = TrimField(assembly, commas[j] + 1, n);
+                return;
+            }
+        }
     }
 
     // ----- 二操作数 -----
-    op3 = "";
-    std::regex_match(assembly, match, re_2);
-    if (!match.empty()) {
-        op1 = match[1].str();
-        op2 = match[2].str();
-        return;
+    for (size_t i = commas.size(); i-- > 0;) {
+        if (IsOperandField(assembly, begin, commas[i], false, true) &&
+            IsOperandField(assembly, commas[i] + 1, n, true, false)) {
+            op1 = TrimField(assembly, begin, commas[i]);
+            op2 = TrimField(assembly, commas[i] + 1, n);
+            return;
+        }
     }
 
     // ----- 一操作数 -----
-    op2 = "";
-    std::regex_match(assembly, match, re_1);
-    if (!match.empty()) {
-        op1 = match[1].str();
-        return;
-    }
-
-    // ----- 没有参数 -----
-    op1 = "";
+    if (IsOperandField(assembly, begin, n, false, false)) op1 = assembly.substr(begin);
 }
\ No newline at end of file
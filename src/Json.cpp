@@ -0,0 +1,302 @@
+#include <cmath>
+
+#include "Headers.h"
+
+Json Json::MakeArray() {
+    Json value;
+    value.type = Type::Array;
+    return value;
+}
+
+Json Json::MakeObject() {
+    Json value;
+    value.type = Type::Object;
+    return value;
+}
+
+const std::string& Json::AsString() const {
+    static const std::string empty;
+    return type == Type::String ? string_value : empty;
+}
+
+bool Json::Has(const std::string& key) const {
+    for (const auto& item : object_items) {
+        if (item.first == key) return true;
+    }
+    return false;
+}
+
+const Json& Json::operator[](const std::string& key) const {
+    static const Json null_value;
+    for (const auto& item : object_items) {
+        if (item.first == key) return item.second;
+    }
+    return null_value;
+}
+
+Json& Json::operator[](const std::string& key) {
+    if (type == Type::Null) type = Type::Object;
+    for (auto& item : object_items) {
+        if (item.first == key) return item.second;
+    }
+    object_items.emplace_back(key, Json());
+    return object_items.back().second;
+}
+
+void Json::Push(Json value) {
+    if (type == Type::Null) type = Type::Array;
+    array_items.push_back(std::move(value));
+}
+
+/*
+ * 序列化
+ */
+static void DumpString(const std::string& s, std::string& out) {
+    static const char* const hex = "0123456789abcdef";
+    out += '"';
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    out += '"';
+}
+
+void Json::Dump(std::string& out) const {
+    switch (type) {
+        case Type::Null: out += "null"; break;
+        case Type::Bool: out += bool_value ? "true" : "false"; break;
+        case Type::Number: {
+            double integral;
+            if (std::modf(number_value, &integral) == 0.0 && std::fabs(number_value) < 1e15) {
+                out += std::to_string(static_cast<long long>(number_value));
+            } else {
+                char buf[32];
+                std::snprintf(buf, sizeof(buf), "%.17g", number_value);
+                out += buf;
+            }
+            break;
+        }
+        case Type::String: DumpString(string_value, out); break;
+        case Type::Array:
+            out += '[';
+            for (size_t i = 0; i < array_items.size(); i++) {
+                if (i) out += ',';
+                array_items[i].Dump(out);
+            }
+            out += ']';
+            break;
+        case Type::Object:
+            out += '{';
+            for (size_t i = 0; i < object_items.size(); i++) {
+                if (i) out += ',';
+                DumpString(object_items[i].first, out);
+                out += ':';
+                object_items[i].second.Dump(out);
+            }
+            out += '}';
+            break;
+    }
+}
+
+std::string Json::Dump() const {
+    std::string out;
+    Dump(out);
+    return out;
+}
+
+/*
+ * JsonParser：递归下降解析
+ */
+class JsonParser {
+   public:
+    explicit JsonParser(const std::string& text) : text(text) {}
+
+    bool ParseDocument(Json& out) {
+        if (!ParseValue(out, 0)) return false;
+        SkipSpace();
+        return pos == text.size();
+    }
+
+   private:
+    const std::string& text;
+    size_t pos = 0;
+
+    static const int kMaxDepth = 256;
+
+    void SkipSpace() {
+        while (pos < text.size() &&
+               (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r'))
+            pos++;
+    }
+
+    bool Consume(const char* literal) {
+        size_t len = std::strlen(literal);
+        if (text.compare(pos, len, literal) != 0) return false;
+        pos += len;
+        return true;
+    }
+
+    bool ParseValue(Json& out, int depth) {
+        if (depth > kMaxDepth) return false;
+        SkipSpace();
+        if (pos >= text.size()) return false;
+
+        char c = text[pos];
+        if (c == '{') return ParseObject(out, depth);
+        if (c == '[') return ParseArray(out, depth);
+        if (c == '"') {
+            out = Json(std::string());
+            return ParseString(out.string_value);
+        }
+        if (Consume("true")) { out = Json(true); return true; }
+        if (Consume("false")) { out = Json(false); return true; }
+        if (Consume("null")) { out = Json(); return true; }
+        return ParseNumber(out);
+    }
+
+    bool ParseNumber(Json& out) {
+        const char* begin = text.c_str() + pos;
+        char* end = nullptr;
+        double value = std::strtod(begin, &end);
+        if (end == begin) return false;
+        pos += end - begin;
+        out = Json(value);
+        return true;
+    }
+
+    static void AppendUtf8(std::string& out, unsigned cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool ParseHex4(unsigned& value) {
+        if (pos + 4 > text.size()) return false;
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = text[pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    bool ParseString(std::string& out) {
+        pos++;  // 跳过 "
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) return false;
+            char e = text[pos++];
+            switch (e) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned cp;
+                    if (!ParseHex4(cp)) return false;
+                    // 代理对
+                    if (cp >= 0xD800 && cp < 0xDC00 && text.compare(pos, 2, "\\u") == 0) {
+                        pos += 2;
+                        unsigned low;
+                        if (!ParseHex4(low) || low < 0xDC00 || low >= 0xE000) return false;
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    AppendUtf8(out, cp);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+
+    bool ParseArray(Json& out, int depth) {
+        out = Json::MakeArray();
+        pos++;  // [
+        SkipSpace();
+        if (pos < text.size() && text[pos] == ']') {
+            pos++;
+            return true;
+        }
+        while (true) {
+            Json item;
+            if (!ParseValue(item, depth + 1)) return false;
+            out.array_items.push_back(std::move(item));
+            SkipSpace();
+            if (pos >= text.size()) return false;
+            if (text[pos] == ',') { pos++; continue; }
+            if (text[pos] == ']') { pos++; return true; }
+            return false;
+        }
+    }
+
+    bool ParseObject(Json& out, int depth) {
+        out = Json::MakeObject();
+        pos++;  // {
+        SkipSpace();
+        if (pos < text.size() && text[pos] == '}') {
+            pos++;
+            return true;
+        }
+        while (true) {
+            SkipSpace();
+            if (pos >= text.size() || text[pos] != '"') return false;
+            std::string key;
+            if (!ParseString(key)) return false;
+            SkipSpace();
+            if (pos >= text.size() || text[pos] != ':') return false;
+            pos++;
+            Json value;
+            if (!ParseValue(value, depth + 1)) return false;
+            out.object_items.emplace_back(std::move(key), std::move(value));
+            SkipSpace();
+            if (pos >= text.size()) return false;
+            if (text[pos] == ',') { pos++; continue; }
+            if (text[pos] == '}') { pos++; return true; }
+            return false;
+        }
+    }
+};
+
+bool Json::Parse(const std::string& text, Json& out) {
+    JsonParser parser(text);
+    return parser.ParseDocument(out);
+}
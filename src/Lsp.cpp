@@ -0,0 +1,952 @@
+#include <optional>
+#include <sstream>
+#include <unordered_set>
+
+#include "Headers.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+/*
+ * ---- UTF-16 列号与字节偏移的转换（LSP 的列号以 UTF-16 码元计） ----
+ */
+static size_t Utf8Length(unsigned char c) {
+    if (c < 0x80) return 1;
+    if ((c >> 5) == 0x6) return 2;
+    if ((c >> 4) == 0xE) return 3;
+    if ((c >> 3) == 0x1E) return 4;
+    return 1;
+}
+
+static size_t ByteOffset(const std::string& line, unsigned character) {
+    size_t i = 0;
+    unsigned units = 0;
+    while (i < line.size() && units < character) {
+        size_t len = Utf8Length(line[i]);
+        units += len == 4 ? 2 : 1;
+        i += len;
+    }
+    return std::min(i, line.size());
+}
+
+static unsigned Utf16Column(const std::string& line, size_t byte) {
+    unsigned units = 0;
+    for (size_t i = 0; i < byte && i < line.size();) {
+        size_t len = Utf8Length(line[i]);
+        units += len == 4 ? 2 : 1;
+        i += len;
+    }
+    return units;
+}
+
+// 不区分大小写地查找 token（token 已是大写，局部 Label 的 .l 见 toCanonicalCase）
+static size_t FindToken(const std::string& text, const std::string& token, size_t limit) {
+    if (token.empty() || token.size() > limit) return std::string::npos;
+    for (size_t i = 0; i + token.size() <= limit; i++) {
+        size_t k = 0;
+        while (k < token.size() && std::toupper(static_cast<unsigned char>(text[i + k])) ==
+                                      std::toupper(static_cast<unsigned char>(token[k])))
+            k++;
+        if (k == token.size()) return i;
+    }
+    return std::string::npos;
+}
+
+static bool IsSymbolChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '$';
+}
+
+/*
+ * ---- 文档模型 ----
+ */
+
+// 一行按代码段或数据段编码的结果
+struct LineResult {
+    bool error = false;
+    std::string message;
+    std::string token;     // 出错的源文本片段
+    std::string label;
+    std::vector<MachineCode> machine_code;
+    std::vector<std::uint8_t> raw_data;
+    std::vector<RelocationTemplate> relocations;
+    std::string warnings;
+};
+
+struct Diagnostic {
+    size_t line;        // 保存在行中时不填，发布时按行号填写
+    size_t start, end;  // 字节偏移
+    int severity;       // 1 错误，2 警告
+    std::string message;
+};
+
+struct DocumentLine;
+
+// 全局符号：定义所在的行与引用它的行（行对象的地址在插入、删除行时不变）
+struct SymbolEntry {
+    DocumentLine* definition = nullptr;    // 第一次定义
+    unsigned count = 0;                    // 定义的次数，大于 1 时其余的定义报 Redefined symbol
+    std::vector<DocumentLine*> referrers;  // 一行引用多次时出现多次
+};
+
+struct DocumentLine {
+    enum class Kind { Blank, Directive, Statement };
+
+    std::string text;
+    bool scanned = false;
+
+    // 以下由 Scan 填写，只与本行文本有关
+    Kind kind = Kind::Blank;
+    std::string clean;                 // 去掉注释后的文本
+    SegmentState directive_state = SegmentState::Global;
+    unsigned reserve = 0;              // 段切换指令预留的字节数
+    std::string directive_error;
+
+    // 按所在的段编码，修改后作废
+    std::optional<LineResult> as_text;
+    std::optional<LineResult> as_data;
+
+    // 以下由全局扫描填写，修改其他行时增量更新
+    SegmentState segment = SegmentState::Global;
+    unsigned address = 0;
+    unsigned moved = 0;                                        // 最近一次随修改整体移动的编号
+    SymbolEntry* defines = nullptr;                            // 本行是这个全局 Label 的定义
+    std::vector<SymbolEntry*> symbols;                         // 按 relocations 下标，局部引用为 nullptr
+    std::vector<std::pair<unsigned, unsigned>> local_targets;  // 局部引用：relocations 下标 -> 目标地址
+    bool pending = false;                                      // 已加入待重新检查的列表
+
+    // 诊断：本行自身的（段、编码、警告、重定义），局部 Label 解析的，符号回填的
+    std::vector<Diagnostic> diagnostics;
+    std::vector<Diagnostic> local_diagnostics;
+    std::vector<Diagnostic> reference_diagnostics;
+};
+
+// 对局部 Label 的一处引用：所在行与 relocations 下标
+struct LocalReference {
+    DocumentLine* line;
+    unsigned relocation;
+};
+
+class Document {
+   public:
+    Document() { core.SetQuiet(true); }
+
+    void SetText(const std::string& text) {
+        lines.clear();
+        size_t begin = 0;
+        while (true) {
+            size_t end = text.find('\n', begin);
+            auto line = std::make_unique<DocumentLine>();
+            line->text = text.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+            lines.push_back(std::move(line));
+            if (end == std::string::npos) break;
+            begin = end + 1;
+        }
+        rebuild = true;
+    }
+
+    // 应用一次修改：带 range 的增量修改，或整篇替换
+    void ApplyChange(const Json& change) {
+        if (!change.Has("range")) {
+            SetText(change["text"].AsString());
+            return;
+        }
+        const Json& range = change["range"];
+        size_t start_line = Clamp(range["start"]["line"].AsInt());
+        size_t end_line = Clamp(range["end"]["line"].AsInt());
+        if (end_line < start_line) std::swap(start_line, end_line);
+
+        const std::string& first = lines[start_line]->text;
+        const std::string& last = lines[end_line]->text;
+        size_t start = ByteOffset(first, range["start"]["character"].AsInt());
+        size_t end = ByteOffset(last, range["end"]["character"].AsInt());
+
+        std::string merged = first.substr(0, start) + change["text"].AsString() + last.substr(end);
+
+        std::vector<std::unique_ptr<DocumentLine>> replacement;
+        size_t begin = 0;
+        while (true) {
+            size_t pos = merged.find('\n', begin);
+            auto line = std::make_unique<DocumentLine>();
+            line->text = merged.substr(begin, pos == std::string::npos ? std::string::npos : pos - begin);
+            replacement.push_back(std::move(line));
+            if (pos == std::string::npos) break;
+            begin = pos + 1;
+        }
+
+        // 只改动一行且内容不变时保留原来的解析结果
+        if (replacement.size() == 1 && start_line == end_line &&
+            replacement[0]->text == lines[start_line]->text)
+            return;
+
+        // 被替换的行留到 Update 结束，以便从符号表中注销
+        std::vector<std::unique_ptr<DocumentLine>> removed(
+            std::make_move_iterator(lines.begin() + start_line),
+            std::make_move_iterator(lines.begin() + end_line + 1));
+        const size_t count = replacement.size();
+        if (count == removed.size()) {
+            std::move(replacement.begin(), replacement.end(), lines.begin() + start_line);
+        } else {
+            lines.erase(lines.begin() + start_line, lines.begin() + end_line + 1);
+            lines.insert(lines.begin() + start_line, std::make_move_iterator(replacement.begin()),
+                         std::make_move_iterator(replacement.end()));
+        }
+        if (!rebuild && !Update(start_line, count, removed)) rebuild = true;
+    }
+
+    // 返回所有诊断；需要时先做一次完整的全局扫描
+    std::vector<Diagnostic> Analyze() {
+        if (rebuild) Rebuild();
+        rebuild = false;
+
+        // 只按行对象的地址查找有诊断的行，不访问其余的行
+        std::vector<Diagnostic> result;
+        size_t found = 0;
+        for (size_t i = 0; i < lines.size() && found < flagged.size(); i++) {
+            if (flagged.count(lines[i].get()) == 0) continue;
+            found++;
+            const DocumentLine& line = *lines[i];
+            for (const auto* list : {&line.diagnostics, &line.local_diagnostics, &line.reference_diagnostics}) {
+                for (const Diagnostic& d : *list) {
+                    result.push_back(d);
+                    result.back().line = i;
+                }
+            }
+        }
+        return result;
+    }
+
+    Json Hover(size_t line_number, unsigned character) {
+        if (line_number >= lines.size()) return Json();
+        const DocumentLine& line = *lines[line_number];
+        std::ostringstream text;
+
+        // 光标处的符号
+        std::string word = WordAt(line.text, ByteOffset(line.text, character));
+        auto symbol = symbols.find(word);
+        if (symbol != symbols.end() && symbol->second.definition) {
+            const DocumentLine& target = *symbol->second.definition;
+            text << "`" << word << "` = 0x" << std::hex << std::setw(8) << std::setfill('0')
+                 << target.address << std::dec << " ("
+                 << (target.segment == SegmentState::Data ? "data" : "text") << ")\n\n";
+        }
+
+        if (line.kind == DocumentLine::Kind::Statement) {
+            const std::optional<LineResult>& result =
+                line.segment == SegmentState::Text ? line.as_text : line.as_data;
+            if (result && !result->error && line.segment == SegmentState::Text &&
+                !result->machine_code.empty()) {
+                std::vector<MachineCode> words = Resolved(line, *result);
+                text << "```\n";
+                for (size_t k = 0; k < words.size(); k++) {
+                    text << std::hex << std::setfill('0') << "0x" << std::setw(8)
+                         << line.address + 4 * k << ": " << std::setw(8) << words[k] << std::dec
+                         << "  " << std::bitset<32>(words[k]) << "\n";
+                }
+                text << "```";
+            } else if (result && !result->error && line.segment == SegmentState::Data &&
+                       !result->raw_data.empty()) {
+                text << "```\n" << std::hex << std::setfill('0') << "0x" << std::setw(8)
+                     << line.address << ":";
+                for (size_t k = 0; k < result->raw_data.size() && k < 64; k++) {
+                    text << " " << std::setw(2) << unsigned(result->raw_data[k]);
+                }
+                if (result->raw_data.size() > 64) text << " ...";
+                text << std::dec << "\n(" << result->raw_data.size() << " bytes)\n```";
+            }
+        }
+
+        if (text.str().empty()) return Json();
+        Json hover;
+        hover["contents"]["kind"] = "markdown";
+        hover["contents"]["value"] = text.str();
+        return hover;
+    }
+
+    Json Definition(const std::string& uri, size_t line_number, unsigned character) const {
+        if (line_number >= lines.size()) return Json();
+        const std::string& text = lines[line_number]->text;
+        auto symbol = symbols.find(WordAt(text, ByteOffset(text, character)));
+        if (symbol == symbols.end() || !symbol->second.definition) return Json();
+
+        // 行号只在这里需要，按行对象查找
+        size_t target_line = 0;
+        while (target_line < lines.size() && lines[target_line].get() != symbol->second.definition)
+            target_line++;
+        const DocumentLine& target = *symbol->second.definition;
+        size_t start = FindToken(target.text, symbol->first, target.clean.size());
+        if (start == std::string::npos) start = 0;
+
+        Json location;
+        location["uri"] = uri;
+        location["range"] = Range(target_line, target.text, start, start + symbol->first.size());
+        return location;
+    }
+
+    static Json Range(size_t line, const std::string& text, size_t start, size_t end) {
+        Json range;
+        range["start"]["line"] = static_cast<unsigned>(line);
+        range["start"]["character"] = Utf16Column(text, start);
+        range["end"]["line"] = static_cast<unsigned>(line);
+        range["end"]["character"] = Utf16Column(text, end);
+        return range;
+    }
+
+    const std::string& LineText(size_t line) const { return lines[line]->text; }
+
+   private:
+    std::vector<std::unique_ptr<DocumentLine>> lines;
+    std::unordered_map<std::string, SymbolEntry> symbols;  // 也保存只被引用、尚未定义的名字
+    std::unordered_set<const DocumentLine*> flagged;        // 有诊断的行
+    bool rebuild = true;                                    // 下次 Analyze 做完整的全局扫描
+    unsigned shifts = 0;                                    // 整体移动的次数，用作 DocumentLine::moved
+    AssemblerCore core;
+
+    size_t Clamp(int line) const {
+        if (line < 0) return 0;
+        return std::min(static_cast<size_t>(line), lines.size() - 1);
+    }
+
+    static std::string WordAt(const std::string& text, size_t pos) {
+        size_t begin = pos, end = pos;
+        while (begin > 0 && IsSymbolChar(text[begin - 1])) begin--;
+        while (end < text.size() && IsSymbolChar(text[end])) end++;
+        return toCanonicalCase(text.substr(begin, end - begin));
+    }
+
+    static bool IsTextStatement(const DocumentLine& line) {
+        return line.kind == DocumentLine::Kind::Statement && line.segment == SegmentState::Text;
+    }
+
+    static const LineResult* Result(const DocumentLine& line) {
+        if (line.kind != DocumentLine::Kind::Statement) return nullptr;
+        if (line.segment == SegmentState::Text) return line.as_text ? &*line.as_text : nullptr;
+        if (line.segment == SegmentState::Data) return line.as_data ? &*line.as_data : nullptr;
+        return nullptr;
+    }
+
+    // 本行在所在段中占用的字节数
+    static unsigned Size(const DocumentLine& line) {
+        if (line.kind == DocumentLine::Kind::Directive) return line.reserve;
+        const LineResult* result = Result(line);
+        if (result == nullptr) return 0;
+        return line.segment == SegmentState::Text ? 4 * result->machine_code.size()
+                                                  : result->raw_data.size();
+    }
+
+    // 本行定义的全局 Label（没有时为空）
+    static std::string GlobalLabel(const DocumentLine& line) {
+        const LineResult* result = Result(line);
+        if (result == nullptr || result->label.empty() || isLocalLabel(result->label)) return {};
+        return result->label;
+    }
+
+    // 代码段中的全局 Label 开始一个新的函数作用域
+    static bool OpensScope(const DocumentLine& line) {
+        return IsTextStatement(line) && !GlobalLabel(line).empty();
+    }
+
+    // 修改本行会影响局部 Label 的解析：代码段中带 Label（全局 Label 划分作用域）或引用局部 Label
+    static bool AffectsLocalScope(const DocumentLine& line) {
+        if (!IsTextStatement(line)) return false;
+        if (!line.as_text->label.empty()) return true;
+        for (const auto& relocation : line.as_text->relocations)
+            if (isLocalReference(relocation.symbol)) return true;
+        return false;
+    }
+
+    // 诊断修改后更新 flagged
+    void Flag(const DocumentLine& line) {
+        if (line.diagnostics.empty() && line.local_diagnostics.empty() && line.reference_diagnostics.empty())
+            flagged.erase(&line);
+        else
+            flagged.insert(&line);
+    }
+
+    // 本行的引用都是分支的相对偏移：与目标一起移动时回填结果不变
+    static bool RelativeOnly(const DocumentLine& line) {
+        for (const auto& relocation : line.as_text->relocations) {
+            const OpcodeInfo* info = DecodeOpcode(line.as_text->machine_code[relocation.index]);
+            if (info == nullptr || info->fixup != Fixup::Rel16) return false;
+        }
+        return true;
+    }
+
+    static void MarkPending(DocumentLine& line, std::vector<DocumentLine*>& pending) {
+        if (line.pending) return;
+        line.pending = true;
+        pending.push_back(&line);
+    }
+
+    // 只与本行文本有关的预处理：去注释、识别段切换指令
+    void Scan(DocumentLine& line) {
+        line.scanned = true;
+        line.as_text.reset();
+        line.as_data.reset();
+        line.clean = KillComment(line.text);
+        if (line.clean.find_first_not_of(" \t\r\n") == std::string::npos) {
+            line.kind = DocumentLine::Kind::Blank;
+            return;
+        }
+
+        SegmentState state = SegmentState::Global;
+        InstructionList reserved_text;
+        DataList reserved_data;
+        line.reserve = 0;
+        line.directive_error.clear();
+        try {
+            if (!handleSegmentDirective(line.clean, state, "", 0, reserved_text, reserved_data)) {
+                line.kind = DocumentLine::Kind::Statement;
+                return;
+            }
+        } catch (const std::exception& e) {
+            line.directive_error = e.what();  // .text 预留空间未对齐
+        }
+        line.kind = DocumentLine::Kind::Directive;
+        line.directive_state = state;
+        if (!reserved_text.empty()) line.reserve = 4 * reserved_text[0].machine_code.size();
+        if (!reserved_data.empty()) line.reserve = reserved_data[0].raw_data.size();
+    }
+
+    // 按段编码一行（结果缓存在行中）
+    LineResult& Encode(DocumentLine& line, SegmentState segment) {
+        std::optional<LineResult>& slot = segment == SegmentState::Text ? line.as_text : line.as_data;
+        if (slot) return *slot;
+
+        LineResult result;
+        std::ostringstream warnings;
+        std::ostream* previous_diag = SetDiagStream(&warnings);
+        SymbolMap local_symbols;
+        core.SetCurrentAddress(0);
+
+        if (segment == SegmentState::Text) {
+            Instruction instruction;
+            instruction.assembly = line.clean;
+            instruction.line = 0;
+            UnsolvedSymbolMap refs(local_symbols);
+            result.error = core.ProcessInstruction(instruction, refs, local_symbols, &result.label);
+            for (const auto& relocation : refs) {
+                result.relocations.push_back(RelocationTemplate{
+                    static_cast<unsigned>(relocation.ref.machine_code_handle -
+                                          instruction.machine_code.begin()),
+                    std::string(local_symbols.Names().Name(relocation.symbol)), relocation.addend});
+            }
+            for (const auto& local : refs.Locals()) {
+                result.relocations.push_back(RelocationTemplate{
+                    static_cast<unsigned>(local.ref.machine_code_handle - instruction.machine_code.begin()),
+                    local.symbol, local.addend});
+            }
+            result.machine_code.assign(instruction.machine_code.begin(), instruction.machine_code.end());
+        } else {
+            Data data;
+            data.assembly = line.clean;
+            data.line = 0;
+            result.error = core.ProcessData(data, local_symbols, &result.label);
+            result.raw_data.assign(data.raw_data.begin(), data.raw_data.end());
+        }
+
+        SetDiagStream(previous_diag);
+        if (result.error) {
+            result.message = core.LastError();
+            result.token = core.LastErrorToken();
+        }
+        result.warnings = warnings.str();
+        slot = std::move(result);
+        return *slot;
+    }
+
+    // 按所在的段编码一行，并记下只与本行有关的诊断
+    void EncodeLine(DocumentLine& line) {
+        if (line.kind != DocumentLine::Kind::Statement) return;
+        if (line.segment == SegmentState::Global) {
+            AddStatementDiagnostic(line.diagnostics, line, 1, "Statement found outside of any segment");
+            return;
+        }
+        const LineResult& result = Encode(line, line.segment);
+        if (result.error) AddTokenDiagnostic(line.diagnostics, line, 1, result.message, result.token);
+        if (!result.warnings.empty()) {
+            std::string message = result.warnings;
+            while (!message.empty() && (message.back() == '\n' || message.back() == ' '))
+                message.pop_back();
+            AddStatementDiagnostic(line.diagnostics, line, 2, message);
+        }
+    }
+
+    // 登记本行定义的全局 Label：已有定义时报 Redefined symbol（先数据段后代码段，与命令行一致）
+    void Define(DocumentLine& line) {
+        std::string label = GlobalLabel(line);
+        if (label.empty()) return;
+        SymbolEntry& entry = symbols[label];
+        entry.count++;
+        if (entry.definition) {
+            AddTokenDiagnostic(line.diagnostics, line, 1, "Redefined symbol: " + label, label);
+            return;
+        }
+        entry.definition = &line;
+        line.defines = &entry;
+    }
+
+    // 登记本行对全局符号的引用
+    void AddReferences(DocumentLine& line) {
+        line.symbols.clear();
+        if (!IsTextStatement(line)) return;
+        for (const auto& relocation : line.as_text->relocations) {
+            if (isLocalReference(relocation.symbol)) {
+                line.symbols.push_back(nullptr);
+                continue;
+            }
+            SymbolEntry& entry = symbols[relocation.symbol];
+            entry.referrers.push_back(&line);
+            line.symbols.push_back(&entry);
+        }
+    }
+
+    // 既没有定义也没有引用的名字从表中删除
+    void EraseIfUnused(const std::string& name) {
+        auto it = symbols.find(name);
+        if (it != symbols.end() && it->second.count == 0 && it->second.referrers.empty()) symbols.erase(it);
+    }
+
+    void RemoveReferences(DocumentLine& line) {
+        for (size_t k = 0; k < line.symbols.size(); k++) {
+            SymbolEntry* entry = line.symbols[k];
+            if (entry == nullptr) continue;
+            auto& referrers = entry->referrers;
+            referrers.erase(std::find(referrers.begin(), referrers.end(), &line));
+            EraseIfUnused(line.as_text->relocations[k].symbol);
+        }
+        line.symbols.clear();
+    }
+
+    // 注销本行定义的全局 Label，引用它的行等待重新检查
+    void RemoveDefinition(DocumentLine& line, std::vector<DocumentLine*>& pending) {
+        std::string label = GlobalLabel(line);
+        if (label.empty()) return;
+        SymbolEntry& entry = symbols[label];
+        entry.count--;
+        if (line.defines) {
+            entry.definition = nullptr;
+            for (DocumentLine* referrer : entry.referrers) MarkPending(*referrer, pending);
+            line.defines = nullptr;
+        }
+        EraseIfUnused(label);
+    }
+
+    // 完整的全局扫描：计算地址、重建符号表、解析局部 Label、检查所有符号引用
+    void Rebuild() {
+        symbols.clear();
+        std::vector<DocumentLine*> data_lines, text_lines;
+        SegmentState state = SegmentState::Global;
+        unsigned data_address = 0, text_address = 0;
+
+        for (auto& pointer : lines) {
+            DocumentLine& line = *pointer;
+            if (!line.scanned) Scan(line);
+            line.defines = nullptr;
+            line.symbols.clear();
+            line.local_targets.clear();
+            line.diagnostics.clear();
+            line.local_diagnostics.clear();
+            line.reference_diagnostics.clear();
+
+            if (line.kind == DocumentLine::Kind::Directive) {
+                state = line.directive_state;
+                if (!line.directive_error.empty())
+                    AddStatementDiagnostic(line.diagnostics, line, 1, line.directive_error);
+            }
+            unsigned* address = state == SegmentState::Data   ? &data_address
+                                : state == SegmentState::Text ? &text_address
+                                                              : nullptr;
+            line.segment = state;
+            line.address = address ? *address : 0;
+            EncodeLine(line);
+            if (address) *address += Size(line);
+            if (line.kind == DocumentLine::Kind::Statement && address)
+                (state == SegmentState::Data ? data_lines : text_lines).push_back(&line);
+        }
+
+        for (DocumentLine* line : data_lines) Define(*line);
+        for (DocumentLine* line : text_lines) Define(*line);
+        for (DocumentLine* line : text_lines) AddReferences(*line);
+
+        std::vector<DocumentLine*> pending;
+        ResolveLocalLabels(0, lines.size(), pending);
+        for (DocumentLine* line : pending) line->pending = false;
+        for (DocumentLine* line : text_lines) CheckReferences(*line);
+
+        flagged.clear();
+        for (const auto& line : lines) Flag(*line);
+    }
+
+    /*
+     * 增量更新：lines[first, first + count) 替换了 removed。
+     * 修改不涉及段切换指令、也不涉及重复定义的全局 Label 时：
+     *   - 只编码新的行，之后同一段中的行地址加上长度差 delta
+     *   - 只重新检查目标地址变化了的引用（引用被移动的 Label 的行、引用新增/删除的 Label 的行）
+     *   - 局部 Label 只在修改所在的函数（前后两个全局 Label 之间）内重新解析
+     * 其余情况返回 false，由下次 Analyze 做完整的全局扫描
+     */
+    bool Update(size_t first, size_t count, std::vector<std::unique_ptr<DocumentLine>>& removed) {
+        const SegmentState segment = removed[0]->segment;
+        const unsigned start_address = removed[0]->address;
+
+        // 段切换指令改变之后所有行的段与地址
+        for (size_t i = first; i < first + count; i++) {
+            Scan(*lines[i]);
+            if (lines[i]->kind == DocumentLine::Kind::Directive) return false;
+        }
+        for (const auto& line : removed)
+            if (line->kind == DocumentLine::Kind::Directive) return false;
+
+        // 重复定义的全局 Label 哪一个生效与先后有关
+        std::vector<std::string> removed_labels, added_labels;
+        for (const auto& line : removed) {
+            std::string label = GlobalLabel(*line);
+            if (label.empty()) continue;
+            if (line->defines && line->defines->count > 1) return false;
+            removed_labels.push_back(label);
+        }
+        for (size_t i = first; i < first + count; i++) {
+            DocumentLine& line = *lines[i];
+            line.segment = segment;
+            EncodeLine(line);
+            std::string label = GlobalLabel(line);
+            if (label.empty()) continue;
+            if (std::find(added_labels.begin(), added_labels.end(), label) != added_labels.end())
+                return false;
+            auto it = symbols.find(label);
+            if (it != symbols.end() &&
+                it->second.count > std::count(removed_labels.begin(), removed_labels.end(), label))
+                return false;
+            added_labels.push_back(label);
+        }
+
+        std::vector<DocumentLine*> pending;
+        bool rescope = false;
+        unsigned old_size = 0, new_size = 0;
+        for (const auto& line : removed) {
+            old_size += Size(*line);
+            rescope |= AffectsLocalScope(*line);
+            RemoveReferences(*line);
+        }
+        for (const auto& line : removed) {
+            RemoveDefinition(*line, pending);
+            flagged.erase(line.get());
+        }
+
+        for (size_t i = first; i < first + count; i++) {
+            DocumentLine& line = *lines[i];
+            line.address = start_address + new_size;
+            new_size += Size(line);
+            Define(line);
+            if (line.defines)
+                for (DocumentLine* referrer : line.defines->referrers) MarkPending(*referrer, pending);
+            AddReferences(line);
+            rescope |= AffectsLocalScope(line);
+            if (IsTextStatement(line)) MarkPending(line, pending);
+        }
+
+        // 之后同一段中的行整体移动：引用被移动的 Label 的行、有局部引用的行要重新检查，
+        // 引用处与目标一起移动的相对分支除外
+        const unsigned delta = new_size - old_size;
+        if (delta != 0) {
+            rescope |= segment == SegmentState::Text;
+            const unsigned stamp = ++shifts;
+            std::vector<const SymbolEntry*> moved;
+            for (size_t i = first + count; i < lines.size(); i++) {
+                DocumentLine& line = *lines[i];
+                if (line.segment != segment) continue;
+                line.address += delta;
+                line.moved = stamp;
+                if (line.defines) moved.push_back(line.defines);
+                if (!line.local_targets.empty()) {
+                    for (auto& target : line.local_targets) target.second += delta;
+                    if (!RelativeOnly(line)) MarkPending(line, pending);
+                }
+            }
+            for (const SymbolEntry* entry : moved) {
+                for (DocumentLine* referrer : entry->referrers) {
+                    if (referrer->moved != stamp || !RelativeOnly(*referrer)) MarkPending(*referrer, pending);
+                }
+            }
+        }
+
+        if (rescope) {
+            // 修改前后的函数：从之前最近的全局 Label 到之后最近的全局 Label
+            size_t begin = first, end = first + count;
+            while (begin > 0 && !OpensScope(*lines[begin - 1])) begin--;
+            if (begin > 0) begin--;
+            while (end < lines.size() && !OpensScope(*lines[end])) end++;
+            ResolveLocalLabels(begin, end, pending);
+        }
+
+        for (DocumentLine* line : pending) {
+            line->pending = false;
+            CheckReferences(*line);
+            Flag(*line);
+        }
+        for (size_t i = first; i < first + count; i++) Flag(*lines[i]);
+        return true;
+    }
+
+    // 按函数作用域解析 lines[begin, end) 中的局部 Label（见 LocalLabel.h），解析过的行等待重新检查
+    void ResolveLocalLabels(size_t begin, size_t end, std::vector<DocumentLine*>& pending) {
+        LocalLabelScope<LocalReference> local_labels;
+        auto resolve_local = [&](const std::string&, const LocalReference& ref, unsigned address) {
+            ref.line->local_targets.emplace_back(ref.relocation, address);
+        };
+        auto close_scope = [&] {
+            local_labels.Close([&](const std::string& symbol, const std::vector<LocalReference>& refs) {
+                for (const auto& ref : refs)
+                    AddTokenDiagnostic(ref.line->local_diagnostics, *ref.line, 1,
+                                       "Unknown Symbol: " + LocalLabelName(symbol), symbol);
+            });
+        };
+
+        for (size_t i = begin; i < end; i++) {
+            DocumentLine& line = *lines[i];
+            if (!IsTextStatement(line)) continue;
+            line.local_targets.clear();
+            line.local_diagnostics.clear();
+            MarkPending(line, pending);
+            const LineResult& result = *line.as_text;
+
+            if (!result.label.empty() && isLocalLabel(result.label)) {
+                if (!local_labels.Define(result.label, line.address, resolve_local)) {
+                    AddTokenDiagnostic(line.local_diagnostics, line, 1,
+                                       "Redefined symbol: " + LocalLabelName(result.label), result.label);
+                }
+            } else if (!result.label.empty()) {
+                close_scope();
+            }
+
+            for (unsigned k = 0; k < result.relocations.size(); k++) {
+                const std::string& symbol = result.relocations[k].symbol;
+                if (!isLocalReference(symbol)) continue;
+                unsigned address = 0;
+                switch (local_labels.Reference(symbol, LocalReference{&line, k}, address)) {
+                    case LocalLabelScope<LocalReference>::Lookup::Resolved:
+                        resolve_local(symbol, LocalReference{&line, k}, address);
+                        break;
+                    case LocalLabelScope<LocalReference>::Lookup::Undefined:
+                        AddTokenDiagnostic(line.local_diagnostics, line, 1,
+                                           "Unknown Symbol: " + LocalLabelName(symbol), symbol);
+                        break;
+                    case LocalLabelScope<LocalReference>::Lookup::Pending:
+                        break;
+                }
+            }
+        }
+        close_scope();
+    }
+
+    // 重新检查本行的全部符号引用（全局符号与已解析的局部 Label）
+    void CheckReferences(DocumentLine& line) const {
+        line.reference_diagnostics.clear();
+        if (!IsTextStatement(line)) return;
+        const LineResult& result = *line.as_text;
+        for (unsigned k = 0; k < line.symbols.size(); k++) {
+            const SymbolEntry* entry = line.symbols[k];
+            if (entry == nullptr) continue;
+            const std::string& symbol = result.relocations[k].symbol;
+            if (entry->definition == nullptr) {
+                AddTokenDiagnostic(line.reference_diagnostics, line, 1, "Unknown Symbol: " + symbol, symbol);
+                continue;
+            }
+            CheckReference(line, k, entry->definition->address);
+        }
+        for (const auto& [relocation, address] : line.local_targets) CheckReference(line, relocation, address);
+    }
+
+    // 回填一处符号引用，出错时在引用处报告
+    void CheckReference(DocumentLine& line, unsigned relocation, unsigned address) const {
+        const auto& [index, symbol, addend] = line.as_text->relocations[relocation];
+        MachineCode machine_code = line.as_text->machine_code[index];
+        try {
+            core.PatchSymbol(machine_code, line.address, address, addend);
+        } catch (const std::exception& e) {
+            AddTokenDiagnostic(line.reference_diagnostics, line, 1, e.what(), symbol);
+        }
+    }
+
+    // 回填已知符号（包括已解析的局部 Label）后的机器码
+    std::vector<MachineCode> Resolved(const DocumentLine& line, const LineResult& result) const {
+        std::vector<MachineCode> words = result.machine_code;
+        auto patch = [&](const RelocationTemplate& relocation, unsigned address) {
+            try {
+                core.PatchSymbol(words[relocation.index], line.address, address, relocation.addend);
+            } catch (const std::exception&) {
+            }
+        };
+        for (size_t k = 0; k < line.symbols.size(); k++) {
+            if (line.symbols[k] && line.symbols[k]->definition)
+                patch(result.relocations[k], line.symbols[k]->definition->address);
+        }
+        for (const auto& [relocation, address] : line.local_targets) {
+            patch(result.relocations[relocation], address);
+        }
+        return words;
+    }
+
+    // 标出整条语句（去掉前后空白、不含注释）
+    static void AddStatementDiagnostic(std::vector<Diagnostic>& diagnostics, const DocumentLine& line,
+                                       int severity, const std::string& message) {
+        const std::string& clean = line.clean;
+        size_t start = clean.find_first_not_of(" \t\r");
+        size_t end = clean.find_last_not_of(" \t\r");
+        if (start == std::string::npos) start = end = 0;
+        else end++;
+        diagnostics.push_back(Diagnostic{0, start, end, severity, message});
+    }
+
+    // 标出 token 在语句中的位置，找不到时标出整条语句
+    static void AddTokenDiagnostic(std::vector<Diagnostic>& diagnostics, const DocumentLine& line,
+                                   int severity, const std::string& message, const std::string& token) {
+        size_t pos = FindToken(line.text, token, line.clean.size());
+        if (pos == std::string::npos) {
+            AddStatementDiagnostic(diagnostics, line, severity, message);
+            return;
+        }
+        diagnostics.push_back(Diagnostic{0, pos, pos + token.size(), severity, message});
+    }
+};
+
+/*
+ * ---- 传输层：Content-Length 头 + JSON 正文 ----
+ */
+static bool ReadMessage(std::istream& in, std::string& body) {
+    std::string header;
+    size_t length = 0;
+    bool has_length = false;
+
+    while (std::getline(in, header)) {
+        if (!header.empty() && header.back() == '\r') header.pop_back();
+        if (header.empty()) {
+            if (has_length) break;
+            continue;
+        }
+        if (header.compare(0, 15, "Content-Length:") == 0) {
+            length = std::strtoul(header.c_str() + 15, nullptr, 10);
+            has_length = true;
+        }
+    }
+    if (!has_length) return false;
+
+    body.resize(length);
+    if (length == 0) return true;
+    in.read(&body[0], length);
+    return static_cast<size_t>(in.gcount()) == length;
+}
+
+static void WriteMessage(std::ostream& out, Json message) {
+    message["jsonrpc"] = "2.0";
+    std::string body = message.Dump();
+    out << "Content-Length: " << body.size() << "\r\n\r\n" << body;
+    out.flush();
+}
+
+static void Respond(std::ostream& out, const Json& id, Json result) {
+    Json message;
+    message["id"] = id;
+    message["result"] = std::move(result);
+    WriteMessage(out, std::move(message));
+}
+
+static void RespondError(std::ostream& out, const Json& id, int code, const std::string& text) {
+    Json message;
+    message["id"] = id;
+    message["error"]["code"] = code;
+    message["error"]["message"] = text;
+    WriteMessage(out, std::move(message));
+}
+
+static void PublishDiagnostics(std::ostream& out, const std::string& uri, Document* document) {
+    Json list = Json::MakeArray();
+    if (document) {
+        for (const auto& d : document->Analyze()) {
+            Json item;
+            item["range"] = Document::Range(d.line, document->LineText(d.line), d.start, d.end);
+            item["severity"] = d.severity;
+            item["source"] = "mas";
+            item["message"] = d.message;
+            list.Push(std::move(item));
+        }
+    }
+
+    Json message;
+    message["method"] = "textDocument/publishDiagnostics";
+    message["params"]["uri"] = uri;
+    message["params"]["diagnostics"] = std::move(list);
+    WriteMessage(out, std::move(message));
+}
+
+int RunLanguageServer(std::istream& in, std::ostream& out) {
+#ifdef _WIN32
+    // 保证 Content-Length 按字节计算，不做换行符转换
+    if (&in == &std::cin) _setmode(_fileno(stdin), _O_BINARY);
+    if (&out == &std::cout) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    std::unordered_map<std::string, Document> documents;
+    bool shutdown = false;
+    std::string body;
+
+    while (ReadMessage(in, body)) {
+        Json parsed;
+        if (!Json::Parse(body, parsed)) {
+            RespondError(out, Json(), -32700, "Parse error");
+            continue;
+        }
+
+        const Json& message = parsed;  // 只读访问，避免 operator[] 插入缺少的键
+        const std::string& method = message["method"].AsString();
+        const Json& id = message["id"];
+        const Json& params = message["params"];
+        const std::string& uri = params["textDocument"]["uri"].AsString();
+        const bool is_request = message.Has("id");
+
+        if (method == "initialize") {
+            Json result;
+            result["capabilities"]["textDocumentSync"] = 2;  // 增量同步
+            result["capabilities"]["hoverProvider"] = true;
+            result["capabilities"]["definitionProvider"] = true;
+            result["serverInfo"]["name"] = "mas";
+            Respond(out, id, std::move(result));
+        } else if (method == "shutdown") {
+            shutdown = true;
+            Respond(out, id, Json());
+        } else if (method == "exit") {
+            return shutdown ? 0 : 1;
+        } else if (method == "textDocument/didOpen") {
+            Document& document = documents[uri];
+            document.SetText(params["textDocument"]["text"].AsString());
+            PublishDiagnostics(out, uri, &document);
+        } else if (method == "textDocument/didChange") {
+            auto it = documents.find(uri);
+            if (it == documents.end()) continue;
+            for (const auto& change : params["contentChanges"].Items()) {
+                it->second.ApplyChange(change);
+            }
+            PublishDiagnostics(out, uri, &it->second);
+        } else if (method == "textDocument/didClose") {
+            documents.erase(uri);
+            PublishDiagnostics(out, uri, nullptr);
+        } else if (method == "textDocument/hover" || method == "textDocument/definition") {
+            auto it = documents.find(uri);
+            size_t line = params["position"]["line"].AsInt();
+            unsigned character = params["position"]["character"].AsInt();
+            if (it == documents.end()) {
+                Respond(out, id, Json());
+            } else if (method == "textDocument/hover") {
+                Respond(out, id, it->second.Hover(line, character));
+            } else {
+                Respond(out, id, it->second.Definition(uri, line, character));
+            }
+        } else if (is_request) {
+            RespondError(out, id, -32601, "Method not found: " + method);
+        }
+        // 其他通知（initialized、didSave 等）忽略
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <sstream>
+
+#include "Headers.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define PSAPI_VERSION 2  // GetProcessMemoryInfo 使用 kernel32 中的 K32 版本，无需链接 psapi
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+/*
+ * 报告中的数据结构条目
+ */
+enum MemoryItem {
+    kInstructionStructs,
+    kInstructionStrings,
+    kMachineCode,
+    kDataStructs,
+    kDataStrings,
+    kRawData,
+    kSymbolMap,
+    kUnsolvedSymbolMap,
+    kJobArena,
+    kItemCount
+};
+
+static const char* const kItemNames[kItemCount] = {
+    "InstructionList",   "  assembly/file strings", "  machine_code vectors",
+    "DataList",          "  assembly/file strings", "  raw_data vectors",
+    "SymbolMap",         "UnsolvedSymbolMap",       "JobArena (reserved)"};
+
+std::size_t PeakRssBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss;  // macOS 以字节为单位
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;  // Linux 以 KB 为单位
+#endif
+#endif
+}
+
+/*
+ * 字符串在堆上（或作业内存区中）持有的字节数：短字符串优化（SSO）时数据就在对象内部
+ */
+static std::size_t StringHeapBytes(const std::pmr::string& s) {
+    const char* p = s.data();
+    const char* self = reinterpret_cast<const char*>(&s);
+    if (p >= self && p < self + sizeof(s)) return 0;
+    return s.capacity() + 1;
+}
+
+template <typename T, typename Alloc>
+static std::size_t VectorBytes(const std::vector<T, Alloc>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+static void MeasureInstructions(const InstructionList& list, std::vector<std::size_t>& bytes,
+                                std::size_t base) {
+    bytes[base] += VectorBytes(list);
+    for (const auto& inst : list) {
+        bytes[base + 1] += StringHeapBytes(inst.assembly) + StringHeapBytes(inst.file);
+        bytes[base + 2] += VectorBytes(inst.machine_code);
+    }
+}
+
+static void MeasureData(const DataList& list, std::vector<std::size_t>& bytes, std::size_t base) {
+    bytes[base] += VectorBytes(list);
+    for (const auto& data : list) {
+        bytes[base + 1] += StringHeapBytes(data.assembly) + StringHeapBytes(data.file);
+        bytes[base + 2] += VectorBytes(data.raw_data);
+    }
+}
+
+void MemoryReport::Snapshot(const std::string& phase,
+                            const InstructionList& instruction_list,
+                            const DataList& data_list,
+                            const SymbolMap& symbol_map,
+                            const UnsolvedSymbolMap& unsolved_symbol_map) {
+    PhaseUsage usage;
+    usage.phase = phase;
+    usage.bytes.assign(kItemCount, 0);
+
+    MeasureInstructions(instruction_list, usage.bytes, kInstructionStructs);
+    MeasureData(data_list, usage.bytes, kDataStructs);
+
+    usage.bytes[kSymbolMap] = symbol_map.MemoryBytes();
+    usage.bytes[kUnsolvedSymbolMap] = unsolved_symbol_map.MemoryBytes();
+
+    // 上面各项在 doAssemble 中都位于作业内存区内；这里是内存区持有的总量（含扩容留下的旧数组）
+    if (auto* arena = dynamic_cast<const JobArena*>(instruction_list.get_allocator().resource()))
+        usage.bytes[kJobArena] = arena->BytesReserved();
+
+    usage.peak_rss = PeakRssBytes();
+    phases.push_back(std::move(usage));
+}
+
+std::string FormatBytes(std::size_t bytes) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (bytes >= (1u << 30)) out << bytes / double(1u << 30) << " GiB";
+    else if (bytes >= (1u << 20)) out << bytes / double(1u << 20) << " MiB";
+    else if (bytes >= (1u << 10)) out << bytes / double(1u << 10) << " KiB";
+    else out << bytes << " B";
+    return out.str();
+}
+
+void MemoryReport::Print(std::ostream& out) const {
+    const int name_width = 26, col_width = 16;
+    std::ios_base::fmtflags flags = out.flags();
+
+    out << "==== mas memory report (estimated bytes held) ====\n";
+    out << std::left << std::setw(name_width) << "structure" << std::right;
+    for (const auto& p : phases) out << std::setw(col_width) << p.phase;
+    out << "\n";
+
+    auto print_row = [&](int i) {
+        out << std::left << std::setw(name_width) << kItemNames[i] << std::right;
+        for (const auto& p : phases) out << std::setw(col_width) << FormatBytes(p.bytes[i]);
+        out << "\n";
+    };
+    for (int i = 0; i < kJobArena; i++) print_row(i);
+
+    out << std::left << std::setw(name_width) << "total" << std::right;
+    for (const auto& p : phases) {
+        std::size_t total = 0;
+        for (int i = 0; i < kJobArena; i++) total += p.bytes[i];
+        out << std::setw(col_width) << FormatBytes(total);
+    }
+    out << "\n";
+
+    // 内存区与上面各项重叠，不计入 total
+    print_row(kJobArena);
+
+    out << std::left << std::setw(name_width) << "peak RSS" << std::right;
+    for (const auto& p : phases)
+        out << std::setw(col_width) << (p.peak_rss ? FormatBytes(p.peak_rss) : "n/a");
+    out << "\n";
+
+    out.flags(flags);
+}
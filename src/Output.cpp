@@ -1,142 +1,328 @@
+#include <filesystem>
+#include <sstream>
+
 #include "Headers.h"
 
 /*
  * 输出 COE 文件头
  */
-static void OutputHeader(std::ostream& out) {
+void OutputImageHeader(std::ostream& out) {
     out << R"(memory_initialization_radix = 16;
 memory_initialization_vector =
 )";
 }
 
 /*
- * OutputInstruction：
- *   输出 instruction_list 中所有 machine_code
- *   每个 machine_code 按 8 位十六进制输出
+ * PlaceInstructionWords：
+ *   把一条指令的 machine_code 写入镜像 mem 中对应的字地址。
+ *   超出 mem 大小的部分被丢弃。
  */
-void OutputInstruction(std::ostream& out,
-                       const InstructionList& instruction_list) {
-    OutputHeader(out);
+void PlaceInstructionWords(std::vector<uint32_t>& mem, unsigned address,
+                           const std::pmr::vector<MachineCode>& machine_code) {
+    size_t word_addr = address / 4;   // 字节地址/4变为字地址
+    for (size_t k = 0; k < machine_code.size(); ++k) {
+        if (word_addr + k < mem.size())
+            mem[word_addr + k] = machine_code[k];
+    }
+}
 
-    std::vector<uint32_t> mem(TOTAL_WORDS, 0);
+/*
+ * PlaceDataWords：
+ *   把一条数据的 raw_data 从 address 所在的字开始，每 4 byte 打包成一个 word 写入镜像。
+ *   不足 4 字节的部分补 0 后也写一个 word。超出 mem 大小的部分被丢弃。
+ */
+void PlaceDataWords(std::vector<uint32_t>& mem, unsigned address,
+                    const std::pmr::vector<std::uint8_t>& raw_data) {
+    size_t word_addr = address / 4;      // 字节地址变为字地址
+    uint8_t buffer[4] = {0}; // 临时缓冲区，Data中的二进制数据是按byte存储的
+    int bi = 0; // 缓冲区索引
 
-    // ---- 把指令写入正确的地址 ----
-    for (const auto& ins : instruction_list) {
-        int word_addr = ins.address / 4;   // 字节地址/4变为字地址
-        for (size_t k = 0; k < ins.machine_code.size(); ++k) {
-            if (word_addr + k < TOTAL_WORDS)
-                mem[word_addr + k] = ins.machine_code[k];
+    for (size_t i = 0; i < raw_data.size(); ++i) {
+        buffer[bi++] = raw_data[i];
+
+        if (bi == 4) {
+            uint32_t word = *(uint32_t*)buffer;
+            if (word_addr < mem.size())
+                mem[word_addr] = word;
+
+            word_addr++;
+            bi = 0;
+            memset(buffer, 0, 4); // 清空缓冲区
         }
     }
 
-    // ---- 输出 COE ----
+    // ----- 若不足 4 字节，也要写一个 word -----
+    if (bi != 0 && word_addr < mem.size()) {
+        uint32_t word = *(uint32_t*)buffer;
+        mem[word_addr] = word;
+    }
+}
+
+/*
+ * OutputImage：
+ *   输出 COE 文件头以及 TOTAL_WORDS 个字，mem 不足的部分补 0
+ */
+void OutputImage(std::ostream& out, const std::vector<uint32_t>& mem) {
+    OutputImageHeader(out);
+
     for (int i = 0; i < TOTAL_WORDS; ++i) {
-        out << std::setw(8)
-            << std::setfill('0')
-            << std::hex << mem[i]
-            << (i == TOTAL_WORDS - 1 ? ';' : ',') << "\n";
+        OutputImageWord(out, i, static_cast<size_t>(i) < mem.size() ? mem[i] : 0);
     }
 }
 
 /*
- * OutputDataSegment：
- *   4 字节组合为一个 32bit word 输出。
- *   raw_data 是 byte 存储，因此按每 4 byte 打包。
+ * OutputImageWord：
+ *   输出镜像中第 index 个字，最后一个字以分号结尾
  */
-void OutputDataSegment(std::ostream& out,
-                       const DataList& data_list) {
-    OutputHeader(out);
+void OutputImageWord(std::ostream& out, size_t index, uint32_t word) {
+    out << std::setw(8)
+        << std::setfill('0')
+        << std::hex << word
+        << (index == TOTAL_WORDS - 1 ? ';' : ',') << "\n";
+}
 
+/*
+ * BuildInstructionImage：
+ *   把 instruction_list 中所有 machine_code 放到正确的地址，得到 TOTAL_WORDS 个字的镜像
+ */
+std::vector<uint32_t> BuildInstructionImage(const InstructionList& instruction_list) {
     std::vector<uint32_t> mem(TOTAL_WORDS, 0);
+    for (const auto& ins : instruction_list) {
+        PlaceInstructionWords(mem, ins.address, ins.machine_code);
+    }
+    return mem;
+}
 
-    // --- 写入 Data 段 ---
+/*
+ * BuildDataImage：
+ *   raw_data 是 byte 存储，按每 4 byte 打包为一个 32bit word，得到 TOTAL_WORDS 个字的镜像
+ */
+std::vector<uint32_t> BuildDataImage(const DataList& data_list) {
+    std::vector<uint32_t> mem(TOTAL_WORDS, 0);
     for (const auto& d : data_list) {
-        int word_addr = d.address / 4;      // 字节地址变为字地址
-        uint8_t buffer[4] = {0}; // 临时缓冲区，Data中的二进制数据是按byte存储的
-        int bi = 0; // 缓冲区索引
-
-        for (size_t i = 0; i < d.raw_data.size(); ++i) {
-            buffer[bi++] = d.raw_data[i];
-
-            if (bi == 4) {
-                uint32_t word = *(uint32_t*)buffer;
-                if (word_addr < TOTAL_WORDS)
-                    mem[word_addr] = word;
-
-                word_addr++;
-                bi = 0;
-                memset(buffer, 0, 4); // 清空缓冲区
-            }
-        }
-
-        // ----- 若不足 4 字节，也要写一个 word -----
-        if (bi != 0 && word_addr < TOTAL_WORDS) {
-            uint32_t word = *(uint32_t*)buffer;
-            mem[word_addr] = word;
-        }
+        PlaceDataWords(mem, d.address, d.raw_data);
     }
+    return mem;
+}
 
-    // ---- 输出 COE ----
-    for (int i = 0; i < TOTAL_WORDS; ++i) {
-        out << std::setw(8)
-            << std::setfill('0')
-            << std::hex << mem[i]
-            << (i == TOTAL_WORDS - 1 ? ';' : ',') << "\n";
-    }
+/*
+ * OutputInstruction：
+ *   输出 instruction_list 中所有 machine_code
+ *   每个 machine_code 按 8 位十六进制输出
+ */
+void OutputInstruction(std::ostream& out,
+                       const InstructionList& instruction_list) {
+    OutputImage(out, BuildInstructionImage(instruction_list));
 }
 
-void OutputDetails(InstructionList instruction_list, DataList data_list,
-                 std::ostream& out) {
+/*
+ * OutputDataSegment：
+ *   4 字节组合为一个 32bit word 输出。
+ */
+void OutputDataSegment(std::ostream& out,
+                       const DataList& data_list) {
+    OutputImage(out, BuildDataImage(data_list));
+}
 
-    // Code Segment 输出
+void OutputDetailsCodeHeader(std::ostream& out) {
     out << "Code Segment\n          Machine code\n"
         << "Offset    hex       bin                               \tassembly\n";
+}
 
-    for (const Instruction& instruction : instruction_list) {
+void OutputDetailsDataHeader(std::ostream& out) {
+    out << "\nData Segment\n          Raw data\n"
+        << "Offset    hex bin     \tassembly\n";
+}
 
-        auto offset = instruction.address; // 起始地址（每条指令固定 4 字节）
+void OutputDetailsCodeLine(std::ostream& out, unsigned offset, MachineCode machine_code,
+                           std::string_view assembly) {
+    // Offset：8位十六进制（统一宽度）
+    out << std::hex << std::setw(8) << std::setfill('0') << offset << "  ";
 
-        for (const auto machine_code : instruction.machine_code) {
+    // Machine code：8位十六进制
+    out << std::setw(8) << std::setfill('0') << machine_code << "  ";
+
+    // Machine code：32位二进制（直接写入缓冲区，不经过 bitset 的临时字符串）
+    char bits[33];
+    for (int i = 0; i < 32; i++) bits[i] = (machine_code >> (31 - i)) & 1 ? '1' : '0';
+    bits[32] = '\t';
+    out.write(bits, sizeof(bits));
+
+    // assembly：原始文本
+    out << assembly << '\n';
+}
+
+void OutputDetailsDataLine(std::ostream& out, unsigned offset, std::uint8_t raw_data,
+                           std::string_view assembly) {
+    // Offset：8位十六进制
+    out << std::hex << std::setw(8) << std::setfill('0') << offset << "  ";
 
-            // Offset：8位十六进制（统一宽度）
-            out << std::hex << std::setw(8) << std::setfill('0') << offset << "  ";
+    // Raw data：2位十六进制（单个字节）
+    out << std::setw(2) << std::setfill('0') << (unsigned)raw_data << "  ";
 
-            // Machine code：8位十六进制
-            out << std::setw(8) << std::setfill('0') << machine_code << "  ";
+    // Raw data：8位二进制
+    out << std::bitset<8>(raw_data) << "\t";
+
+    // assembly：原始数据行
+    out << assembly << '\n';
+}
 
-            // Machine code：32位二进制
-            out << std::bitset<32>(machine_code) << "\t";
+void OutputDetails(const InstructionList& instruction_list, const DataList& data_list,
+                   std::ostream& out) {
 
-            // assembly：原始文本
-            out << instruction.assembly << '\n';
+    // Code Segment 输出
+    OutputDetailsCodeHeader(out);
+
+    for (const Instruction& instruction : instruction_list) {
 
+        auto offset = instruction.address; // 起始地址（每条指令固定 4 字节）
+
+        for (const auto machine_code : instruction.machine_code) {
+            OutputDetailsCodeLine(out, offset, machine_code, instruction.assembly);
             offset += 4;
         }
     }
 
     // Data Segment 输出
-    out << "\nData Segment\n          Raw data\n"
-        << "Offset    hex bin     \tassembly\n";
+    OutputDetailsDataHeader(out);
 
     for (const Data& data : data_list) {
 
         auto offset = data.address;
 
         for (const auto raw_data : data.raw_data) {
+            OutputDetailsDataLine(out, offset, raw_data, data.assembly);
+            offset += 1;
+        }
+    }
+}
 
-            // Offset：8位十六进制
-            out << std::hex << std::setw(8) << std::setfill('0') << offset << "  ";
+bool WriteFileIfChanged(const std::string& path, const std::string& content, bool binary,
+                        bool* changed) {
+    const std::ios::openmode mode = binary ? std::ios::binary : std::ios::openmode();
+    if (changed) *changed = false;
+
+    // 与已有文件比较
+    {
+        std::ifstream in(path, mode);
+        if (in) {
+            std::ostringstream existing;
+            existing << in.rdbuf();
+            if (existing.str() == content) return true;
+        }
+    }
 
-            // Raw data：2位十六进制（单个字节）
-            out << std::setw(2) << std::setfill('0') << (unsigned)raw_data << "  ";
+    // 写入临时文件后改名替换
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, mode | std::ios::trunc);
+        if (!out) return false;
+        out.write(content.data(), content.size());
+        out.close();
+        if (!out) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
 
-            // Raw data：8位二进制
-            out << std::bitset<8>(raw_data) << "\t";
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    if (changed) *changed = true;
+    return true;
+}
 
-            // assembly：原始数据行
-            out << data.assembly << '\n';
+namespace {
 
-            offset += 1;
+/*
+ * SpoolCompareBuf：写入临时文件的输出缓冲区，每次清空缓冲区时
+ * 从已有文件读出同样多的字节比较，记录到目前为止内容是否相同
+ */
+class SpoolCompareBuf : public std::streambuf {
+   public:
+    SpoolCompareBuf(std::ofstream& out, std::ifstream& existing)
+        : out(out), existing(existing), same(static_cast<bool>(existing)) {
+        setp(buffer, buffer + kSize);
+    }
+
+    // 写完后调用：已有文件也恰好读完时内容才相同
+    bool Finish() {
+        Drain();
+        if (same && existing.peek() != std::char_traits<char>::eof()) same = false;
+        return same;
+    }
+
+   protected:
+    int_type overflow(int_type c) override {
+        if (!Drain()) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override { return Drain() ? 0 : -1; }
+
+   private:
+    static constexpr size_t kSize = 64 * 1024;
+    char buffer[kSize];
+    char compare[kSize];
+    std::ofstream& out;
+    std::ifstream& existing;
+    bool same;
+
+    bool Drain() {
+        const std::streamsize n = pptr() - pbase();
+        if (n == 0) return true;
+        out.write(pbase(), n);
+        if (same) {
+            existing.read(compare, n);
+            same = existing.gcount() == n && std::memcmp(compare, pbase(), n) == 0;
         }
+        setp(buffer, buffer + kSize);
+        return static_cast<bool>(out);
     }
-}
\ No newline at end of file
+};
+
+}  // namespace
+
+bool WriteStreamIfChanged(const std::string& path, const std::function<void(std::ostream&)>& write,
+                          bool binary, bool* changed) {
+    const std::ios::openmode mode = binary ? std::ios::binary : std::ios::openmode();
+    if (changed) *changed = false;
+
+    std::ifstream existing(path, mode);
+    std::string tmp_path = path + ".tmp";
+    bool same;
+    {
+        std::ofstream out(tmp_path, mode | std::ios::trunc);
+        if (!out) return false;
+        auto spool = std::make_unique<SpoolCompareBuf>(out, existing);   // 缓冲区较大，不放在栈上
+        std::ostream stream(spool.get());
+        write(stream);
+        same = spool->Finish();
+        out.close();
+        if (!stream || !out) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+    existing.close();
+
+    if (same) {
+        std::remove(tmp_path.c_str());
+        return true;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    if (changed) *changed = true;
+    return true;
+}
@@ -0,0 +1,108 @@
+#include <sstream>
+
+#include "Headers.h"
+
+static const unsigned kPatchEndAddress = 0xFFFF;
+
+/*
+ * ReadCoeImage：按 COE 格式读入（见 Image.h），补齐或截断到 TOTAL_WORDS 个字
+ */
+bool ReadCoeImage(const std::string& path, std::vector<uint32_t>& mem) {
+    std::string error;
+    if (!ReadImage(path, mem, error)) return false;
+    mem.resize(TOTAL_WORDS, 0);
+    return true;
+}
+
+std::vector<PatchRun> DiffImages(const std::vector<uint32_t>& old_mem,
+                                 const std::vector<uint32_t>& new_mem) {
+    auto word_at = [](const std::vector<uint32_t>& mem, size_t i) {
+        return i < mem.size() ? mem[i] : 0u;
+    };
+
+    std::vector<PatchRun> runs;
+    for (size_t i = 0; i < static_cast<size_t>(TOTAL_WORDS); i++) {
+        if (word_at(old_mem, i) == word_at(new_mem, i)) continue;
+
+        // 与上一段之间只隔 1 个未变化的字时合并
+        if (!runs.empty() && runs.back().address + runs.back().words.size() + 1 >= i) {
+            PatchRun& run = runs.back();
+            for (size_t k = run.address + run.words.size(); k <= i; k++) {
+                run.words.push_back(word_at(new_mem, k));
+            }
+        } else {
+            runs.push_back(PatchRun{static_cast<unsigned>(i), {word_at(new_mem, i)}});
+        }
+    }
+    return runs;
+}
+
+static void WriteU16(std::ostream& out, unsigned v) {
+    out.put(static_cast<char>(v & 0xFF));
+    out.put(static_cast<char>((v >> 8) & 0xFF));
+}
+
+void OutputPatchBinary(std::ostream& out, const std::vector<PatchRun>& runs) {
+    for (const auto& run : runs) {
+        WriteU16(out, run.address);
+        WriteU16(out, run.words.size());
+        for (uint32_t word : run.words) {
+            WriteU16(out, word & 0xFFFF);
+            WriteU16(out, word >> 16);
+        }
+    }
+    WriteU16(out, kPatchEndAddress);
+    WriteU16(out, 0);
+}
+
+/*
+ * 为一个镜像生成补丁文件，并把摘要追加到 summary
+ */
+static bool WriteImagePatch(const std::string& base_dir, const std::string& output_dir,
+                            const std::string& name, const std::vector<uint32_t>& image,
+                            std::ostream& summary) {
+    std::vector<uint32_t> base;
+    bool has_base = ReadCoeImage(base_dir + name + ".coe", base);
+
+    std::vector<PatchRun> runs;
+    if (has_base) {
+        runs = DiffImages(base, image);
+    } else {
+        // 没有基准时写入整个镜像
+        PatchRun full{0, image};
+        full.words.resize(TOTAL_WORDS, 0);
+        runs.push_back(std::move(full));
+    }
+
+    std::ostringstream binary;
+    OutputPatchBinary(binary, runs);
+    if (!WriteFileIfChanged(output_dir + name + ".patch", binary.str(), true)) {
+        std::cerr << "IO Error: Could not write to " << name << ".patch" << std::endl;
+        return false;
+    }
+
+    size_t changed = 0;
+    for (const auto& run : runs) changed += run.words.size();
+    summary << name << ": " << (has_base ? "" : "no base image, full image; ") << runs.size()
+            << " runs, " << changed << " words, " << binary.str().size() << " bytes\n";
+    for (const auto& run : runs) {
+        summary << "  0x" << std::hex << std::setw(4) << std::setfill('0') << run.address * 4
+                << "-0x" << std::setw(4) << (run.address + run.words.size()) * 4 - 1 << std::dec
+                << std::setfill(' ') << "  " << run.words.size() << " words\n";
+    }
+    return true;
+}
+
+bool WritePatches(const std::string& base_dir, const std::string& output_dir,
+                  const std::vector<uint32_t>& code_image,
+                  const std::vector<uint32_t>& data_image) {
+    std::ostringstream summary;
+    if (!WriteImagePatch(base_dir, output_dir, "prgmip32", code_image, summary)) return false;
+    if (!WriteImagePatch(base_dir, output_dir, "dmem32", data_image, summary)) return false;
+
+    if (!WriteFileIfChanged(output_dir + "patch.txt", summary.str())) {
+        std::cerr << "IO Error: Could not write to patch.txt" << std::endl;
+        return false;
+    }
+    return true;
+}
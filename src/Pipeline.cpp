@@ -0,0 +1,507 @@
+#include <deque>
+#include <set>
+#include <sstream>
+
+#include "Headers.h"
+
+static const size_t kLineBatchSize = 512;   // 每批传递的行数
+static const size_t kQueueBatches = 64;     // 队列中最多积压的批数
+
+// 读入线程的输出：去掉注释后的非空行
+struct SourceLine {
+    int line;
+    std::string text;
+};
+using LineBatch = std::vector<SourceLine>;
+
+// 已确定的指令：机器码已回填完毕
+struct FinishedCode {
+    unsigned address;
+    std::vector<MachineCode> words;
+    std::pmr::string assembly;
+};
+
+// 数据定义（数据段不需要回填，编码后即确定）
+struct FinishedData {
+    unsigned address;
+    std::pmr::vector<std::uint8_t> raw_data;
+    std::pmr::string assembly;
+};
+
+/*
+ * 编码线程交给输出线程的一批已确定内容
+ *   data_words：数据镜像中从上一批之后开始的连续若干字
+ */
+struct OutputBatch {
+    std::vector<FinishedCode> code;
+    std::vector<uint32_t> data_words;
+    std::vector<FinishedData> data;
+
+    bool Empty() const { return code.empty() && data_words.empty() && data.empty(); }
+};
+
+/*
+ * 输出线程：把收到的内容依次格式化为 COE 与 details 文本
+ */
+class OutputFormatter {
+   public:
+    explicit OutputFormatter(bool keep_details) : keep_details(keep_details) {
+        OutputImageHeader(code_coe);
+        OutputImageHeader(data_coe);
+        if (keep_details) OutputDetailsCodeHeader(code_details);
+    }
+
+    void Add(const OutputBatch& batch) {
+        for (const auto& finished : batch.code) {
+            // 指令之间的空隙补 0
+            size_t word_index = finished.address / 4;
+            while (code_words < word_index) AddWord(code_coe, code_words, 0);
+
+            unsigned offset = finished.address;
+            for (const auto machine_code : finished.words) {
+                AddWord(code_coe, code_words, machine_code);
+                if (keep_details)
+                    OutputDetailsCodeLine(code_details, offset, machine_code, finished.assembly);
+                offset += 4;
+            }
+        }
+
+        for (const auto word : batch.data_words) AddWord(data_coe, data_words, word);
+
+        if (!keep_details) return;
+        for (const auto& finished : batch.data) {
+            unsigned offset = finished.address;
+            for (const auto raw_data : finished.raw_data) {
+                OutputDetailsDataLine(data_details, offset++, raw_data, finished.assembly);
+            }
+        }
+    }
+
+    // 补齐 TOTAL_WORDS 个字
+    void Finish() {
+        while (code_words < static_cast<size_t>(TOTAL_WORDS)) AddWord(code_coe, code_words, 0);
+        while (data_words < static_cast<size_t>(TOTAL_WORDS)) AddWord(data_coe, data_words, 0);
+    }
+
+    std::string CodeImage() const { return code_coe.str(); }
+    std::string DataImage() const { return data_coe.str(); }
+    std::string Details() const {
+        std::ostringstream out;
+        out << code_details.str();
+        OutputDetailsDataHeader(out);
+        out << data_details.str();
+        return out.str();
+    }
+
+   private:
+    bool keep_details;
+    std::ostringstream code_coe, data_coe, code_details, data_details;
+    size_t code_words = 0;   // 已输出到 COE 的字数（超过 TOTAL_WORDS 的部分只计数）
+    size_t data_words = 0;
+
+    static void AddWord(std::ostream& out, size_t& count, uint32_t word) {
+        if (count < static_cast<size_t>(TOTAL_WORDS)) OutputImageWord(out, count, word);
+        count++;
+    }
+};
+
+/*
+ * 待回填项：同 Stream.cpp
+ *   word_index：机器码在代码镜像中的字地址
+ *   inst_addr ：该指令的字节地址（分支指令计算相对偏移用）
+ */
+struct PipelineFixup {
+    size_t word_index;
+    unsigned inst_addr;
+    Addend addend;
+};
+
+/*
+ * PipelineEncoder：编码线程的状态
+ * 除符号表、待回填项和两个镜像外，还记录尚未交给输出线程的指令
+ */
+class PipelineEncoder {
+   public:
+    explicit PipelineEncoder(AssemblyCache* cache) { core.SetCache(cache); }
+
+    // 处理一条代码段记录（普通指令或 .text 预留空间）
+    void AddInstruction(Instruction& instruction) {
+        UnsolvedSymbolMap local_refs(symbol_map);
+        std::string label;
+
+        core.SetCurrentAddress(text_address);
+        if (core.ProcessInstruction(instruction, local_refs, symbol_map, &label))
+            has_error = true;
+        text_address = core.GetCurrentAddress();
+
+        if (!label.empty() && isLocalLabel(label)) {
+            DefineLocal(label, instruction);
+        } else if (!label.empty()) {
+            CloseLocalScope();
+            ResolvePending(label);
+        }
+
+        size_t first_word = instruction.address / 4;
+        if (!instruction.machine_code.empty()) {
+            size_t end = first_word + instruction.machine_code.size();
+            if (code_image.size() < end) code_image.resize(end, 0);
+        }
+
+        // 本行的符号引用：已定义的立即回填，否则记为待回填项
+        for (const auto& relocation : local_refs) {
+            const SymbolId symbol = relocation.symbol;
+            size_t offset = relocation.ref.machine_code_handle - instruction.machine_code.begin();
+            if (symbol_map.IsDefined(symbol)) {
+                Patch(*relocation.ref.machine_code_handle, instruction.address,
+                      symbol_map.Address(symbol), relocation.addend, symbol_map.Names().Name(symbol));
+            } else {
+                if (pending.size() <= symbol) pending.resize(symbol + 1);
+                pending[symbol].push_back(
+                    PipelineFixup{first_word + offset, instruction.address, relocation.addend});
+                pending_words.insert(first_word + offset);
+            }
+        }
+
+        // 对局部 Label 的引用：在当前作用域内回填或等待（等待的字同样阻止输出）
+        for (const auto& local : local_refs.Locals()) {
+            size_t offset = local.ref.machine_code_handle - instruction.machine_code.begin();
+            unsigned address = 0;
+            switch (local_labels.Reference(
+                local.symbol, PipelineFixup{first_word + offset, instruction.address, local.addend},
+                address)) {
+                case LocalLabelScope<PipelineFixup>::Lookup::Resolved:
+                    Patch(*local.ref.machine_code_handle, instruction.address, address,
+                          local.addend, local.symbol);
+                    break;
+                case LocalLabelScope<PipelineFixup>::Lookup::Undefined:
+                    core.LogError("Unknown Symbol: " + LocalLabelName(local.symbol), instruction.assembly);
+                    undefined_local = true;
+                    break;
+                case LocalLabelScope<PipelineFixup>::Lookup::Pending:
+                    pending_words.insert(first_word + offset);
+                    break;
+            }
+        }
+
+        if (instruction.machine_code.empty()) return;
+        PlaceInstructionWords(code_image, instruction.address, instruction.machine_code);
+        unfinished.push_back(UnfinishedCode{instruction.address, instruction.machine_code.size(),
+                                            std::move(instruction.assembly)});
+    }
+
+    // 处理一条数据段记录（数据定义或 .data 预留空间）
+    void AddData(Data& data) {
+        std::string label;
+
+        core.SetCurrentAddress(data_address);
+        if (core.ProcessData(data, symbol_map, &label)) has_error = data_error = true;
+        data_address = core.GetCurrentAddress();
+
+        if (!label.empty()) ResolvePending(label);
+        if (data.raw_data.empty()) return;
+
+        size_t end = data.address / 4 + (data.raw_data.size() + 3) / 4;
+        if (data_image.size() < end) data_image.resize(end, 0);
+        PlaceDataWords(data_image, data.address, data.raw_data);
+        ready.data.push_back(
+            FinishedData{static_cast<unsigned>(data.address), std::move(data.raw_data),
+                         std::move(data.assembly)});
+    }
+
+    /*
+     * 取出已确定的内容：
+     *   代码段：第一个待回填字之前（且不超过当前地址）的指令
+     *   数据段：当前地址所在字之前的字（下一条数据可能写入当前字）
+     * at_end 为 true 时输入已结束，所有内容都已确定
+     */
+    OutputBatch TakeFinished(bool at_end) {
+        size_t code_limit = at_end ? SIZE_MAX : text_address / 4;
+        if (!at_end && !pending_words.empty())
+            code_limit = std::min(code_limit, *pending_words.begin());
+
+        while (!unfinished.empty() &&
+               unfinished.front().address / 4 + unfinished.front().count <= code_limit) {
+            UnfinishedCode& front = unfinished.front();
+            auto first = code_image.begin() + front.address / 4;
+            ready.code.push_back(FinishedCode{front.address,
+                                              std::vector<MachineCode>(first, first + front.count),
+                                              std::move(front.assembly)});
+            unfinished.pop_front();
+        }
+
+        size_t data_limit = at_end ? data_image.size()
+                                   : std::min<size_t>(data_address / 4, data_image.size());
+        if (data_limit > data_sent) {
+            ready.data_words.assign(data_image.begin() + data_sent, data_image.begin() + data_limit);
+            data_sent = data_limit;
+        }
+
+        OutputBatch batch = std::move(ready);
+        ready = OutputBatch();
+        return batch;
+    }
+
+    // 输入结束：关闭最后一个局部作用域，剩余的待回填项都是未定义的符号
+    bool ReportUndefined() {
+        CloseLocalScope();
+        bool undefined = undefined_local;
+        for (SymbolId symbol = 0; symbol < pending.size(); symbol++) {
+            if (pending[symbol].empty()) continue;
+            core.LogError("Unknown Symbol: " + std::string(symbol_map.Names().Name(symbol)));
+            undefined = true;
+        }
+        return undefined;
+    }
+
+    bool HasError() const { return has_error; }
+    bool HasDataError() const { return data_error; }
+
+    // --patch：与基准 COE 比较并写出补丁文件
+    bool WritePatchFiles(const std::string& base_dir, const std::string& output_dir) const {
+        return WritePatches(base_dir, output_dir, code_image, data_image);
+    }
+
+    void PrintMemoryReport(std::ostream& out) const {
+        size_t pending_bytes = pending.capacity() * sizeof(pending[0]) +
+                               pending_words.size() * (sizeof(size_t) + 4 * sizeof(void*));
+        for (const auto& fixups : pending) pending_bytes += fixups.capacity() * sizeof(PipelineFixup);
+
+        out << "==== mas memory report (pipeline mode, estimated bytes held) ====\n"
+            << "code image          " << FormatBytes(code_image.capacity() * sizeof(uint32_t)) << "\n"
+            << "data image          " << FormatBytes(data_image.capacity() * sizeof(uint32_t)) << "\n"
+            << "SymbolMap           " << FormatBytes(symbol_map.MemoryBytes()) << "\n"
+            << "pending fixups      " << FormatBytes(pending_bytes) << "\n"
+            << "peak RSS            " << FormatBytes(PeakRssBytes()) << "\n";
+    }
+
+   private:
+    // 已编码但可能还有待回填字的指令
+    struct UnfinishedCode {
+        unsigned address;
+        size_t count;
+        std::pmr::string assembly;
+    };
+
+    AssemblerCore core;
+    SymbolMap symbol_map;
+    std::vector<std::vector<PipelineFixup>> pending;   // 按符号 id 下标
+    LocalLabelScope<PipelineFixup> local_labels;       // 当前函数的局部 Label（见 LocalLabel.h）
+    std::multiset<size_t> pending_words;   // 所有待回填项的字地址，用于求最小值
+
+    std::vector<uint32_t> code_image;
+    std::vector<uint32_t> data_image;
+    unsigned text_address = 0;
+    unsigned data_address = 0;
+    bool has_error = false;
+    bool data_error = false;    // 出错的是数据段（决定汇总提示，同普通模式）
+    bool undefined_local = false;   // 有未定义的局部 Label（同全局符号，由 ReportUndefined 返回）
+
+    std::deque<UnfinishedCode> unfinished;
+    OutputBatch ready;        // 下次 TakeFinished 返回的内容
+    size_t data_sent = 0;     // 已交给输出线程的数据字数
+
+    void Patch(MachineCode& machine_code, unsigned inst_addr, unsigned symbol_addr, Addend addend,
+               std::string_view symbol) {
+        try {
+            core.PatchSymbol(machine_code, inst_addr, symbol_addr, addend);
+        } catch (const std::exception& e) {
+            core.LogError(e.what(), "Resolving " + LocalLabelName(symbol));
+            has_error = true;
+        }
+    }
+
+    // 局部 Label 出现：回填当前作用域中等待它的引用
+    void DefineLocal(const std::string& label, const Instruction& instruction) {
+        auto resolve = [this](const std::string& symbol, const PipelineFixup& fixup, unsigned address) {
+            Patch(code_image[fixup.word_index], fixup.inst_addr, address, fixup.addend, symbol);
+            pending_words.erase(pending_words.find(fixup.word_index));
+        };
+        if (!local_labels.Define(label, instruction.address, resolve)) {
+            core.LogError("Redefined symbol: " + LocalLabelName(label), instruction.assembly);
+            has_error = true;
+        }
+    }
+
+    // 关闭局部作用域：仍在等待的引用是未定义的局部 Label，对应的字不再阻止输出
+    void CloseLocalScope() {
+        local_labels.Close([&](const std::string& symbol, const std::vector<PipelineFixup>& fixups) {
+            core.LogError("Unknown Symbol: " + LocalLabelName(symbol));
+            for (const auto& fixup : fixups) pending_words.erase(pending_words.find(fixup.word_index));
+            undefined_local = true;
+        });
+    }
+
+    // Label 出现：回填所有等待它的引用
+    void ResolvePending(const std::string& label) {
+        const SymbolId symbol = symbol_map.Names().Find(label);
+        if (symbol >= pending.size() || pending[symbol].empty()) return;
+
+        unsigned symbol_addr = symbol_map.Address(symbol);
+        for (const auto& fixup : pending[symbol]) {
+            Patch(code_image[fixup.word_index], fixup.inst_addr, symbol_addr, fixup.addend,
+                  symbol_map.Names().Name(symbol));
+            pending_words.erase(pending_words.find(fixup.word_index));
+        }
+        std::vector<PipelineFixup>().swap(pending[symbol]);
+    }
+};
+
+/*
+ * 读入线程与输出线程；析构时（包括提前返回）取消队列并等待线程结束
+ */
+struct PipelineThreads {
+    SpscQueue<LineBatch> lines{kQueueBatches};
+    SpscQueue<OutputBatch> output{kQueueBatches};
+    std::thread reader;
+    std::thread writer;
+
+    ~PipelineThreads() {
+        lines.Cancel();
+        output.Cancel();
+        if (reader.joinable()) reader.join();
+        if (writer.joinable()) writer.join();
+    }
+};
+
+int doAssemblePipeline(std::istream& in,
+                       const std::string& input_path,
+                       const std::string& output_dir,
+                       const AssembleOptions& options,
+                       AssemblyCache* cache) {
+    const bool to_stdout = options.stdout_format != StdoutFormat::None;
+    PipelineEncoder encoder(cache);
+    OutputFormatter formatter(!to_stdout || options.stdout_format == StdoutFormat::Details);
+    PipelineThreads threads;
+
+    threads.reader = std::thread([&in, &threads] {
+        std::string current_line;
+        int line_counter = 0;
+        bool more = true;
+        while (more) {
+            LineBatch batch;
+            batch.reserve(kLineBatchSize);
+            {
+                // 只统计读入和去注释的时间，不含等待队列的时间
+                ScopedPhaseTimer timer(StatsPhase::Read);
+                while (batch.size() < kLineBatchSize && (more = !!std::getline(in, current_line))) {
+                    line_counter++;
+
+                    std::string clean_line(KillComment(current_line));
+                    if (clean_line.empty() || clean_line.find_first_not_of(" \t\r\n") == std::string::npos) {
+                        continue; // 跳过空行
+                    }
+                    batch.push_back(SourceLine{line_counter, std::move(clean_line)});
+                }
+            }
+            if (!batch.empty() && !threads.lines.Push(std::move(batch))) return;
+        }
+        threads.lines.Close();
+    });
+
+    threads.writer = std::thread([&formatter, &threads] {
+        OutputBatch batch;
+        while (threads.output.Pop(batch)) {
+            ScopedPhaseTimer timer(StatsPhase::Output);
+            formatter.Add(batch);
+        }
+    });
+
+    SegmentState current_state = SegmentState::Global;
+
+    try {
+        // 段切换指令产生的预留空间记录
+        InstructionList reserved_text;
+        DataList reserved_data;
+
+        LineBatch batch;
+        while (threads.lines.Pop(batch)) {
+            ScopedPhaseTimer timer(StatsPhase::TextSegment);
+            for (auto& source_line : batch) {
+                const int line_counter = source_line.line;
+                std::string& clean_line = source_line.text;
+
+                if (handleSegmentDirective(clean_line, current_state, input_path, line_counter,
+                                           reserved_text, reserved_data)) {
+                    for (auto& inst : reserved_text) encoder.AddInstruction(inst);
+                    for (auto& d : reserved_data) encoder.AddData(d);
+                    reserved_text.clear();
+                    reserved_data.clear();
+                    continue;
+                }
+
+                if (current_state == SegmentState::Global) {
+                    std::cerr << "Assembler Error: Statement found outside of any segment at " << input_path << ":" << line_counter << std::endl;
+                    return 1;
+                }
+
+                if (current_state == SegmentState::Data) {
+                    Data d; d.file = input_path; d.line = line_counter; d.assembly = std::move(clean_line);
+                    encoder.AddData(d);
+                } else {
+                    Instruction inst; inst.file = input_path; inst.line = line_counter; inst.assembly = std::move(clean_line);
+                    encoder.AddInstruction(inst);
+                }
+            }
+
+            OutputBatch finished = encoder.TakeFinished(false);
+            if (!finished.Empty()) threads.output.Push(std::move(finished));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Critical Error during parsing: " << e.what() << std::endl;
+        return 1;
+    }
+
+    threads.output.Push(encoder.TakeFinished(true));
+    threads.output.Close();
+    threads.writer.join();
+
+    // --mem-report 在输出写完后报告（同 --stream），出错提前返回时报告到出错为止的情况
+    auto finish = [&](int result) {
+        if (options.mem_report) encoder.PrintMemoryReport(std::cerr);
+        return result;
+    };
+
+    if (encoder.HasDataError()) {
+        std::cerr << "Error in Data Segment Generation." << std::endl;
+        return finish(1);
+    }
+    if (encoder.HasError()) {
+        std::cerr << "Error in Machine Code Generation." << std::endl;
+        return finish(1);
+    }
+    if (encoder.ReportUndefined()) {
+        std::cerr << "Error: Undefined symbols detected." << std::endl;
+        return finish(1);
+    }
+
+    AsyncOutputWriter writer;
+    {
+        ScopedPhaseTimer timer(StatsPhase::Output);
+        formatter.Finish();
+
+        if (options.patch) {
+            const std::string& base_dir =
+                options.patch_base.empty() ? output_dir : options.patch_base;
+            if (!encoder.WritePatchFiles(base_dir, output_dir)) return finish(1);
+        }
+
+        if (to_stdout) {
+            switch (options.stdout_format) {
+                case StdoutFormat::Prgm: std::cout << formatter.CodeImage(); break;
+                case StdoutFormat::Dmem: std::cout << formatter.DataImage(); break;
+                default: std::cout << formatter.Details(); break;
+            }
+            std::cout.flush();
+            if (!std::cout) return finish(1);
+        } else {
+            writer.Add(output_dir + "prgmip32.coe", formatter.CodeImage());
+            writer.Add(output_dir + "dmem32.coe", formatter.DataImage());
+            writer.Add(output_dir + "details.txt", formatter.Details());
+        }
+    }
+
+    if (!to_stdout && !FlushOutputs(writer)) return finish(1);
+
+    (to_stdout ? std::cerr : std::cout) << "Assembly completed successfully." << std::endl;
+    return finish(0);
+}
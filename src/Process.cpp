@@ -1,5 +1,9 @@
+#include <sstream>
+
 #include "Headers.h"
 
+static const size_t kMinShardRelocations = 16384;   // 并行回填时每个分片至少包含的引用数
+
 /**
  * @brief 处理代码段（Text Segment）
  * * 第一遍扫描的核心逻辑：
@@ -7,6 +11,8 @@
  * 2. 提取标签（Label）并建立符号表映射。
  * 3. 调用 DispatchInstruction 解析助记符和操作数，生成初步机器码。
  * 4. 记录未知符号到 unsolved_symbol_map 中，留待后续解析。
+ * 5. 局部 Label（见 LocalLabel.h）在所在函数的作用域内逐行回填，不进入符号表；
+ *    未定义的局部 Label 与全局符号一样留到 ResolveSymbols 报告为未定义的符号。
  * * @param instruction_list 指令列表（输入/输出）
  * @param unsolved_symbol_map 未解析符号表（输出），用于记录使用了尚未定义标签的指令
  * @param symbol_map 符号表（输出），记录 Label 对应的地址
@@ -17,40 +23,270 @@ bool AssemblerCore::ProcessTextSegment(InstructionList& instruction_list,
                                        SymbolMap& symbol_map) {
     current_address = 0; // PC 初始化
     has_error = false;
+    undefined_local = false;
+    LocalLabelScope<LocalRelocation> local_labels; // 当前函数的局部 Label
 
     for (auto& instruction : instruction_list) {
-        // 如果该指令已经被处理过，更新地址并跳过
-        if (instruction.done) {
-            instruction.address = current_address;
-            current_address += 4 * instruction.machine_code.size(); // MIPS 指令为 4 字节
-            continue;
+        std::string label;
+        bool error = ProcessInstruction(instruction, unsolved_symbol_map, symbol_map, &label);
+        if (ResolveLocalLabels(local_labels, label, instruction, unsolved_symbol_map)) error = true;
+        if (error) {
+            has_error = true;
         }
+    }
+    CloseLocalScope(local_labels);
+    return has_error;
+}
 
-        assert(instruction.machine_code.empty());
-        current_instruction_ptr = &instruction; // 记录当前指令指针，主要用于 try-catch 块中报错时的上下文定位
-
+/**
+ * @brief 局部 Label（见 LocalLabel.h）：登记本行定义的 Label，回填本行对局部 Label 的引用
+ * * 本行定义全局 Label 时先关闭上一个作用域。局部引用处理后从 refs 中移除，不进入第二遍扫描。
+ * @return true 如果发生错误, false 如果成功
+ */
+bool AssemblerCore::ResolveLocalLabels(LocalLabelScope<LocalRelocation>& scope,
+                                       const std::string& label, const Instruction& instruction,
+                                       UnsolvedSymbolMap& refs) {
+    bool error = false;
+    auto patch = [&](const LocalRelocation& local, unsigned address) {
         try {
-            // 1. 预处理：提取行首的 Label，剥离行尾的注释
-            // 返回的 assembly 是去除了 Label 和注释后的纯汇编语句（如 "add $t0, $t1, $t2"）
-            std::string assembly = ExtractLabelAndStripComment(current_address, instruction.assembly, symbol_map);
-            assembly = toUppercase(assembly); // 统一转大写，实现大小写不敏感
-            instruction.address = current_address; // 记录指令的当前 PC 地址
-
-            // 2. 解析指令
-            if (!assembly.empty()) {
-                // 分发给具体的指令处理函数（R/I/J/Macro），并在内部生成机器码模板
-                // DispatchInstruction 内部会执行 current_address += 4
-                DispatchInstruction(assembly, instruction, unsolved_symbol_map);
-            }
+            PatchSymbol(*local.ref.machine_code_handle, local.ref.instruction->address, address,
+                        local.addend);
         } catch (const std::exception& e) {
-            LogError(e.what(), instruction.assembly);
-            has_error = true;
+            LogError(e.what(), "Resolving " + LocalLabelName(local.symbol));
+            error = true;
+        }
+    };
+
+    if (!label.empty() && !isLocalLabel(label)) {
+        CloseLocalScope(scope);
+    } else if (!label.empty()) {
+        auto resolve = [&](const std::string&, const LocalRelocation& local, unsigned address) {
+            patch(local, address);
+        };
+        if (!scope.Define(label, instruction.address, resolve)) {
+            last_error_token = label;
+            LogError("Redefined symbol: " + LocalLabelName(label), instruction.assembly);
+            error = true;
         }
-        
-        instruction.done = true; // 标记处理完成
-        current_instruction_ptr = nullptr;
     }
-    return has_error;
+
+    for (const auto& local : refs.Locals()) {
+        unsigned address = 0;
+        switch (scope.Reference(local.symbol, local, address)) {
+            case LocalLabelScope<LocalRelocation>::Lookup::Resolved:
+                patch(local, address);
+                break;
+            case LocalLabelScope<LocalRelocation>::Lookup::Undefined:
+                LogError("Unknown Symbol: " + LocalLabelName(local.symbol), instruction.assembly);
+                undefined_local = true;
+                break;
+            case LocalLabelScope<LocalRelocation>::Lookup::Pending:
+                break;
+        }
+    }
+    refs.ClearLocals();
+    return error;
+}
+
+/**
+ * @brief 关闭局部 Label 的作用域，仍在等待的前向引用报告为未定义的符号
+ * * 与全局符号相同，未定义的局部 Label 不算编码错误，由 ResolveSymbols 一并返回。
+ */
+void AssemblerCore::CloseLocalScope(LocalLabelScope<LocalRelocation>& scope) {
+    scope.Close([&](const std::string& symbol, const std::vector<LocalRelocation>&) {
+        LogError("Unknown Symbol: " + LocalLabelName(symbol));
+        undefined_local = true;
+    });
+}
+
+/**
+ * @brief 处理单条指令（ProcessTextSegment 的循环体，流式汇编也逐行调用它）
+ * * 指令地址取 current_address，处理后 current_address 指向下一条指令。
+ * * @param defined_label 非空时，若该行定义了 Label，则写入 Label 名
+ * @return true 如果发生错误, false 如果成功
+ */
+bool AssemblerCore::ProcessInstruction(Instruction& instruction,
+                                       UnsolvedSymbolMap& unsolved_symbol_map,
+                                       SymbolMap& symbol_map,
+                                       std::string* defined_label) {
+    // 如果该指令已经被处理过，更新地址并跳过
+    if (instruction.done) {
+        instruction.address = current_address;
+        current_address += 4 * instruction.machine_code.size(); // MIPS 指令为 4 字节
+        return false;
+    }
+
+    assert(instruction.machine_code.empty());
+    assert(&unsolved_symbol_map.Names() == &symbol_map.Names());
+
+    // 缓存命中：跳过解析，直接使用缓存的编码结果
+    if (cache) {
+        CacheEntry* entry = cache->Find(AssemblyCache::Kind::Text, instruction.assembly);
+        CountCache(entry != nullptr);
+        if (entry) {
+            return ApplyCachedInstruction(*entry, instruction, unsolved_symbol_map, symbol_map,
+                                          defined_label);
+        }
+    }
+
+    current_instruction_ptr = &instruction; // 记录当前指令指针，主要用于 try-catch 块中报错时的上下文定位
+    bool error = false;
+    std::string error_message;
+
+    // 开启缓存时，本行的 Label、符号引用和警告先记录在局部，编码完成后登记到缓存
+    std::string label;
+    UnsolvedSymbolMap line_refs(symbol_map.Names());
+    std::ostringstream diagnostics;
+    std::ostream* previous_diag = cache ? SetDiagStream(&diagnostics) : nullptr;
+    UnsolvedSymbolMap& refs = cache ? line_refs : unsolved_symbol_map;
+
+    try {
+        // 1. 预处理：提取行首的 Label，剥离行尾的注释
+        // 返回的 assembly 是去除了 Label 和注释后的纯汇编语句（如 "add $t0, $t1, $t2"）
+        // 复用 statement 的缓冲区，逐行处理不再为语句文本分配内存
+        statement.assign(ExtractLabelAndStripComment(current_address, instruction.assembly,
+                                                     symbol_map, &label));
+        statement = toCanonicalCase(std::move(statement)); // 统一转大写，实现大小写不敏感（局部 Label 的 .L 除外）
+        instruction.address = current_address; // 记录指令的当前 PC 地址
+
+        // 2. 解析指令
+        if (!statement.empty()) {
+            // 分发给具体的指令处理函数（R/I/J/Macro），并在内部生成机器码模板
+            // 相同的语句之前编码过时直接套用结果；current_address 按机器码条数推进
+            EncodeInstruction(statement, instruction, refs);
+        }
+    } catch (const std::exception& e) {
+        error_message = e.what();
+        NoteErrorToken(e);
+        error = true;
+    }
+
+    if (defined_label && !label.empty()) *defined_label = label;
+
+    if (cache) {
+        SetDiagStream(previous_diag);
+        Diag() << diagnostics.str();
+
+        CacheEntry entry;
+        for (const auto& relocation : line_refs) {
+            unsigned index = relocation.ref.machine_code_handle - instruction.machine_code.begin();
+            entry.relocations.push_back(RelocationTemplate{
+                index, std::string(symbol_map.Names().Name(relocation.symbol)), relocation.addend});
+            unsolved_symbol_map.Add(relocation.symbol, relocation.ref, relocation.addend);
+        }
+        for (const auto& local : line_refs.Locals()) {
+            unsigned index = local.ref.machine_code_handle - instruction.machine_code.begin();
+            entry.relocations.push_back(RelocationTemplate{index, local.symbol, local.addend});
+            unsolved_symbol_map.Add(local.symbol, local.ref, local.addend);
+        }
+        if (!error) {
+            entry.text = instruction.assembly;
+            entry.label = label;
+            entry.machine_code.assign(instruction.machine_code.begin(), instruction.machine_code.end());
+            entry.diagnostics = diagnostics.str();
+            cache->Store(AssemblyCache::Kind::Text, std::move(entry));
+        }
+    }
+
+    if (error) LogError(error_message, instruction.assembly);
+
+    instruction.done = true; // 标记处理完成
+    current_instruction_ptr = nullptr;
+    return error;
+}
+
+/**
+ * @brief 编码一条语句，相同的语句在本次运行中只解析一次
+ * * 命中时复制机器码、按模板登记符号引用并重放警告；
+ * * 未命中时调用 DispatchInstruction，成功后记入 encoding_memo。
+ */
+void AssemblerCore::EncodeInstruction(const std::string& assembly, Instruction& instruction,
+                                      UnsolvedSymbolMap& refs) {
+    auto memo = encoding_memo.find(assembly);
+    CountMemo(memo != encoding_memo.end());
+    if (memo != encoding_memo.end()) {
+        CountStatement(true);
+        instruction.machine_code.assign(memo->second.machine_code.begin(),
+                                        memo->second.machine_code.end());
+        current_address += 4 * instruction.machine_code.size();
+        for (const auto& [index, symbol, addend] : memo->second.relocations) {
+            refs.Add(symbol, SymbolRef{instruction.machine_code.begin() + index, &instruction},
+                     addend);
+        }
+        Diag() << memo->second.diagnostics;
+        return;
+    }
+
+    // 符号引用与警告先记录在局部，编码成功后生成模板（出错时异常直接向上传递）
+    UnsolvedSymbolMap line_refs(refs.Names());
+    std::ostringstream diagnostics;
+    std::ostream* previous_diag = SetDiagStream(&diagnostics);
+    try {
+        DispatchInstruction(assembly, instruction, line_refs);
+    } catch (...) {
+        SetDiagStream(previous_diag);
+        Diag() << diagnostics.str();
+        throw;
+    }
+    SetDiagStream(previous_diag);
+    Diag() << diagnostics.str();
+
+    EncodingMemo entry;
+    for (const auto& relocation : line_refs) {
+        unsigned index = relocation.ref.machine_code_handle - instruction.machine_code.begin();
+        entry.relocations.push_back(RelocationTemplate{
+            index, std::string(refs.Names().Name(relocation.symbol)), relocation.addend});
+        refs.Add(relocation.symbol, relocation.ref, relocation.addend);
+    }
+    for (const auto& local : line_refs.Locals()) {
+        unsigned index = local.ref.machine_code_handle - instruction.machine_code.begin();
+        entry.relocations.push_back(RelocationTemplate{index, local.symbol, local.addend});
+        refs.Add(local.symbol, local.ref, local.addend);
+    }
+
+    if (encoding_memo.size() >= kMaxMemoEntries) encoding_memo.clear();
+    entry.machine_code.assign(instruction.machine_code.begin(), instruction.machine_code.end());
+    entry.diagnostics = diagnostics.str();
+    encoding_memo.emplace(assembly, std::move(entry));
+}
+
+/**
+ * @brief 缓存命中时处理单条指令：登记 Label、复制机器码、重新登记符号引用
+ * * 与重新解析的结果完全一致，包括 Label 重复定义的报错与编码时的警告。
+ * @return true 如果发生错误, false 如果成功
+ */
+bool AssemblerCore::ApplyCachedInstruction(const CacheEntry& entry,
+                                           Instruction& instruction,
+                                           UnsolvedSymbolMap& unsolved_symbol_map,
+                                           SymbolMap& symbol_map,
+                                           std::string* defined_label) {
+    instruction.done = true;
+    if (!DefineCachedLabel(entry.label, instruction.assembly, symbol_map, defined_label))
+        return true;
+
+    instruction.address = current_address;
+    instruction.machine_code.assign(entry.machine_code.begin(), entry.machine_code.end());
+    current_address += 4 * instruction.machine_code.size();
+    if (!instruction.machine_code.empty()) CountStatement(true);
+
+    Diag() << entry.diagnostics;
+    for (const auto& [index, symbol, addend] : entry.relocations) {
+        unsolved_symbol_map.Add(symbol, SymbolRef{instruction.machine_code.begin() + index, &instruction},
+                                addend);
+    }
+    return false;
+}
+
+bool AssemblerCore::DefineCachedLabel(const std::string& label, std::string_view assembly,
+                                      SymbolMap& symbol_map, std::string* defined_label) {
+    if (label.empty()) return true;
+    if (!isLocalLabel(label) && !symbol_map.Define(label, current_address)) {
+        last_error_token = label;
+        LogError("Redefined symbol: " + label, assembly);
+        return false;
+    }
+    if (defined_label) *defined_label = label;
+    return true;
 }
 
 /**
@@ -66,103 +302,222 @@ bool AssemblerCore::ProcessDataSegment(DataList& data_list, SymbolMap& symbol_ma
     has_error = false;
 
     for (auto& data : data_list) {
-        if (data.done) {
-            data.address = current_address;
-            current_address += data.raw_data.size();
-            continue;
+        if (ProcessData(data, symbol_map)) {
+            has_error = true;
         }
+    }
+    return has_error;
+}
 
-        assert(data.raw_data.empty());
-        
-        // 报错统一使用 Instruction* 类型。
-        current_instruction_ptr = reinterpret_cast<const Instruction*>(&data); 
+/**
+ * @brief 处理单条数据定义（ProcessDataSegment 的循环体）
+ * * @param defined_label 非空时，若该行定义了 Label，则写入 Label 名
+ * @return true 如果有错, false 成功
+ */
+bool AssemblerCore::ProcessData(Data& data, SymbolMap& symbol_map, std::string* defined_label) {
+    if (data.done) {
+        data.address = current_address;
+        current_address += data.raw_data.size();
+        return false;
+    }
 
-        try {
-            // 提取 Label (例如: "arr: .word 1, 2, 3")
-            std::string assembly = ExtractLabelAndStripComment(current_address, data.assembly, symbol_map);
-            assembly = toUppercase(assembly);
+    assert(data.raw_data.empty());
 
-            data.address = current_address;
+    if (cache) {
+        CacheEntry* entry = cache->Find(AssemblyCache::Kind::Data, data.assembly);
+        CountCache(entry != nullptr);
+        if (entry) return ApplyCachedData(*entry, data, symbol_map, defined_label);
+    }
 
-            if (!assembly.empty()) {
-                // 解析 .word, .byte 等指令并填充 data.raw_data
-                DispatchData(assembly, data);
-            }
-        } catch (const std::exception& e) {
-            LogError(e.what(), data.assembly);
-            has_error = true;
+    // 报错统一使用 Instruction* 类型。
+    current_instruction_ptr = reinterpret_cast<const Instruction*>(&data);
+    bool error = false;
+    std::string label;
+
+    try {
+        // 提取 Label (例如: "arr: .word 1, 2, 3")
+        statement.assign(ExtractLabelAndStripComment(current_address, data.assembly,
+                                                     symbol_map, &label));
+        statement = toUppercase(std::move(statement));
+        if (isLocalLabel(label))
+            throw std::runtime_error("Local label outside the text segment: " + LocalLabelName(label));
+
+        data.address = current_address;
+
+        if (!statement.empty()) {
+            // 解析 .word, .byte 等指令并填充 data.raw_data
+            DispatchData(statement, data);
         }
+    } catch (const std::exception& e) {
+        NoteErrorToken(e);
+        LogError(e.what(), data.assembly);
+        error = true;
+    }
 
-        data.done = true;
-        current_instruction_ptr = nullptr;
+    if (defined_label && !label.empty()) *defined_label = label;
+    if (cache && !error) {
+        CacheEntry entry;
+        entry.text = data.assembly;
+        entry.label = label;
+        entry.raw_data.assign(data.raw_data.begin(), data.raw_data.end());
+        cache->Store(AssemblyCache::Kind::Data, std::move(entry));
     }
-    return has_error;
+
+    data.done = true;
+    current_instruction_ptr = nullptr;
+    return error;
+}
+
+/**
+ * @brief 缓存命中时处理单条数据定义
+ * @return true 如果有错, false 成功
+ */
+bool AssemblerCore::ApplyCachedData(const CacheEntry& entry, Data& data, SymbolMap& symbol_map,
+                                    std::string* defined_label) {
+    data.done = true;
+    if (!DefineCachedLabel(entry.label, data.assembly, symbol_map, defined_label)) return true;
+
+    data.address = current_address;
+    data.raw_data.assign(entry.raw_data.begin(), entry.raw_data.end());
+    current_address += data.raw_data.size();
+    if (!data.raw_data.empty()) CountStatement(false);
+    return false;
 }
 
 /**
  * @brief 符号重定位/回填（Back-patching）
  * * 在所有代码扫描完成后调用。遍历之前记录的“未解决符号”，
  * 在完整的符号表中查找地址，并填入对应的机器码字段中。
+ * * 引用较多时按登记顺序切成连续的分片并行回填（每条引用回填不同的机器码，分片之间互不影响），
+ * 各分片的错误先记在自己的缓冲区中，最后按分片顺序（即引用顺序，两遍扫描中也是地址顺序）输出，
+ * 因此回填结果和错误信息与逐条处理完全相同。
  * * @param unsolved_symbol_map 待解决的符号引用集合
  * @param symbol_map 完整的符号地址表
- * @return true 如果有未定义的符号或解析错误, false 成功
+ * @return true 如果有未定义的符号（含第一遍扫描中已报告的未定义局部 Label）或解析错误, false 成功
  */
 bool AssemblerCore::ResolveSymbols(UnsolvedSymbolMap& unsolved_symbol_map,
                                    const SymbolMap& symbol_map) {
-    has_error = false;
+    has_error = undefined_local;
+
+    const size_t n = unsolved_symbol_map.size();
+    const unsigned threads = resolve_threads ? resolve_threads
+                                             : std::max(1u, std::thread::hardware_concurrency());
+    const size_t shards = std::max<size_t>(1, std::min<size_t>(threads, n / kMinShardRelocations));
+
+    // 第 0 片在当前线程上处理（与 ReadSource 相同）
+    std::vector<std::vector<ResolveError>> errors(shards);
+    auto run = [&](size_t k) {
+        ResolveShard(unsolved_symbol_map, symbol_map, n * k / shards, n * (k + 1) / shards, errors[k]);
+    };
+    std::vector<std::thread> workers;
+    for (size_t k = 1; k < shards; k++) workers.emplace_back(run, k);
+    run(0);
+    for (auto& worker : workers) worker.join();
+
+    // 未定义的符号只报告一次（按第一次引用的顺序）
+    std::vector<bool> reported(symbol_map.Names().Size(), false);
+    for (const auto& shard : errors) {
+        for (const auto& error : shard) {
+            if (error.unknown != kNoSymbol) {
+                if (reported[error.unknown]) continue;
+                reported[error.unknown] = true;
+            }
+            LogError(error.message, error.context);
+            has_error = true;
+        }
+    }
+    return has_error;
+}
+
+/**
+ * @brief 回填 [begin, end) 范围内的引用，错误按引用顺序记入 errors（不直接输出）
+ * * 只读符号表，只写各引用自己的机器码，可以在多个线程上同时处理不相交的范围。
+ */
+void AssemblerCore::ResolveShard(const UnsolvedSymbolMap& unsolved_symbol_map,
+                                 const SymbolMap& symbol_map, size_t begin, size_t end,
+                                 std::vector<ResolveError>& errors) const {
+    // 分片内未定义的符号也只记录一次
+    std::vector<bool> reported(symbol_map.Names().Size(), false);
+
+    for (auto it = unsolved_symbol_map.begin() + begin; it != unsolved_symbol_map.begin() + end; ++it) {
+        const Relocation& relocation = *it;
+        const SymbolId symbol = relocation.symbol;
 
-    for (const auto& [symbol, references] : unsolved_symbol_map) {
-        
         // 检查符号是否存在于全局符号表中
-        if (symbol_map.find(symbol) == symbol_map.end()) {
-            LogError("Unknown Symbol: " + symbol);
-            has_error = true;
+        if (!symbol_map.IsDefined(symbol)) {
+            if (!reported[symbol]) {
+                reported[symbol] = true;
+                errors.push_back(ResolveError{
+                    symbol, "Unknown Symbol: " + std::string(symbol_map.Names().Name(symbol)), ""});
+            }
             continue; // 发生错误但不影响检查其他符号，继续循环
         }
 
-        int symbol_addr = symbol_map.at(symbol); // 目标符号的绝对地址
-
-        // 遍历所有引用了该符号的指令位置
-        for (const auto& ref : references) {
-            try {
-                current_instruction_ptr = ref.instruction;
-                unsigned inst_addr = current_instruction_ptr->address; // 引用了该符号的指令地址
-                MachineCode& machine_code = *ref.machine_code_handle;  // 指向机器码的引用
-
-                // 根据指令格式回填不同的字段
-                if (isR_Format(machine_code)) {
-                    SetShamt(machine_code, symbol_addr);
-                } 
-                else if (isI_Format(machine_code)) {
-                    int imm = symbol_addr;
-                    int op = machine_code >> 26; // 提取高6位 Opcode
-
-                    // 分支指令 (beq, bne 等) 使用相对寻址
-                    // Offset = (Target Address - (Current PC + 4)) / 4
-                    if (IsBranchOpcode(op)) {
-                        imm -= (inst_addr + 4); // 减去 (PC + 4)
-                        imm >>= 2;              // 除以 4 (右移2位)
-                    }
-                    // 普通 I-Format (如 lw, addi) 使用绝对地址的低16位或者立即数
-                    SetImmediate(machine_code, imm);
-                } 
-                else if (isJ_Format(machine_code)) {
-                    // J-Format (j, jal) 使用伪绝对寻址
-                    // Target = Address >> 2
-                    SetAddress(machine_code, symbol_addr >> 2);
-                } 
-                else {
-                    throw std::runtime_error("Unknown instruction format during symbol resolution.");
-                }
-
-            } catch (const std::exception& e) {
-                LogError(e.what(), "Resolving " + symbol);
-                has_error = true;
-            }
+        try {
+            unsigned inst_addr = relocation.ref.instruction->address; // 引用了该符号的指令地址
+            int symbol_addr = symbol_map.Address(symbol);             // 目标符号的绝对地址
+            PatchSymbol(*relocation.ref.machine_code_handle, inst_addr, symbol_addr,
+                        relocation.addend);
+        } catch (const std::exception& e) {
+            errors.push_back(ResolveError{
+                kNoSymbol, e.what(), "Resolving " + std::string(symbol_map.Names().Name(symbol))});
         }
     }
-    current_instruction_ptr = nullptr;
-    return has_error;
+}
+
+/**
+ * @brief 按指令格式把符号地址回填进一条机器码
+ * * @param machine_code 需要回填的机器码
+ * @param inst_addr 引用了该符号的指令地址（分支指令计算相对偏移用）
+ * @param symbol_addr 目标符号的绝对地址
+ * @param addend 引用中的常量部分与 %hi/%lo（见 Expression.h），回填的是 symbol_addr + addend
+ */
+void AssemblerCore::PatchSymbol(MachineCode& machine_code, unsigned inst_addr,
+                                int symbol_addr, Addend addend) const {
+    // 由机器码查指令表，按表中的回填方式替换对应字段，回填前按字段检查范围
+    const OpcodeInfo* info = DecodeOpcode(machine_code);
+    const Fixup fixup = info ? info->fixup : Fixup::None;
+    const long long target = static_cast<long long>(symbol_addr) + addend.value;
+
+    // %hi/%lo：取出的半字直接写入 16 位立即数，不检查范围
+    if (addend.part != AddressPart::Whole) {
+        if (fixup != Fixup::Abs16)
+            throw std::runtime_error("%HI/%LO can only be used as a 16-bit immediate.");
+        machine_code = ImmediateField::Replace(machine_code, AddressHalf(target, addend.part));
+        return;
+    }
+
+    switch (fixup) {
+        case Fixup::Shamt:
+            machine_code = ShamtField::Replace(
+                machine_code, CheckUnsigned(target, ShamtField::kWidth, "Shamt"));
+            break;
+
+        // 分支指令 (beq, bne 等) 使用相对寻址
+        // Offset = (Target Address - (Current PC + 4)) / 4，符号扩展
+        case Fixup::Rel16: {
+            long long offset = (target - (inst_addr + 4)) >> 2;
+            machine_code = ImmediateField::Replace(
+                machine_code, CheckSigned(offset, ImmediateField::kWidth, "Branch offset"));
+            break;
+        }
+
+        // 普通 I-Format (如 lw, addi) 使用符号的绝对地址，须放得下 16 位
+        case Fixup::Abs16:
+            machine_code = ImmediateField::Replace(
+                machine_code, CheckUnsigned(target, ImmediateField::kWidth, "Immediate"));
+            break;
+
+        // J-Format (j, jal) 使用伪绝对寻址
+        // Target = Address >> 2
+        case Fixup::Abs26:
+            machine_code = AddressField::Replace(
+                machine_code, CheckUnsigned(target >> 2, AddressField::kWidth, "Address"));
+            break;
+
+        case Fixup::None:
+            throw std::runtime_error("Unknown instruction format during symbol resolution.");
+    }
 }
 
 /**
@@ -171,24 +526,43 @@ bool AssemblerCore::ResolveSymbols(UnsolvedSymbolMap& unsolved_symbol_map,
  */
 void AssemblerCore::DispatchInstruction(const std::string& assembly, Instruction& instruction,
                                         UnsolvedSymbolMap& unsolved_symbol_map) {
+    CountStatement(true);
     std::string mnemonic = GetMnemonic(assembly); // 获取第一个单词作为助记符
     MachineCodeIt handle = NewMachineCode(instruction); // 在 instruction 中分配一个新的机器码槽位
     
     // 统一转大写
     std::string upMnemonic = toUppercase(mnemonic);
 
-    // 根据助记符特征分发到具体的解析逻辑
-    if (isR_Format(mnemonic)) {
-        R_FormatInstruction(upMnemonic, assembly, unsolved_symbol_map, handle, &instruction);
-    } else if (isI_Format(mnemonic)) {
-        I_FormatInstruction(upMnemonic, assembly, unsolved_symbol_map, handle, &instruction);
-    } else if (isJ_Format(mnemonic)) {
-        J_FormatInstruction(upMnemonic, assembly, unsolved_symbol_map, handle, &instruction);
-    } else if (isMacro_Format(mnemonic)) {
-        // 伪指令（Macro）可能展开为多条机器码，需要当前地址上下文
-        Macro_FormatInstruction(upMnemonic, assembly, unsolved_symbol_map, handle, current_address, &instruction);
-    } else {
-        throw UnknownInstruction(mnemonic);
+    // .word：在代码段中直接写入一个字（反汇编把无法解码的字写成 .word），值与数据段一样为常量表达式
+    if (upMnemonic == ".WORD") {
+        std::string op1, op2, op3;
+        GetOperand(assembly, op1, op2, op3);
+        if (!op2.empty()) throw TooManyOperand(upMnemonic);
+        Operand operand;
+        if (!TryParseOperand(op1, operand) || !operand.IsConstant()) throw ExceptNumber(op1);
+        *handle = static_cast<uint32_t>(operand.value);
+        current_address += 4;
+        return;
+    }
+
+    // 按指令表中的格式分发到具体的解析逻辑（助记符查找为完美哈希，见 Isa.h）
+    const OpcodeInfo* info = FindOpcode(mnemonic);
+    if (info == nullptr) throw UnknownInstruction(mnemonic);
+
+    switch (info->format) {
+        case Format::R:
+            R_FormatInstruction(upMnemonic, assembly, unsolved_symbol_map, handle, &instruction);
+            break;
+        case Format::I:
+            I_FormatInstruction(upMnemonic, assembly, unsolved_symbol_map, handle, &instruction);
+            break;
+        case Format::J:
+            J_FormatInstruction(upMnemonic, assembly, unsolved_symbol_map, handle, &instruction);
+            break;
+        case Format::Macro:
+            // 伪指令（Macro）可能展开为多条机器码，需要当前地址上下文
+            Macro_FormatInstruction(upMnemonic, assembly, unsolved_symbol_map, handle, current_address, &instruction);
+            break;
     }
 
     current_address += 4; // MIPS 指令长度固定为 4 字节
@@ -210,7 +584,10 @@ void AssemblerCore::DispatchData(const std::string& assembly, Data& data) {
     // Group 1: 数值, Group 2: 重复次数 (可选)
     static const std::regex re_token(R"(^([^:,\s]+)\s*(?:\:\s*([^:,\s]+))?(\s*,\s*)?)", std::regex::icase);
 
+    CountStatement(false);
+
     std::cmatch m;
+    CountRegex(RegexSite::DispatchData);
     if (!std::regex_search(assembly.c_str(), m, re_type)) {
         return; // 不是数据定义指令，直接返回
     }
@@ -221,6 +598,7 @@ void AssemblerCore::DispatchData(const std::string& assembly, Data& data) {
     // 循环解析逗号分隔的数据项
     while (!data_stream_str.empty()) {
         std::cmatch token_match;
+        CountRegex(RegexSite::DispatchData);
         if (!std::regex_search(data_stream_str.c_str(), token_match, re_token)) {
             break;
         }
@@ -238,8 +616,10 @@ void AssemblerCore::DispatchData(const std::string& assembly, Data& data) {
             repeat_count = toUNumber(rep_str);
         }
 
-        if (!isNumber(val_str)) throw ExceptNumber(val_str);
-        uint32_t val = toNumber(val_str);
+        // 值可以是常量表达式（数据段没有回填，不能引用符号）
+        Operand operand;
+        if (!TryParseOperand(val_str, operand) || !operand.IsConstant()) throw ExceptNumber(val_str);
+        uint32_t val = operand.value;
 
         // 根据类型将数据按小端序写入 raw_data
         for (unsigned i = 0; i < repeat_count; i++) {
@@ -273,44 +653,53 @@ void AssemblerCore::DispatchData(const std::string& assembly, Data& data) {
  * * @param address 当前指令地址
  * @param assembly 原始汇编字符串
  * @param symbol_map 符号表
- * @return std::string 清理后的汇编指令
+ * @param defined_label 非空时写入本行定义的 Label（没有则不修改）
+ * @return 清理后的汇编指令（assembly 的子串）
  */
-std::string AssemblerCore::ExtractLabelAndStripComment(unsigned int address, 
-                                                       const std::string& assembly, 
-                                                       SymbolMap& symbol_map) {
-    // 正则解释:
-    // \s* : 忽略行首空白
-    // (?:(\S+?)\s*:)?  : 可选组。捕获非空字符(\S+)作为Label(Group 1)，后跟冒号
-    // \s* : Label后的空白
-    // ([^#]*?)         : 捕获指令主体(Group 2)，匹配非 '#' 的字符
-    // \s* : 指令后的空白
-    // (?:#.*)?         : 可选组。匹配 '#' 开头的注释直到行尾
-    static const std::regex re_line(R"(\s*(?:(\S+?)\s*:)?\s*([^#]*?)\s*(?:#.*)?)");
-    std::smatch match;
-
-    if (std::regex_match(assembly, match, re_line)) {
-        // 如果匹配到了 Label (Group 1)
-        if (match[1].matched) {
-            std::string label = toUppercase(match[1].str());
-            // 查重：不允许重复定义 Label
-            if (symbol_map.find(label) != symbol_map.end()) {
-                throw std::runtime_error("Redefined symbol: " + label);
-            }
-            symbol_map[label] = address;
+std::string_view AssemblerCore::ExtractLabelAndStripComment(unsigned int address,
+                                                            std::string_view assembly,
+                                                       SymbolMap& symbol_map,
+                                                       std::string* defined_label) {
+    // 按原来的正则 \s*(?:(\S+?)\s*:)?\s*([^#]*?)\s*(?:#.*)? 的语义扫描：
+    //   Label：第一个非空白串中第一个冒号之前的部分；串中没有冒号时，
+    //          串后（可隔空白）紧跟冒号则整个串为 Label
+    //   指令主体：Label（或行首空白）之后到第一个 '#' 之前，去掉首尾空白
+    //   注释中不能含有 \r 或 \n。不满足时依次尝试更长的 Label（串中后面的冒号），
+    //   都不满足则不定义 Label；仍不满足时整行不匹配，返回空串
+    const size_t n = assembly.size();
+    const size_t begin = ScanFirstNot(assembly, 0, kCharSpace);
+    const size_t run_end = ScanFirst(assembly, begin, kCharSpace);
+
+    size_t colon = begin < n ? ScanFirst(assembly, begin + 1, kCharColon) : n;
+    size_t body = begin, hash = n;
+    auto comment_ok = [&](size_t from) {
+        body = ScanFirstNot(assembly, from, kCharSpace);
+        hash = ScanFirst(assembly, body, kCharHash);
+        return hash == n || ScanFirst(assembly, hash + 1, kCharLineEnd) == n;
+    };
+    while (true) {
+        if (colon >= run_end) {
+            // 串中的冒号都不满足：尝试串后的冒号
+            size_t next = begin < n ? ScanFirstNot(assembly, run_end, kCharSpace) : n;
+            colon = next < n && assembly[next] == ':' && comment_ok(next + 1) ? next : n;
+            break;
         }
-        // 返回指令部分 (Group 2)
-        return match[2].str();
+        if (comment_ok(colon + 1)) break;
+        colon = ScanFirst(assembly, colon + 1, kCharColon);
     }
-    return "";
-}
-
-/**
- * @brief 辅助判断 Opcode 是否为 MIPS 分支指令
- * * 用于在符号解析时判断是否需要计算相对偏移量
- */
-bool AssemblerCore::IsBranchOpcode(int op) const {
-    if (op == 0b000001 || (op >> 2) == 1) return true; // 所有的分支指令
-    return false;
+    if (colon == n && !comment_ok(begin)) return "";
+
+    if (colon < n) {
+        size_t label_end = std::min(run_end, colon);
+        std::string label = toCanonicalCase(std::string(assembly.substr(begin, label_end - begin)));
+        // 查重：不允许重复定义 Label（局部 Label 不进入符号表，由调用方登记到所在作用域）
+        if (!isLocalLabel(label) && !symbol_map.Define(label, address)) {
+            throw std::runtime_error("Redefined symbol: " + label);
+        }
+        if (defined_label) *defined_label = label;
+    }
+    // 返回指令部分
+    return assembly.substr(body, ScanLastNot(assembly, body, hash, kCharSpace) - body);
 }
 
 /**
@@ -318,10 +707,18 @@ bool AssemblerCore::IsBranchOpcode(int op) const {
  * @param msg 错误信息
  * @param context 上下文信息（如出错的汇编代码行）
  */
-void AssemblerCore::LogError(const std::string& msg, const std::string& context) {
+void AssemblerCore::LogError(const std::string& msg, std::string_view context) {
+    last_error = msg;
+    if (quiet) return;
+
     std::cerr << "[Error] " << msg;
     if (!context.empty()) {
         std::cerr << " | Context: " << context;
     }
     std::cerr << std::endl;
-}
\ No newline at end of file
+}
+
+void AssemblerCore::NoteErrorToken(const std::exception& e) {
+    const auto* error = dynamic_cast<const AssemblerError*>(&e);
+    last_error_token = error ? error->Token() : std::string();
+}
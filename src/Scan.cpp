@@ -0,0 +1,150 @@
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MAS_SCAN_X86 1
+#endif
+
+#include "Headers.h"
+
+/*
+ * 逐字节分类表（标量实现与 ScanLastNot 使用）
+ */
+struct CharClassTable {
+    std::uint8_t bits[256] = {};
+
+    CharClassTable() {
+        for (unsigned char c : {' ', '\t', '\n', '\v', '\f', '\r'}) bits[c] |= kCharSpace;
+        bits[static_cast<unsigned char>('#')] |= kCharHash;
+        bits[static_cast<unsigned char>(':')] |= kCharColon;
+        bits[static_cast<unsigned char>(',')] |= kCharComma;
+        bits[static_cast<unsigned char>('(')] |= kCharParen;
+        bits[static_cast<unsigned char>(')')] |= kCharParen;
+        bits[static_cast<unsigned char>('\n')] |= kCharLineEnd;
+        bits[static_cast<unsigned char>('\r')] |= kCharLineEnd;
+    }
+};
+static const CharClassTable g_table;
+
+static std::uint64_t ClassifyScalar(const char* p, size_t n, unsigned classes) {
+    std::uint64_t mask = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (g_table.bits[static_cast<unsigned char>(p[i])] & classes) mask |= std::uint64_t(1) << i;
+    }
+    return mask;
+}
+
+#ifdef MAS_SCAN_X86
+/*
+ * 向量实现：每个类别一次比较，结果按位或后用 movemask 取出每字节的最高位
+ * 空白中的 \t..\r 是连续的 9..13，用无符号的 (x - 9) <= 4 判断
+ * 不足一组的尾部先复制到补 0 的缓冲区（0 不属于任何类别），避免越界读取
+ */
+#define MAS_CLASSIFY_BODY(V, SET1, CMPEQ, OR, SUB, MIN, MOVEMASK)                 \
+    V mask = SET1(0);                                                             \
+    if (classes & kCharSpace) {                                                   \
+        V t = SUB(x, SET1(9));                                                    \
+        mask = OR(mask, CMPEQ(MIN(t, SET1(4)), t));                               \
+        mask = OR(mask, CMPEQ(x, SET1(' ')));                                     \
+    }                                                                             \
+    if (classes & kCharHash) mask = OR(mask, CMPEQ(x, SET1('#')));                \
+    if (classes & kCharColon) mask = OR(mask, CMPEQ(x, SET1(':')));               \
+    if (classes & kCharComma) mask = OR(mask, CMPEQ(x, SET1(',')));               \
+    if (classes & kCharParen) {                                                   \
+        mask = OR(mask, CMPEQ(x, SET1('(')));                                     \
+        mask = OR(mask, CMPEQ(x, SET1(')')));                                     \
+    }                                                                             \
+    if (classes & kCharLineEnd) {                                                 \
+        mask = OR(mask, CMPEQ(x, SET1('\n')));                                    \
+        mask = OR(mask, CMPEQ(x, SET1('\r')));                                    \
+    }                                                                             \
+    return static_cast<std::uint32_t>(MOVEMASK(mask));
+
+static inline std::uint32_t Classify16(const char* p, unsigned classes) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    MAS_CLASSIFY_BODY(__m128i, _mm_set1_epi8, _mm_cmpeq_epi8, _mm_or_si128, _mm_sub_epi8,
+                      _mm_min_epu8, _mm_movemask_epi8)
+}
+
+__attribute__((target("avx2"))) static inline std::uint32_t Classify32(const char* p,
+                                                                       unsigned classes) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    MAS_CLASSIFY_BODY(__m256i, _mm256_set1_epi8, _mm256_cmpeq_epi8, _mm256_or_si256,
+                      _mm256_sub_epi8, _mm256_min_epu8, _mm256_movemask_epi8)
+}
+#undef MAS_CLASSIFY_BODY
+
+static std::uint64_t ClassifySse2(const char* p, size_t n, unsigned classes) {
+    alignas(16) char buffer[64];
+    if (n < 64) {
+        std::memcpy(buffer, p, n);
+        std::memset(buffer + n, 0, sizeof(buffer) - n);
+        p = buffer;
+    }
+    std::uint64_t mask = 0;
+    for (size_t k = 0; k < n; k += 16) {
+        mask |= static_cast<std::uint64_t>(Classify16(p + k, classes)) << k;
+    }
+    return n < 64 ? mask & ((std::uint64_t(1) << n) - 1) : mask;
+}
+
+__attribute__((target("avx2"))) static std::uint64_t ClassifyAvx2(const char* p, size_t n,
+                                                                  unsigned classes) {
+    alignas(32) char buffer[64];
+    if (n < 64) {
+        std::memcpy(buffer, p, n);
+        std::memset(buffer + n, 0, sizeof(buffer) - n);
+        p = buffer;
+    }
+    std::uint64_t mask = Classify32(p, classes);
+    if (n > 32) mask |= static_cast<std::uint64_t>(Classify32(p + 32, classes)) << 32;
+    return n < 64 ? mask & ((std::uint64_t(1) << n) - 1) : mask;
+}
+#endif
+
+/*
+ * 启动时选择实现
+ */
+struct Classifier {
+    std::uint64_t (*classify)(const char*, size_t, unsigned);
+    const char* name;
+};
+
+static Classifier SelectClassifier() {
+#ifdef MAS_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {ClassifyAvx2, "avx2"};
+    if (__builtin_cpu_supports("sse2")) return {ClassifySse2, "sse2"};
+#endif
+    return {ClassifyScalar, "scalar"};
+}
+static const Classifier g_classifier = SelectClassifier();
+
+std::uint64_t ClassifyBlock(const char* p, size_t n, unsigned classes) {
+    return g_classifier.classify(p, n, classes);
+}
+
+const char* ScannerName() { return g_classifier.name; }
+
+size_t ScanFirst(std::string_view s, size_t from, unsigned classes) {
+    for (size_t pos = from; pos < s.size(); pos += 64) {
+        size_t n = std::min<size_t>(64, s.size() - pos);
+        std::uint64_t mask = ClassifyBlock(s.data() + pos, n, classes);
+        if (mask) return pos + __builtin_ctzll(mask);
+    }
+    return s.size();
+}
+
+size_t ScanFirstNot(std::string_view s, size_t from, unsigned classes) {
+    for (size_t pos = from; pos < s.size(); pos += 64) {
+        size_t n = std::min<size_t>(64, s.size() - pos);
+        std::uint64_t all = n == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1;
+        std::uint64_t mask = ~ClassifyBlock(s.data() + pos, n, classes) & all;
+        if (mask) return pos + __builtin_ctzll(mask);
+    }
+    return s.size();
+}
+
+// 行尾通常只有很少几个空白，逐字节向前查表即可
+size_t ScanLastNot(std::string_view s, size_t from, size_t to, unsigned classes) {
+    while (to > from && (g_table.bits[static_cast<unsigned char>(s[to - 1])] & classes)) to--;
+    return to;
+}
@@ -0,0 +1,201 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "Headers.h"
+
+/*
+ * 统计数据。计数器使用 relaxed 原子量，保证多线程下也不会丢计数。
+ */
+static std::atomic<bool> g_enabled{false};
+static std::atomic<bool> g_count_allocs{false};   // --stats 或 bench 开启
+
+static std::atomic<unsigned long long> g_regex_runs[static_cast<int>(RegexSite::Count)];
+static std::atomic<unsigned long long> g_regex_compiles[static_cast<int>(RegexSite::Count)];
+static std::atomic<unsigned long long> g_exceptions[static_cast<int>(ExceptionKind::Count)];
+static std::atomic<long long> g_phase_ns[static_cast<int>(StatsPhase::Count)];
+static std::atomic<unsigned long long> g_instructions{0};
+static std::atomic<unsigned long long> g_data_statements{0};
+static std::atomic<unsigned long long> g_cache_hits{0};
+static std::atomic<unsigned long long> g_cache_misses{0};
+static std::atomic<unsigned long long> g_memo_hits{0};
+static std::atomic<unsigned long long> g_memo_misses{0};
+static std::atomic<std::size_t> g_alloc_count{0};
+static std::atomic<std::size_t> g_alloc_bytes{0};
+
+static const char* const kRegexSiteNames[] = {
+    "DispatchData", "I_FormatInstruction",
+    "isPositive", "isDecimal", "isSymbol"};
+
+static const char* const kExceptionNames[] = {
+    "ExceptNumberOrSymbol", "ExceptNumber", "ExceptPositive", "ExceptRegister",
+    "OperandError", "TooManyOperand", "UnknownInstruction", "NumberOverflow",
+    "ExpressionError"};
+
+static const char* const kPhaseNames[] = {"read", "data segment", "text segment",
+                                          "resolve symbols", "output", "output I/O"};
+
+static_assert(sizeof(kRegexSiteNames) / sizeof(*kRegexSiteNames) ==
+                  static_cast<int>(RegexSite::Count),
+              "RegexSite names out of sync");
+static_assert(sizeof(kExceptionNames) / sizeof(*kExceptionNames) ==
+                  static_cast<int>(ExceptionKind::Count),
+              "ExceptionKind names out of sync");
+static_assert(sizeof(kPhaseNames) / sizeof(*kPhaseNames) ==
+                  static_cast<int>(StatsPhase::Count),
+              "StatsPhase names out of sync");
+
+static long long NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/*
+ * 可替换的全局 operator new：开启分配统计后记录分配次数与字节数
+ * （operator new[] 及 nothrow 版本默认都会转到这里）
+ */
+void* operator new(std::size_t size) {
+    if (g_count_allocs.load(std::memory_order_relaxed)) {
+        g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+        g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+void EnableStats() {
+    g_enabled.store(true);
+    g_count_allocs.store(true);
+}
+
+void EnableAllocationCounting() { g_count_allocs.store(true); }
+
+bool StatsEnabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+void ResetStats() {
+    for (auto& c : g_regex_runs) c = 0;
+    for (auto& c : g_regex_compiles) c = 0;
+    for (auto& c : g_exceptions) c = 0;
+    for (auto& c : g_phase_ns) c = 0;
+    g_instructions = 0;
+    g_data_statements = 0;
+    g_cache_hits = 0;
+    g_cache_misses = 0;
+    g_memo_hits = 0;
+    g_memo_misses = 0;
+    g_alloc_count = 0;
+    g_alloc_bytes = 0;
+}
+
+void CountRegex(RegexSite site) {
+    if (StatsEnabled())
+        g_regex_runs[static_cast<int>(site)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CountRegexCompile(RegexSite site) {
+    if (StatsEnabled())
+        g_regex_compiles[static_cast<int>(site)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CountException(ExceptionKind kind) {
+    if (StatsEnabled())
+        g_exceptions[static_cast<int>(kind)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CountStatement(bool is_instruction) {
+    if (!StatsEnabled()) return;
+    if (is_instruction) g_instructions.fetch_add(1, std::memory_order_relaxed);
+    else g_data_statements.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CountCache(bool hit) {
+    if (!StatsEnabled()) return;
+    if (hit) g_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    else g_cache_misses.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CountMemo(bool hit) {
+    if (!StatsEnabled()) return;
+    if (hit) g_memo_hits.fetch_add(1, std::memory_order_relaxed);
+    else g_memo_misses.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::size_t StatsAllocationCount() { return g_alloc_count.load(); }
+std::size_t StatsAllocationBytes() { return g_alloc_bytes.load(); }
+
+ScopedPhaseTimer::ScopedPhaseTimer(StatsPhase phase)
+    : phase(phase), start_ns(StatsEnabled() ? NowNs() : 0) {}
+
+ScopedPhaseTimer::~ScopedPhaseTimer() {
+    if (StatsEnabled())
+        g_phase_ns[static_cast<int>(phase)].fetch_add(NowNs() - start_ns,
+                                                     std::memory_order_relaxed);
+}
+
+/*
+ * ReportStats：输出统计表
+ *   每一项给出总数，以及按语句数（指令 + 数据定义）折算的平均值
+ */
+void ReportStats(std::ostream& out) {
+    unsigned long long statements = g_instructions + g_data_statements;
+    double div = statements ? static_cast<double>(statements) : 1.0;
+
+    std::ios_base::fmtflags flags = out.flags();
+    out << std::dec << std::fixed << std::setprecision(2);
+
+    out << "==== mas statistics ====\n";
+    out << "statements: " << statements << " (instructions " << g_instructions
+        << ", data " << g_data_statements << ")\n";
+    out << "scanner: " << ScannerName() << "\n";
+    if (std::strcmp(OutputBackendName(), "none") != 0) {
+        out << "output writer: " << OutputBackendName() << "\n";
+    }
+    if (g_cache_hits + g_cache_misses > 0) {
+        out << "cache: " << g_cache_hits << " hits, " << g_cache_misses << " misses\n";
+    }
+    if (g_memo_hits + g_memo_misses > 0) {
+        out << "memo: " << g_memo_hits << " hits, " << g_memo_misses << " misses ("
+            << 100.0 * g_memo_hits / (g_memo_hits + g_memo_misses) << "% hit rate)\n";
+    }
+
+    out << "\nphase                  time(ms)\n";
+    for (int i = 0; i < static_cast<int>(StatsPhase::Count); i++) {
+        out << std::left << std::setw(22) << kPhaseNames[i] << std::right
+            << std::setw(10) << g_phase_ns[i] / 1e6 << "\n";
+    }
+
+    out << "\nregex site                     runs   per stmt   compiles\n";
+    unsigned long long total_runs = 0, total_compiles = 0;
+    for (int i = 0; i < static_cast<int>(RegexSite::Count); i++) {
+        total_runs += g_regex_runs[i];
+        total_compiles += g_regex_compiles[i];
+        if (g_regex_runs[i] == 0 && g_regex_compiles[i] == 0) continue;
+        out << std::left << std::setw(28) << kRegexSiteNames[i] << std::right
+            << std::setw(10) << g_regex_runs[i] << std::setw(11) << g_regex_runs[i] / div
+            << std::setw(11) << g_regex_compiles[i] << "\n";
+    }
+    out << std::left << std::setw(28) << "total" << std::right << std::setw(10)
+        << total_runs << std::setw(11) << total_runs / div << std::setw(11)
+        << total_compiles << "\n";
+
+    out << "\nheap allocations: " << g_alloc_count << " (" << g_alloc_count / div
+        << " per stmt), bytes: " << g_alloc_bytes << " (" << g_alloc_bytes / div
+        << " per stmt)\n";
+
+    out << "\nexception                    thrown\n";
+    bool any = false;
+    for (int i = 0; i < static_cast<int>(ExceptionKind::Count); i++) {
+        if (g_exceptions[i] == 0) continue;
+        any = true;
+        out << std::left << std::setw(28) << kExceptionNames[i] << std::right
+            << std::setw(8) << g_exceptions[i] << "\n";
+    }
+    if (!any) out << "(none)\n";
+
+    out.flags(flags);
+}
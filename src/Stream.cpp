@@ -0,0 +1,377 @@
+#include <sstream>
+
+#include "Headers.h"
+
+/*
+ * 待回填项：某条指令中引用了尚未定义的符号
+ *   word_index：机器码在代码镜像中的字地址
+ *   inst_addr ：该指令的字节地址（分支指令计算相对偏移用）
+ */
+struct PendingFixup {
+    size_t word_index;
+    unsigned inst_addr;
+    Addend addend;
+};
+
+/*
+ * StreamAssembler：流式汇编的状态
+ * 只保存符号表、待回填项、两个输出镜像，以及 details 的临时文件
+ */
+class StreamAssembler {
+   public:
+    // keep_details 为 false 时不生成 details（-o - 只输出 COE 时不需要临时文件）
+    StreamAssembler(const std::string& output_dir, bool keep_details, AssemblyCache* cache)
+        : keep_details(keep_details),
+          code_details_path(output_dir + "details.code.tmp"),
+          data_details_path(output_dir + "details.data.tmp") {
+        core.SetCache(cache);
+        if (!keep_details) return;
+        code_details.open(code_details_path, std::ios::in | std::ios::out | std::ios::trunc);
+        data_details.open(data_details_path, std::ios::in | std::ios::out | std::ios::trunc);
+    }
+
+    ~StreamAssembler() {
+        if (!keep_details) return;
+        code_details.close();
+        data_details.close();
+        std::remove(code_details_path.c_str());
+        std::remove(data_details_path.c_str());
+    }
+
+    bool Ready() const { return !keep_details || (code_details && data_details); }
+
+    // 处理一条代码段记录（普通指令或 .text 预留空间）
+    void AddInstruction(Instruction& instruction) {
+        UnsolvedSymbolMap local_refs(symbol_map);
+        std::string label;
+
+        core.SetCurrentAddress(text_address);
+        if (core.ProcessInstruction(instruction, local_refs, symbol_map, &label))
+            has_error = true;
+        text_address = core.GetCurrentAddress();
+
+        if (!label.empty() && isLocalLabel(label)) {
+            DefineLocal(label, instruction);
+        } else if (!label.empty()) {
+            CloseLocalScope();
+            ResolvePending(label);
+        }
+
+        // 本行的符号引用：已定义的立即回填，否则记为待回填项
+        for (const auto& relocation : local_refs) {
+            const SymbolId symbol = relocation.symbol;
+            size_t offset = relocation.ref.machine_code_handle - instruction.machine_code.begin();
+            if (symbol_map.IsDefined(symbol)) {
+                Patch(*relocation.ref.machine_code_handle, instruction.address,
+                      symbol_map.Address(symbol), relocation.addend, symbol_map.Names().Name(symbol));
+            } else {
+                if (pending.size() <= symbol) pending.resize(symbol + 1);
+                pending[symbol].push_back(
+                    PendingFixup{instruction.address / 4 + offset, instruction.address,
+                                 relocation.addend});
+                pending_count++;
+            }
+        }
+
+        // 对局部 Label 的引用：在当前作用域内回填或等待
+        for (const auto& local : local_refs.Locals()) {
+            size_t offset = local.ref.machine_code_handle - instruction.machine_code.begin();
+            unsigned address = 0;
+            switch (local_labels.Reference(
+                local.symbol,
+                PendingFixup{instruction.address / 4 + offset, instruction.address, local.addend},
+                address)) {
+                case LocalLabelScope<PendingFixup>::Lookup::Resolved:
+                    Patch(*local.ref.machine_code_handle, instruction.address, address,
+                          local.addend, local.symbol);
+                    break;
+                case LocalLabelScope<PendingFixup>::Lookup::Undefined:
+                    core.LogError("Unknown Symbol: " + LocalLabelName(local.symbol), instruction.assembly);
+                    undefined_local = true;
+                    break;
+                case LocalLabelScope<PendingFixup>::Lookup::Pending:
+                    pending_count++;
+                    break;
+            }
+        }
+
+        if (instruction.machine_code.empty()) return;
+
+        size_t end = instruction.address / 4 + instruction.machine_code.size();
+        if (code_image.size() < end) code_image.resize(end, 0);
+        PlaceInstructionWords(code_image, instruction.address, instruction.machine_code);
+        if (!keep_details) return;
+
+        // details：先记录“地址 字数 汇编文本”，最后再结合回填后的镜像输出
+        code_details << instruction.address << ' ' << instruction.machine_code.size() << ' '
+                     << instruction.assembly << '\n';
+    }
+
+    // 处理一条数据段记录（数据定义或 .data 预留空间）
+    void AddData(Data& data) {
+        std::string label;
+
+        core.SetCurrentAddress(data_address);
+        if (core.ProcessData(data, symbol_map, &label)) has_error = data_error = true;
+        data_address = core.GetCurrentAddress();
+
+        if (!label.empty()) ResolvePending(label);
+        if (data.raw_data.empty()) return;
+
+        size_t end = data.address / 4 + (data.raw_data.size() + 3) / 4;
+        if (data_image.size() < end) data_image.resize(end, 0);
+        PlaceDataWords(data_image, data.address, data.raw_data);
+        if (!keep_details) return;
+
+        // 数据不需要回填，details 可以直接写出最终格式
+        unsigned offset = data.address;
+        for (const auto raw_data : data.raw_data) {
+            OutputDetailsDataLine(data_details, offset++, raw_data, data.assembly);
+        }
+    }
+
+    // 输入结束：关闭最后一个局部作用域，剩余的待回填项都是未定义的符号
+    bool ReportUndefined() {
+        CloseLocalScope();
+        bool undefined = undefined_local;
+        for (SymbolId symbol = 0; symbol < pending.size(); symbol++) {
+            if (pending[symbol].empty()) continue;
+            core.LogError("Unknown Symbol: " + std::string(symbol_map.Names().Name(symbol)));
+            undefined = true;
+        }
+        return undefined;
+    }
+
+    bool HasError() const { return has_error; }
+    bool HasDataError() const { return data_error; }
+
+    // 把三个文件登记到 writer，由调用方统一写出（内容未变化的文件不改写）
+    //   details.txt 随源文件增长，逐段写出而不放进内存，写出时本对象须仍然存在
+    void AddOutputs(AsyncOutputWriter& writer, const std::string& output_dir) {
+        std::ostringstream code_file;
+        OutputImage(code_file, code_image);
+        writer.Add(output_dir + "prgmip32.coe", code_file.str());
+
+        std::ostringstream data_file;
+        OutputImage(data_file, data_image);
+        writer.Add(output_dir + "dmem32.coe", data_file.str());
+
+        writer.AddStream(output_dir + "details.txt", [this](std::ostream& out) { WriteDetails(out); });
+    }
+
+    // --patch：与基准 COE 比较并写出补丁文件
+    bool WritePatchFiles(const std::string& base_dir, const std::string& output_dir) const {
+        return WritePatches(base_dir, output_dir, code_image, data_image);
+    }
+
+    // -o -：把选定的一种格式写到标准输出
+    bool WriteStdout(StdoutFormat format) {
+        switch (format) {
+            case StdoutFormat::Prgm: OutputImage(std::cout, code_image); break;
+            case StdoutFormat::Dmem: OutputImage(std::cout, data_image); break;
+            default: WriteDetails(std::cout); break;
+        }
+        std::cout.flush();
+        return static_cast<bool>(std::cout);
+    }
+
+    void PrintMemoryReport(std::ostream& out) const {
+        size_t pending_bytes = pending.capacity() * sizeof(pending[0]);
+        for (const auto& fixups : pending) pending_bytes += fixups.capacity() * sizeof(PendingFixup);
+
+        out << "==== mas memory report (stream mode, estimated bytes held) ====\n"
+            << "code image          " << FormatBytes(code_image.capacity() * sizeof(uint32_t)) << "\n"
+            << "data image          " << FormatBytes(data_image.capacity() * sizeof(uint32_t)) << "\n"
+            << "SymbolMap           " << FormatBytes(symbol_map.MemoryBytes()) << "\n"
+            << "pending fixups      " << FormatBytes(pending_bytes) << " (" << pending_count
+            << " recorded in total)\n"
+            << "peak RSS            " << FormatBytes(PeakRssBytes()) << "\n";
+    }
+
+   private:
+    AssemblerCore core;
+    SymbolMap symbol_map;
+    std::vector<std::vector<PendingFixup>> pending;   // 按符号 id 下标
+    LocalLabelScope<PendingFixup> local_labels;       // 当前函数的局部 Label（见 LocalLabel.h）
+    size_t pending_count = 0;   // 累计记录过的待回填项数（统计用）
+
+    std::vector<uint32_t> code_image;
+    std::vector<uint32_t> data_image;
+    unsigned text_address = 0;
+    unsigned data_address = 0;
+    bool has_error = false;
+    bool data_error = false;    // 出错的是数据段（决定汇总提示，同普通模式）
+    bool undefined_local = false;   // 有未定义的局部 Label（同全局符号，由 ReportUndefined 返回）
+
+    bool keep_details;
+    std::string code_details_path;
+    std::string data_details_path;
+    std::fstream code_details;
+    std::fstream data_details;
+
+    void Patch(MachineCode& machine_code, unsigned inst_addr, unsigned symbol_addr, Addend addend,
+               std::string_view symbol) {
+        try {
+            core.PatchSymbol(machine_code, inst_addr, symbol_addr, addend);
+        } catch (const std::exception& e) {
+            core.LogError(e.what(), "Resolving " + LocalLabelName(symbol));
+            has_error = true;
+        }
+    }
+
+    // 局部 Label 出现：回填当前作用域中等待它的引用
+    void DefineLocal(const std::string& label, const Instruction& instruction) {
+        auto resolve = [this](const std::string& symbol, const PendingFixup& fixup, unsigned address) {
+            Patch(code_image[fixup.word_index], fixup.inst_addr, address, fixup.addend, symbol);
+        };
+        if (!local_labels.Define(label, instruction.address, resolve)) {
+            core.LogError("Redefined symbol: " + LocalLabelName(label), instruction.assembly);
+            has_error = true;
+        }
+    }
+
+    // 关闭局部作用域：仍在等待的引用是未定义的局部 Label
+    void CloseLocalScope() {
+        local_labels.Close([&](const std::string& symbol, const std::vector<PendingFixup>&) {
+            core.LogError("Unknown Symbol: " + LocalLabelName(symbol));
+            undefined_local = true;
+        });
+    }
+
+    // Label 出现：回填所有等待它的引用
+    void ResolvePending(const std::string& label) {
+        const SymbolId symbol = symbol_map.Names().Find(label);
+        if (symbol >= pending.size() || pending[symbol].empty()) return;
+
+        unsigned symbol_addr = symbol_map.Address(symbol);
+        for (const auto& fixup : pending[symbol]) {
+            Patch(code_image[fixup.word_index], fixup.inst_addr, symbol_addr, fixup.addend,
+                  symbol_map.Names().Name(symbol));
+        }
+        std::vector<PendingFixup>().swap(pending[symbol]);
+    }
+
+    void WriteDetails(std::ostream& out) {
+        OutputDetailsCodeHeader(out);
+
+        code_details.flush();
+        code_details.seekg(0);
+        std::string record;
+        while (std::getline(code_details, record)) {
+            // 记录格式：地址 字数 汇编文本
+            char* rest = nullptr;
+            unsigned address = std::strtoul(record.c_str(), &rest, 10);
+            size_t count = std::strtoul(rest, &rest, 10);
+            std::string assembly = *rest == ' ' ? std::string(rest + 1) : std::string(rest);
+
+            for (size_t k = 0; k < count; k++) {
+                OutputDetailsCodeLine(out, address + 4 * k, code_image[address / 4 + k], assembly);
+            }
+        }
+
+        OutputDetailsDataHeader(out);
+        data_details.flush();
+        data_details.seekg(0);
+        if (data_details.peek() != std::char_traits<char>::eof()) out << data_details.rdbuf();
+    }
+};
+
+int doAssembleStream(std::istream& in,
+                     const std::string& input_path,
+                     const std::string& output_dir,
+                     const AssembleOptions& options,
+                     AssemblyCache* cache) {
+    const bool to_stdout = options.stdout_format != StdoutFormat::None;
+    StreamAssembler assembler(output_dir,
+                              !to_stdout || options.stdout_format == StdoutFormat::Details,
+                              cache);
+    if (!assembler.Ready()) {
+        std::cerr << "IO Error: Could not create temporary files in " << output_dir << std::endl;
+        return 1;
+    }
+
+    SegmentState current_state = SegmentState::Global;
+    std::string current_line;
+    int line_counter = 0;
+
+    try {
+        ScopedPhaseTimer timer(StatsPhase::TextSegment);
+
+        // 段切换指令产生的预留空间记录
+        InstructionList reserved_text;
+        DataList reserved_data;
+
+        while (std::getline(in, current_line)) {
+            line_counter++;
+
+            std::string clean_line(KillComment(current_line));
+            if (clean_line.empty() || clean_line.find_first_not_of(" \t\r\n") == std::string::npos) {
+                continue; // 跳过空行
+            }
+
+            if (handleSegmentDirective(clean_line, current_state, input_path, line_counter,
+                                       reserved_text, reserved_data)) {
+                for (auto& inst : reserved_text) assembler.AddInstruction(inst);
+                for (auto& d : reserved_data) assembler.AddData(d);
+                reserved_text.clear();
+                reserved_data.clear();
+                continue;
+            }
+
+            if (current_state == SegmentState::Global) {
+                std::cerr << "Assembler Error: Statement found outside of any segment at " << input_path << ":" << line_counter << std::endl;
+                return 1;
+            }
+
+            if (current_state == SegmentState::Data) {
+                Data d; d.file = input_path; d.line = line_counter; d.assembly = clean_line;
+                assembler.AddData(d);
+            } else {
+                Instruction inst; inst.file = input_path; inst.line = line_counter; inst.assembly = clean_line;
+                assembler.AddInstruction(inst);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Critical Error during parsing: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // --mem-report 在输出写完后报告（与普通模式的 output 阶段相同），峰值包含格式化与写出；
+    // 出错提前返回时报告到出错为止的情况
+    auto finish = [&](int result) {
+        if (options.mem_report) assembler.PrintMemoryReport(std::cerr);
+        return result;
+    };
+
+    if (assembler.HasDataError()) {
+        std::cerr << "Error in Data Segment Generation." << std::endl;
+        return finish(1);
+    }
+    if (assembler.HasError()) {
+        std::cerr << "Error in Machine Code Generation." << std::endl;
+        return finish(1);
+    }
+    if (assembler.ReportUndefined()) {
+        std::cerr << "Error: Undefined symbols detected." << std::endl;
+        return finish(1);
+    }
+
+    AsyncOutputWriter writer;
+    {
+        ScopedPhaseTimer timer(StatsPhase::Output);
+        if (options.patch) {
+            const std::string& base_dir =
+                options.patch_base.empty() ? output_dir : options.patch_base;
+            if (!assembler.WritePatchFiles(base_dir, output_dir)) return finish(1);
+        }
+        if (to_stdout) {
+            if (!assembler.WriteStdout(options.stdout_format)) return finish(1);
+        } else {
+            assembler.AddOutputs(writer, output_dir);
+        }
+    }
+    if (!to_stdout && !FlushOutputs(writer)) return finish(1);
+
+    (to_stdout ? std::cerr : std::cout) << "Assembly completed successfully." << std::endl;
+    return finish(0);
+}
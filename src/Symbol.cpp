@@ -0,0 +1,98 @@
+#include "Headers.h"
+
+static size_t HashName(std::string_view name) { return std::hash<std::string_view>()(name); }
+
+/*
+ * 把名字复制进字符区；当前块放不下时新开一块，超过一块大小的名字单独分配
+ */
+char* SymbolInterner::NewBlock(size_t size) {
+    char* data = static_cast<char*>(Resource()->allocate(size, 1));
+    blocks.push_back(Block{data, size});
+    block_bytes += size;
+    return data;
+}
+
+SymbolInterner::~SymbolInterner() {
+    for (const auto& block : blocks) Resource()->deallocate(block.data, block.size, 1);
+}
+
+const char* SymbolInterner::Store(std::string_view name) {
+    if (name.empty()) return "";
+    if (name.size() > kBlockBytes) {
+        char* p = NewBlock(name.size());
+        std::memcpy(p, name.data(), name.size());
+        return p;
+    }
+    if (block_left < name.size()) {
+        block_cursor = NewBlock(kBlockBytes);
+        block_left = kBlockBytes;
+    }
+    char* p = block_cursor;
+    std::memcpy(p, name.data(), name.size());
+    block_cursor += name.size();
+    block_left -= name.size();
+    return p;
+}
+
+void SymbolInterner::Rehash(size_t capacity) {
+    slots.assign(capacity, kNoSymbol);
+    const size_t mask = capacity - 1;
+    for (SymbolId id = 0; id < names.size(); id++) {
+        size_t slot = hashes[id] & mask;
+        while (slots[slot] != kNoSymbol) slot = (slot + 1) & mask;
+        slots[slot] = id;
+    }
+}
+
+SymbolId SymbolInterner::Find(std::string_view name) const {
+    if (slots.empty()) return kNoSymbol;
+    const size_t hash = HashName(name);
+    const size_t mask = slots.size() - 1;
+    for (size_t slot = hash & mask; slots[slot] != kNoSymbol; slot = (slot + 1) & mask) {
+        SymbolId id = slots[slot];
+        if (hashes[id] == hash && names[id] == name) return id;
+    }
+    return kNoSymbol;
+}
+
+SymbolId SymbolInterner::Intern(std::string_view name) {
+    // 插入后负载仍不超过 1/2
+    if (2 * (names.size() + 1) > slots.size()) Rehash(std::max<size_t>(64, 2 * slots.size()));
+
+    const size_t hash = HashName(name);
+    const size_t mask = slots.size() - 1;
+    size_t slot = hash & mask;
+    for (; slots[slot] != kNoSymbol; slot = (slot + 1) & mask) {
+        SymbolId id = slots[slot];
+        if (hashes[id] == hash && names[id] == name) return id;
+    }
+
+    SymbolId id = static_cast<SymbolId>(names.size());
+    names.emplace_back(Store(name), name.size());
+    hashes.push_back(hash);
+    slots[slot] = id;
+    return id;
+}
+
+size_t SymbolInterner::MemoryBytes() const {
+    return block_bytes + blocks.capacity() * sizeof(blocks[0]) +
+           names.capacity() * sizeof(names[0]) + hashes.capacity() * sizeof(hashes[0]) +
+           slots.capacity() * sizeof(slots[0]);
+}
+
+bool SymbolMap::Define(SymbolId id, unsigned address) {
+    if (id >= addresses.size()) addresses.resize(std::max<size_t>(id + 1, names.Size()), kUndefined);
+    if (addresses[id] != kUndefined) return false;
+    addresses[id] = address;
+    defined++;
+    return true;
+}
+
+const unsigned* SymbolMap::Find(std::string_view name) const {
+    SymbolId id = names.Find(name);
+    return IsDefined(id) ? &addresses[id] : nullptr;
+}
+
+size_t SymbolMap::MemoryBytes() const {
+    return names.MemoryBytes() + addresses.capacity() * sizeof(addresses[0]);
+}
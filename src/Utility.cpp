@@ -1,3 +1,5 @@
+#include <cctype>
+
 #include "Headers.h"
 
 /*
@@ -13,6 +15,28 @@ std::string toUppercase(std::string str) {
     return str;
 }
 
+/*
+ * toCanonicalCase
+ * 与 toUppercase 相同，但符号开头的 ".L"（大写 L，与 GNU as 一样区分大小写）转为 ".l"：
+ * 转大写后的文本中不会再有小写字母，".l" 因此只标记局部 Label（见 LocalLabel.h），
+ * ".loop"、".list" 这样的普通 Label 仍是 ".LOOP"、".LIST"。
+ */
+std::string toCanonicalCase(std::string str) {
+    auto symbol_char = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '$';
+    };
+    for (size_t i = 0; i < str.size(); i++) {
+        char& c = str[i];
+        if (c == 'L' && i >= 1 && str[i - 1] == '.' && (i < 2 || !symbol_char(str[i - 2])) &&
+            i + 1 < str.size() && symbol_char(str[i + 1])) {
+            c = 'l';
+        } else if (c <= 'z' && c >= 'a') {
+            c += 'A' - 'a';
+        }
+    }
+    return str;
+}
+
 /*
  * isNumber
  *
@@ -46,6 +70,7 @@ bool isNumber(const std::string& str) {
 bool isPositive(const std::string& str) {
     static std::regex re(R"(^(?:\d+|0x[0-9abcdef]+)$)", std::regex::icase);
     std::cmatch m;
+    CountRegex(RegexSite::isPositive);
     std::regex_search(str.c_str(), m, re);
     return m[0].matched;
 }
@@ -58,6 +83,7 @@ bool isDecimal(const std::string& str) {
     static std::regex re(R"(^\d+$)", std::regex::icase);
     std::cmatch m;
 
+    CountRegex(RegexSite::isDecimal);
     if (str[0] == '-') {
         std::regex_search(str.substr(1).c_str(), m, re);
     } else {
@@ -129,6 +155,8 @@ bool isSymbol(const std::string& str) {
 
     std::regex re(R"(^[a-z0-9_.$]+$)", std::regex::icase);
     std::cmatch m;
+    CountRegexCompile(RegexSite::isSymbol);
+    CountRegex(RegexSite::isSymbol);
     std::regex_search(str.c_str(), m, re);
 
     // 必须满足：
@@ -148,20 +176,42 @@ bool isSymbol(const std::string& str) {
  *   "-16($sp)"
  *   "var($s1)"
  *
- * 正则分组：
- *   m[1] → offset（数字或符号）
- *   m[2] → base   （寄存器）
+ *   offset：整个非空白串中最后一个 '(' 之前的部分（数字、符号或表达式）
+ *   base  ：'(' 与串末尾的 ')' 之间的部分（寄存器）
+ * 与原来的正则 ^\s*(\S+)\((\S+)\)\s*$ 一致：前后可以有空白，offset 与 base 都不能为空。
  */
 bool isMemory(const std::string& str) {
-    std::regex re(R"(^\s*(\S+)\((\S+)\)\s*$)", std::regex::icase);
-    std::cmatch m;
-    std::regex_search(str.c_str(), m, re);
-
-    if (!m.empty() &&
-        (isNumber(m[1].str()) || isSymbol(m[1].str())) &&
-        isRegister(m[2].str())) {
-        return true;
-    } else {
+    const size_t n = str.size();
+    size_t begin = ScanFirstNot(str, 0, kCharSpace);
+    size_t end = ScanFirst(str, begin, kCharSpace);
+    if (ScanFirstNot(str, end, kCharSpace) != n || end - begin < 4 || str[end - 1] != ')')
         return false;
+
+    // offset 取最长（贪婪），即 base 至少留 1 个字符时最后一个 '('
+    size_t paren = n;
+    for (size_t p = ScanFirst(str, begin + 1, kCharParen); p + 3 <= end;
+         p = ScanFirst(str, p + 1, kCharParen)) {
+        if (str[p] == '(') paren = p;
     }
-}
\ No newline at end of file
+    if (paren == n) return false;
+
+    std::string offset = str.substr(begin, paren - begin);
+    return isOperand(offset) &&
+           isRegister(str.substr(paren + 1, end - 1 - paren - 1));
+}
+
+/*
+ * Diag
+ * 诊断信息通道。默认写到 std::cerr，调用方可用 SetDiagStream 重定向（传 nullptr 恢复默认），
+ * SetDiagStream 返回原来的通道，便于临时截获后恢复。
+ * 通道是每个线程各自的：多个线程同时编码时，一个线程截获诊断信息不会把别的线程的输出也收走。
+ */
+static thread_local std::ostream* g_diag_stream = &std::cerr;
+
+std::ostream& Diag() { return *g_diag_stream; }
+
+std::ostream* SetDiagStream(std::ostream* out) {
+    std::ostream* previous = g_diag_stream;
+    g_diag_stream = out ? out : &std::cerr;
+    return previous;
+}
@@ -0,0 +1,150 @@
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "Headers.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+/*
+ * FileWatcher：等待一个文件发生变化
+ *   Linux 下监视文件所在目录的 inotify 事件（写入后关闭、改名到该文件名），
+ *   否则轮询修改时间与大小
+ */
+class FileWatcher {
+   public:
+    explicit FileWatcher(const std::string& path) : path(path) {
+        Stamp(last_time, last_size);
+#ifdef __linux__
+        fs::path dir = fs::path(path).parent_path();
+        name = fs::path(path).filename().string();
+        fd = inotify_init1(IN_CLOEXEC);
+        if (fd >= 0) {
+            wd = inotify_add_watch(fd, dir.empty() ? "." : dir.string().c_str(),
+                                   IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (wd < 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+#endif
+    }
+
+    ~FileWatcher() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    // 阻塞直到文件可能发生了变化
+    void Wait() {
+#ifdef __linux__
+        if (fd >= 0) {
+            WaitInotify();
+            Stamp(last_time, last_size);
+            return;
+        }
+#endif
+        WaitPolling();
+    }
+
+   private:
+    std::string path;
+    fs::file_time_type last_time;
+    std::uintmax_t last_size = 0;
+
+    // 读取文件的修改时间与大小（文件不存在时为默认值）
+    void Stamp(fs::file_time_type& time, std::uintmax_t& size) const {
+        std::error_code ec;
+        time = fs::last_write_time(path, ec);
+        if (ec) time = fs::file_time_type();
+        size = fs::file_size(path, ec);
+        if (ec) size = 0;
+    }
+
+    void WaitPolling() {
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            fs::file_time_type time;
+            std::uintmax_t size;
+            Stamp(time, size);
+            if (time != last_time || size != last_size) {
+                last_time = time;
+                last_size = size;
+                return;
+            }
+        }
+    }
+
+#ifdef __linux__
+    int fd = -1;
+    int wd = -1;
+    std::string name;
+
+    // 读出已到达的事件，返回其中是否有针对被监视文件的
+    bool ReadEvents() {
+        alignas(inotify_event) char buf[4096];
+        bool hit = false;
+        ssize_t len = read(fd, buf, sizeof(buf));
+        for (ssize_t i = 0; i < len;) {
+            auto* event = reinterpret_cast<inotify_event*>(buf + i);
+            if (event->len > 0 && name == event->name) hit = true;
+            i += sizeof(inotify_event) + event->len;
+        }
+        return hit;
+    }
+
+    void WaitInotify() {
+        pollfd pfd{fd, POLLIN, 0};
+        while (true) {
+            if (poll(&pfd, 1, -1) <= 0) continue;
+            if (!ReadEvents()) continue;
+
+            // 编辑器保存时常常连续产生多个事件，稍等片刻把它们合并为一次
+            while (poll(&pfd, 1, 50) > 0) ReadEvents();
+            return;
+        }
+    }
+#endif
+};
+
+int doWatch(const std::string& input_path,
+            const std::string& output_dir,
+            const AssembleOptions& options) {
+    if (input_path == "-") {
+        std::cerr << "Error: --watch needs an input file, not stdin" << std::endl;
+        return 1;
+    }
+
+    AssemblyCache cache;
+    if (!options.cache_path.empty()) cache.Load(options.cache_path);
+    JobArena arena;   // 每次汇编复用，源文件大小不变时不再向全局分配器申请列表与符号表的内存
+
+    FileWatcher watcher(input_path);
+    std::cerr << "[watch] Watching " << input_path << " (Ctrl+C to stop)" << std::endl;
+
+    while (true) {
+        ResetStats();
+        auto start = std::chrono::steady_clock::now();
+        int result = doAssemble(input_path, output_dir, options, &cache, &arena);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        if (!options.cache_path.empty() && !cache.Save(options.cache_path)) {
+            std::cerr << "IO Error: Could not write cache file " << options.cache_path << std::endl;
+        }
+        cache.Prune();
+
+        std::cerr << "[watch] Build " << (result ? "failed" : "succeeded") << " in "
+                  << elapsed.count() << " ms (" << cache.Size() << " cached lines)" << std::endl;
+
+        watcher.Wait();
+        std::cerr << "[watch] " << input_path << " changed, reassembling" << std::endl;
+    }
+}
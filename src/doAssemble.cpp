@@ -1,64 +1,60 @@
-﻿#include "Headers.h"
+﻿#include <sstream>
 
-/**
- * 段状态枚举：标记当前扫描行属于哪个区域
- * Global: 初始状态，不允许出现指令或数据
- * Data:   数据段，存储变量、字符串等
- * Text:   代码段，存储指令机器码
- */
-enum class SegmentState { Global, Data, Text };
+#include "Headers.h"
 
 // 去除汇编行中的注释部分
-std::string KillComment(const std::string& assembly) {
-    static std::regex re("^([^#]*)(?:#.*)?");
-    std::smatch match;
-    std::regex_match(assembly, match, re);
-    return match[1].str();
+// （与原来的正则 ^([^#]*)(?:#.*)? 一致：注释中含有 \r 或 \n 时整行不匹配，返回空串）
+std::string_view KillComment(std::string_view assembly) {
+    size_t hash = ScanFirst(assembly, 0, kCharHash);
+    if (hash == assembly.size()) return assembly;
+    if (ScanFirst(assembly, hash + 1, kCharLineEnd) != assembly.size()) return "";
+    return assembly.substr(0, hash);
 }
 
-bool handleSegmentDirective(const std::string& input,
+bool handleSegmentDirective(std::string_view input,
                              SegmentState& state,
                              const std::string& path,
                              int line,
                              InstructionList& inst_list,
                              DataList& data_list) {
-    // 匹配以 .data 或 .text 开头的行，捕获后面的数值参数
-    static const std::regex segment_re(R"(^\s*\.(data|text)\s*(\S+)?)", std::regex::icase);
-    std::smatch match;
-
-    if (std::regex_search(input, match, segment_re)) {
-        std::string segment_type = toUppercase(match[1].str());
+    // 匹配以 .data 或 .text 开头的行（不区分大小写），取后面第一个非空白的参数
+    // 即正则 ^\s*\.(data|text)\s*(\S+)?
+    size_t dot = ScanFirstNot(input, 0, kCharSpace);
+    if (dot + 5 > input.size() || input[dot] != '.') return false;
+    std::string segment_type = toUppercase(std::string(input.substr(dot + 1, 4)));
+    if (segment_type != "DATA" && segment_type != "TEXT") return false;
+
+    size_t arg_begin = ScanFirstNot(input, dot + 5, kCharSpace);
+    std::string argument(input.substr(arg_begin, ScanFirst(input, arg_begin, kCharSpace) - arg_begin));
+
+    // 更新当前解析器的段状态
+    state = (segment_type == "DATA") ? SegmentState::Data : SegmentState::Text;
+
+    // 处理预留空间情况，例如 ".data 100" 表示预留 100 字节空间
+    if (!argument.empty() && isPositive(argument)) {
+        unsigned size_val = toUNumber(argument);
         
-        // 更新当前解析器的段状态
-        state = (segment_type == "DATA") ? SegmentState::Data : SegmentState::Text;
-
-        // 处理预留空间情况，例如 ".data 100" 表示预留 100 字节空间
-        if (match[2].matched && isPositive(match[2].str())) {
-            unsigned size_val = toUNumber(match[2].str());
-            
-            if (state == SegmentState::Data) {
-                // 在数据段插入指定长度的零填充
-                Data d;
-                d.file = path; d.line = line; d.assembly = input; 
-                d.address = 0; d.done = true; // 标记已完成，后续Pass不再解析
-                d.raw_data.assign(size_val, 0);
-                data_list.push_back(d);
-            } else {
-                // 指令段必须 4 字节（32位）对齐
-                if (size_val % 4 != 0) {
-                    throw std::runtime_error("Alignment Error: .text size must be multiple of 4. (" + path + ":" + std::to_string(line) + ")");
-                }
-                // 在代码段插入指定数量的 NOP (指令机器码 0)
-                Instruction inst;
-                inst.file = path; inst.line = line; inst.assembly = input; 
-                inst.address = 0; inst.done = true;
-                inst.machine_code.assign(size_val / 4, 0); 
-                inst_list.push_back(inst);
+        if (state == SegmentState::Data) {
+            // 在数据段插入指定长度的零填充
+            Data d;
+            d.file = path; d.line = line; d.assembly = input; 
+            d.address = 0; d.done = true; // 标记已完成，后续Pass不再解析
+            d.raw_data.assign(size_val, 0);
+            data_list.push_back(d);
+        } else {
+            // 指令段必须 4 字节（32位）对齐
+            if (size_val % 4 != 0) {
+                throw std::runtime_error("Alignment Error: .text size must be multiple of 4. (" + path + ":" + std::to_string(line) + ")");
             }
+            // 在代码段插入指定数量的 NOP (指令机器码 0)
+            Instruction inst;
+            inst.file = path; inst.line = line; inst.assembly = input; 
+            inst.address = 0; inst.done = true;
+            inst.machine_code.assign(size_val / 4, 0); 
+            inst_list.push_back(inst);
         }
-        return true;
     }
-    return false;
+    return true;
 }
 
 /**
@@ -69,103 +65,171 @@ bool handleSegmentDirective(const std::string& input,
  * 3. 第二遍扫描：解析前向引用（如跳转到后方标签），回填机器码。
  * 4. 输出生成：生成 FPGA 所需的 .coe 镜像文件。
  */
-int doAssemble(const std::string &input_path, const std::string &output_dir) {
-    std::ifstream infile(input_path);
-    if (!infile) {
-        std::cerr << "Assembler Error: Cannot open input file " << input_path << std::endl;
-        return 1;
+int doAssemble(const std::string &input_file_path, const std::string &output_dir,
+               const AssembleOptions &options, AssemblyCache *external_cache,
+               JobArena *external_arena) {
+    // "-" 表示从标准输入读取源程序，诊断信息中以 <stdin> 指代
+    const bool from_stdin = input_file_path == "-";
+    const std::string input_path = from_stdin ? "<stdin>" : input_file_path;
+
+    std::ifstream infile;
+    if (!from_stdin) {
+        infile.open(input_file_path);
+        if (!infile) {
+            std::cerr << "Assembler Error: Cannot open input file " << input_path << std::endl;
+            return 1;
+        }
     }
+    std::istream& source = from_stdin ? std::cin : infile;
 
-    InstructionList instruction_list; // 储存得到的指令
-    DataList data_list;               // 储存得到的数据
-    SegmentState current_state = SegmentState::Global; // 从全局状态开始
-    std::string current_line; // 当前处理到的行
-    int line_counter = 0; // 当前行号计数器
-
-    // --- 文本预处理与初次分类 ---
-    try {
-        while (std::getline(infile, current_line)) {
-            line_counter++;
-            
-            std::string clean_line = KillComment(current_line);
-            if (clean_line.empty() || clean_line.find_first_not_of(" \t\r\n") == std::string::npos) {
-                continue; // 跳过空行
-            }
+    // 开启 --stats 时，无论成功与否都在结束时输出统计
+    struct StatsReporter {
+        ~StatsReporter() {
+            if (StatsEnabled()) ReportStats(std::cerr);
+        }
+    } stats_reporter;
+
+    // --cache：读入上次的缓存，结束时（无论成功与否）写回本次用到的条目
+    // 调用方传入缓存时由调用方负责读写
+    struct CacheKeeper {
+        std::string path;
+        AssemblyCache cache;
+        ~CacheKeeper() {
+            if (!path.empty() && !cache.Save(path))
+                std::cerr << "IO Error: Could not write cache file " << path << std::endl;
+        }
+    } cache_keeper{external_cache ? std::string() : options.cache_path, {}};
+    AssemblyCache* cache = external_cache;
+    if (!cache && !cache_keeper.path.empty()) {
+        cache_keeper.cache.Load(options.cache_path);
+        cache = &cache_keeper.cache;
+    }
 
-            // 处理 .data / .text 段切换指令
-            if (handleSegmentDirective(clean_line, current_state, input_path, line_counter, instruction_list, data_list)) {
-                continue;
-            }
+    // 流水线模式：读入/编码/输出三个线程，见 Pipeline.cpp
+    if (options.pipeline) {
+        return doAssemblePipeline(source, input_path, output_dir, options, cache);
+    }
 
-            // 检查非法行：在定义任何段之前就出现内容
-            if (current_state == SegmentState::Global) {
-                std::cerr << "Assembler Error: Statement found outside of any segment at " << input_path << ":" << line_counter << std::endl;
-                return 1;
-            }
+    // 流式模式：边读边编码，见 Stream.cpp
+    if (options.stream) {
+        return doAssembleStream(source, input_path, output_dir, options, cache);
+    }
 
-            // 根据当前状态将行存入对应的待处理列表
-            if (current_state == SegmentState::Data) {
-                Data d; d.file = input_path; d.line = line_counter; d.assembly = clean_line;
-                data_list.push_back(d);
-            } else {
-                Instruction inst; inst.file = input_path; inst.line = line_counter; inst.assembly = clean_line;
-                instruction_list.push_back(inst);
-            }
+    // 开启 --mem-report 时，在结束时输出已记录的各阶段内存估算
+    struct MemReporter {
+        bool enabled;
+        MemoryReport report;
+        ~MemReporter() {
+            if (enabled) report.Print(std::cerr);
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Critical Error during parsing: " << e.what() << std::endl;
+    } mem{options.mem_report, {}};
+
+    // 本次作业的对象都从 arena 分配；调用方传入的 arena 在上一次作业的对象析构后才复用
+    JobArena local_arena;
+    JobArena* arena = external_arena ? external_arena : &local_arena;
+    arena->Reset();
+
+    InstructionList instruction_list(arena); // 储存得到的指令
+    DataList data_list(arena);               // 储存得到的数据
+
+    // --- 文本预处理与初次分类（按块并行扫描，见 FrontEnd.cpp）---
+    if (ReadSource(source, input_path, instruction_list, data_list)) {
         return 1;
     }
-    infile.close();
+    if (!from_stdin) infile.close();
 
     // --- 两遍扫描 ---
-    SymbolMap symbol_table;           // 存储标签与地址的映射 (Label -> Address)
-    UnsolvedSymbolMap unsolved_map;   // 记录那些因为 Label 尚未定义而无法生成的机器码位置
+    SymbolMap symbol_table(arena);    // 存储标签与地址的映射 (Label -> Address)
+    UnsolvedSymbolMap unsolved_map(symbol_table); // 记录那些因为 Label 尚未定义而无法生成的机器码位置
     AssemblerCore assembler_core;     // 汇编器核心实例
+    assembler_core.SetCache(cache);
+
+    // 记录一个阶段结束时各数据结构的内存占用
+    auto mem_snapshot = [&](const char* phase) {
+        if (options.mem_report)
+            mem.report.Snapshot(phase, instruction_list, data_list, symbol_table,
+                                unsolved_map);
+    };
+    mem_snapshot("read");
 
     // Pass 1: 解析数据段。确定变量地址，将数据标签存入符号表。
-    if (assembler_core.ProcessDataSegment(data_list, symbol_table)) {
-        std::cerr << "Error in Data Segment Generation." << std::endl;
-        return 1;
+    {
+        ScopedPhaseTimer timer(StatsPhase::DataSegment);
+        if (assembler_core.ProcessDataSegment(data_list, symbol_table)) {
+            std::cerr << "Error in Data Segment Generation." << std::endl;
+            return 1;
+        }
     }
+    mem_snapshot("data segment");
 
     // Pass 1: 解析指令段。计算指令地址，尝试编码。
     // 如果遇到跳转指令指向未知的 Label，会先存入 unsolved_map。
-    if (assembler_core.ProcessTextSegment(instruction_list, unsolved_map, symbol_table)) {
-        std::cerr << "Error in Machine Code Generation." << std::endl;
-        return 1;
+    {
+        ScopedPhaseTimer timer(StatsPhase::TextSegment);
+        if (assembler_core.ProcessTextSegment(instruction_list, unsolved_map, symbol_table)) {
+            std::cerr << "Error in Machine Code Generation." << std::endl;
+            return 1;
+        }
     }
+    mem_snapshot("text segment");
 
     // Pass 2: 符号回填。
     // 此时所有 Label 的地址都已确定，遍历 unsolved_map 并修正之前留空的机器码。
-    if (assembler_core.ResolveSymbols(unsolved_map, symbol_table)) {
-        std::cerr << "Error: Undefined symbols detected." << std::endl;
-        return 1;
+    {
+        ScopedPhaseTimer timer(StatsPhase::Resolve);
+        if (assembler_core.ResolveSymbols(unsolved_map, symbol_table)) {
+            std::cerr << "Error: Undefined symbols detected." << std::endl;
+            return 1;
+        }
     }
+    mem_snapshot("resolve");
+
+    // 文件导出分两步：先把三个文件格式化到内存（计入 output），
+    // 再交给 AsyncOutputWriter 同时写出（计入 output I/O，内容未变化的文件不改写）
+    AsyncOutputWriter writer;
+    {
+        ScopedPhaseTimer output_timer(StatsPhase::Output);
+
+        // --patch：必须在覆盖上次输出之前与其比较
+        if (options.patch) {
+            const std::string& base_dir = options.patch_base.empty() ? output_dir : options.patch_base;
+            if (!WritePatches(base_dir, output_dir, BuildInstructionImage(instruction_list),
+                              BuildDataImage(data_list)))
+                return 1;
+        }
 
-    // 文件导出
-    // 定义一个 Lambda 闭包简化重复的写文件流程
-    auto export_to_file = [&](const std::string& filename, auto& list, auto write_func) {
-        std::ofstream outfile(output_dir + filename);
-        if (outfile) {
-            write_func(outfile, list);
-            return true;
+        // -o -：只把选定的一种格式写到标准输出，提示信息走 stderr
+        if (options.stdout_format != StdoutFormat::None) {
+            switch (options.stdout_format) {
+                case StdoutFormat::Prgm: OutputInstruction(std::cout, instruction_list); break;
+                case StdoutFormat::Dmem: OutputDataSegment(std::cout, data_list); break;
+                default: OutputDetails(instruction_list, data_list, std::cout); break;
+            }
+            std::cout.flush();
+            mem_snapshot("output");
+
+            std::cerr << "Assembly completed successfully." << std::endl;
+            return std::cout ? 0 : 1;
         }
-        std::cerr << "IO Error: Could not write to " << filename << std::endl;
-        return false;
-    };
 
-    // 生成指令段 COE
-    if (!export_to_file("prgmip32.coe", instruction_list, OutputInstruction)) return 1;
-    // 生成数据段 COE
-    if (!export_to_file("dmem32.coe", data_list, OutputDataSegment)) return 1;
-    
-    // 生成调试详情文件
-    std::ofstream detail_file(output_dir + "details.txt");
-    if (detail_file) {
-        OutputDetails(instruction_list, data_list, detail_file);
+        // 指令段与数据段 COE
+        auto format = [](auto& list, auto write_func) {
+            std::ostringstream content;
+            write_func(content, list);
+            return content.str();
+        };
+        writer.Add(output_dir + "prgmip32.coe", format(instruction_list, OutputInstruction));
+        writer.Add(output_dir + "dmem32.coe", format(data_list, OutputDataSegment));
+
+        // 调试详情文件
+        std::ostringstream details;
+        OutputDetails(instruction_list, data_list, details);
+        writer.Add(output_dir + "details.txt", details.str());
     }
 
+    if (!FlushOutputs(writer)) return 1;
+    mem_snapshot("output");
+
     std::cout << "Assembly completed successfully." << std::endl;
     return 0; 
 }
\ No newline at end of file
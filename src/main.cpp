@@ -1,29 +1,149 @@
 #include "Headers.h"
 
+static void PrintUsage() {
+    std::cerr << "Usage:\n"
+              << "  mas.exe [options] input_file_path\n"
+              << "  mas.exe [options] input_file_path output_folder_path\n"
+              << "  mas.exe [options] - -o - [--format prgm|dmem|details]\n"
+              << "  mas.exe --lsp\n"
+              << "  mas.exe --disasm [--symbols details.txt] image_file [output.asm]\n"
+              << "Options:\n"
+              << "  -             read the source program from stdin\n"
+              << "  -o <dir>      write prgmip32.coe/dmem32.coe/details.txt into <dir>\n"
+              << "  -o -          write a single output to stdout (diagnostics go to stderr)\n"
+              << "  --format <f>  output written by -o -: prgm (default), dmem or details\n"
+              << "  --lsp         run as a language server over stdin/stdout\n"
+              << "  --disasm      disassemble a code image (.coe/.bin/.mem/.hex) back to source;\n"
+              << "                written to output.asm, -o <file>, or stdout\n"
+              << "  --symbols <f> with --disasm: name branch/jump targets after the labels in\n"
+              << "                details.txt <f>\n"
+              << "  --stats       print regex/allocation/exception counters to stderr\n"
+              << "  --mem-report  print estimated memory held per data structure and phase\n"
+              << "  --stream      encode while reading; memory bounded by the output image\n"
+              << "  --pipeline    read, encode and format output on separate threads\n"
+              << "  --cache <f>   reuse per-line encodings stored in cache file <f> across runs\n"
+              << "  --watch       reassemble whenever the input file changes (Ctrl+C to stop)\n"
+              << "  --patch       also write *.patch/patch.txt with the words changed since the\n"
+              << "                previous prgmip32.coe/dmem32.coe in the output folder\n"
+              << "  --patch-base <dir>  like --patch, but diff against the COE files in <dir>\n";
+}
+
 int main(int argc, char* argv[]) {
-    // 程序名之外必须是 1 个或 2 个参数
-    if (argc != 2 && argc != 3) {
+    std::vector<std::string> args; // 去掉选项后的位置参数
+    AssembleOptions options;
+    std::string output_option;     // -o 的参数
+    std::string format = "prgm";   // --format 的参数
+    bool watch = false;            // --watch
+    bool disasm = false;           // --disasm
+    DisasmOptions disasm_options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--lsp") {
+            // 语言服务器：标准输入/输出只用于 LSP 消息
+            std::ios::sync_with_stdio(false);
+            return RunLanguageServer(std::cin, std::cout);
+        } else if (arg == "--stats") {
+            EnableStats();
+        } else if (arg == "--mem-report") {
+            options.mem_report = true;
+        } else if (arg == "--stream") {
+            options.stream = true;
+        } else if (arg == "--pipeline") {
+            options.pipeline = true;
+        } else if (arg == "--watch") {
+            watch = true;
+        } else if (arg == "--disasm") {
+            disasm = true;
+        } else if (arg == "--patch") {
+            options.patch = true;
+        } else if (arg == "-o" || arg == "--format" || arg == "--cache" || arg == "--patch-base" ||
+                   arg == "--symbols") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: Missing value for " << arg << "\n";
+                PrintUsage();
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "-o") output_option = value;
+            else if (arg == "--format") format = value;
+            else if (arg == "--cache") options.cache_path = value;
+            else if (arg == "--symbols") disasm_options.symbols_path = value;
+            else {
+                // 与输出目录一样直接拼接文件名，补上末尾的分隔符
+                if (value.back() != '/' && value.back() != '\\') value += '/';
+                options.patch = true;
+                options.patch_base = value;
+            }
+        } else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            PrintUsage();
+            return 1;
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    // 程序名之外必须是 1 个或 2 个参数（使用 -o 时只能有 1 个）
+    if ((args.size() != 1 && args.size() != 2) || (!output_option.empty() && args.size() != 1)) {
         std::cerr << "Error: Invalid input.\n";
-        std::cerr << "Usage:\n"
-                  << "  mas.exe input_file_path\n"
-                  << "  mas.exe input_file_path output_folder_path\n";
+        PrintUsage();
         return 1;
     }
 
-    std::string input_path = argv[1];
+    std::string input_path = args[0];
+
+    // 反汇编：第二个参数或 -o 为输出文件，都没有（或 -o -）时写到标准输出
+    if (disasm) {
+        std::string output_path = args.size() == 2 ? args[1] : output_option;
+        if (output_path == "-") output_path.clear();
+        try {
+            return doDisassemble(input_path, output_path, disasm_options);
+        } catch (const std::exception& e) {
+            std::cerr << "Disassemble failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
     std::string output_folder;
 
     // 两个参数：指定了输出路径
-    if (argc == 3) {
-        output_folder = argv[2];
+    if (args.size() == 2) {
+        output_folder = args[1];
+    }
+
+    // -o -：结果写到标准输出
+    if (output_option == "-") {
+        if (format == "prgm") options.stdout_format = StdoutFormat::Prgm;
+        else if (format == "dmem") options.stdout_format = StdoutFormat::Dmem;
+        else if (format == "details") options.stdout_format = StdoutFormat::Details;
+        else {
+            std::cerr << "Error: Unknown format " << format << "\n";
+            PrintUsage();
+            return 1;
+        }
+    } else if (!output_option.empty()) {
+        output_folder = output_option;
+    }
+
+    // 标准输入/输出作为管道使用时，关闭与 C stdio 的同步以加快逐行读写
+    if (input_path == "-" || options.stdout_format != StdoutFormat::None) {
+        std::ios::sync_with_stdio(false);
+    }
+
+    // 监视模式：反复汇编，不返回
+    if (watch) {
+        return doWatch(input_path, output_folder, options);
     }
 
     // 调用汇编处理函数
+    int result = 0;
     try {
-        doAssemble(input_path, output_folder);
+        result = doAssemble(input_path, output_folder, options);
     } catch (const std::exception& e) {
         std::cerr << "Assemble failed: " << e.what() << "\n";
         return 1;
     }
-    return 0;
-}
\ No newline at end of file
+
+    // 管道模式下调用方无法查看输出文件，返回值需反映汇编是否成功
+    return options.stdout_format != StdoutFormat::None ? result : 0;
+}
@@ -0,0 +1,28 @@
+.data
+.list: .word 1, 2, 3
+table: .word 4
+.text
+main:
+	addi $t0, $zero, 3
+1:	addi $t0, $t0, -1
+	bne $t0, $zero, 1b
+	beq $t0, $zero, 1f
+	nop
+1:	lw $t1, .list($zero)
+	j .Ldone
+.Lloop:	addi $t1, $t1, 1
+	bne $t1, $zero, .Lloop
+.Ldone:
+	jal .loop
+	j 1f+4
+1:	nop
+	nop
+.loop:
+.Lloop:	addi $t2, $t2, 1
+	bne $t2, $zero, .Lloop
+1:	beq $t2, $zero, 1b
+	lw $t3, table($zero)
+	jr $ra
+func:
+	j .loop
+	jr $ra